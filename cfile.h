@@ -136,6 +136,7 @@ const char *cap_file_provider_get_interface_name(struct packet_provider_data *pr
 const char *cap_file_provider_get_interface_description(struct packet_provider_data *prov, uint32_t interface_id, unsigned section_number);
 wtap_block_t cap_file_provider_get_modified_block(struct packet_provider_data *prov, const frame_data *fd);
 void cap_file_provider_set_modified_block(struct packet_provider_data *prov, frame_data *fd, const wtap_block_t new_block);
+void cap_file_provider_add_dependent_frame(struct packet_provider_data *prov, frame_data *fd, uint32_t frame_num);
 
 #ifdef __cplusplus
 }
@@ -4902,7 +4902,6 @@ capture_loop_write_pcapng_cb(capture_src *pcap_src, const pcapng_block_header_t
                                        bh->block_total_length,
                                        &global_ld.bytes_written, &err);
 
-        writecap_flush(global_ld.pdh, NULL);
         if (!successful) {
             global_ld.go = false;
             global_ld.err = err;
@@ -4914,7 +4913,11 @@ capture_loop_write_pcapng_cb(capture_src *pcap_src, const pcapng_block_header_t
             capture_loop_wrote_one_packet(pcap_src);
         } else if (bh->block_type == BLOCK_TYPE_SHB && report_capture_filename) {
             ws_debug("Sending SP_FILE on first SHB");
-            /* SHB is now ready for capture parent to read on SP_FILE message */
+            /* SHB is now ready for capture parent to read on SP_FILE message.
+               Only the SHB is flushed here; like packets from pcap, other
+               blocks are flushed when we tell our parent about them, or
+               after each dispatch if we're writing to a pipe. */
+            writecap_flush(global_ld.pdh, NULL);
             sync_pipe_write_string_msg(sync_pipe_fd, SP_FILE, report_capture_filename);
             report_capture_filename = NULL;
         }
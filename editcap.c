@@ -2584,6 +2584,11 @@ main(int argc, char *argv[])
                         }
                     }
 
+                    /* Records without options might not have a block. */
+                    if (read_rec.block == NULL) {
+                        read_rec.block = wtap_block_create(WTAP_BLOCK_PACKET);
+                    }
+
                     /* The comment is not modified by dumper, cast away. */
                     wtap_block_add_string_option(read_rec.block, OPT_COMMENT, (char *)comment, strlen((char *)comment));
                     read_rec.block_was_modified = true;
@@ -55,6 +55,7 @@ typedef struct {
   char               *col_buf;              /**< Buffer into which to copy data for column */
   int                 col_fence;            /**< Stuff in column buffer before this index is immutable */
   bool                writable;             /**< writable or not */
+  bool                referenced;           /**< constructed for the current packet (see only_referenced) */
   int                 hf_id;
 } col_item_t;
 
@@ -67,6 +68,7 @@ struct epan_column_info {
   int                *col_last;             /**< Last column number with a given format */
   col_expr_t          col_expr;             /**< Column expressions and values */
   bool                writable;             /**< writable or not @todo Are we still writing to the columns? */
+  bool                only_referenced;      /**< only construct columns whose field is referenced by the tree, e.g. by a filter or field output */
   GRegex             *prime_regex;          /**< Used to prime custom columns */
 };
 
@@ -82,7 +84,7 @@ WS_DLL_PUBLIC void col_cleanup(column_info *cinfo);
 
 /** Initialize the data structures for constructing column data.
  */
-extern void col_init(column_info *cinfo, const struct epan_session *epan);
+extern void col_init(column_info *cinfo, const struct epan_session *epan, proto_tree *tree);
 
 /** Fill in all columns of the given packet which are based on values from frame_data.
  */
@@ -64,11 +64,13 @@ col_setup(column_info *cinfo, const int num_cols)
 
   col_decimal_point            = localeconv()->decimal_point;
   cinfo->num_cols              = num_cols;
+  cinfo->only_referenced       = false;
   cinfo->columns               = g_new(col_item_t, num_cols);
   cinfo->col_first             = g_new(int, NUM_COL_FMTS);
   cinfo->col_last              = g_new(int, NUM_COL_FMTS);
   for (i = 0; i < num_cols; i++) {
     cinfo->columns[i].col_custom_fields_ids = NULL;
+    cinfo->columns[i].referenced = true;
   }
   cinfo->col_expr.col_expr     = g_new(const char*, num_cols + 1);
   cinfo->col_expr.col_expr_val = g_new(char*, num_cols + 1);
@@ -141,20 +143,31 @@ col_cleanup(column_info *cinfo)
 
 /* Initialize the data structures for constructing column data. */
 void
-col_init(column_info *cinfo, const struct epan_session *epan)
+col_init(column_info *cinfo, const struct epan_session *epan, proto_tree *tree)
 {
   int i;
   col_item_t* col_item;
+  bool all_referenced;
 
   if (!cinfo)
     return;
 
+  /*
+   * If the columns are only needed for filtering or field output, skip
+   * formatting the ones that nobody looks at. Referencing "_ws.col" itself
+   * (or a visible tree) needs all of them.
+   */
+  all_referenced = !cinfo->only_referenced || !tree ||
+                   (proto_cols > 0 && proto_field_is_referenced(tree, proto_cols));
+
   for (i = 0; i < cinfo->num_cols; i++) {
     col_item = &cinfo->columns[i];
     col_item->col_buf[0] = '\0';
     col_item->col_data = col_item->col_buf;
     col_item->col_fence = 0;
-    col_item->writable = true;
+    col_item->referenced = all_referenced || col_item->hf_id <= 0 ||
+                           proto_field_is_referenced(tree, col_item->hf_id);
+    col_item->writable = col_item->referenced;
     cinfo->col_expr.col_expr[i] = "";
     cinfo->col_expr.col_expr_val[i][0] = '\0';
   }
@@ -366,6 +379,7 @@ void col_custom_set_edt(epan_dissect_t *edt, column_info *cinfo)
        i <= cinfo->col_last[COL_CUSTOM]; i++) {
     col_item = &cinfo->columns[i];
     if (col_item->fmt_matx[COL_CUSTOM] &&
+        col_item->referenced &&
         col_item->col_custom_fields &&
         col_item->col_custom_fields_ids) {
         col_item->col_data = col_item->col_buf;
@@ -1979,6 +1993,8 @@ col_fill_in(packet_info *pinfo, const bool fill_col_exprs, const bool fill_fd_co
 
   for (i = 0; i < pinfo->cinfo->num_cols; i++) {
     col_item = &pinfo->cinfo->columns[i];
+    if (!col_item->referenced)
+      continue;
     if (col_based_on_frame_data(pinfo->cinfo, i)) {
       if (fill_fd_colums)
         col_fill_in_frame_data(pinfo->fd, pinfo->cinfo, i, fill_col_exprs);
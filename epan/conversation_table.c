@@ -222,62 +222,130 @@ unsigned conversation_table_get_num(void)
     return wmem_tree_count(registered_ct_tables);
 }
 
-/** Compute the hash value for two given address/port pairs.
- * (Parameter type is const void *for GHashTable compatibility.)
+/*
+ * Conversation and endpoint index.
  *
- * @param v Conversation Key. MUST point to a conv_key_t struct.
- * @return Computed key hash.
+ * An open-addressing (linear probing) hash table whose slots hold the hash
+ * of a key and the position of its item in conv_array. Lookups compare the
+ * key against the item itself, so neither lookups nor updates of existing
+ * items allocate anything, and new items only need their addresses copied
+ * into the arena.
  */
-static unsigned
-conversation_hash(const void *v)
+typedef struct {
+    unsigned hash;
+    unsigned idx;       /* index into conv_array + 1, 0 if the slot is empty */
+} conv_index_slot_t;
+
+struct _conv_table_index {
+    wmem_allocator_t  *arena;   /* address data of the items in conv_array */
+    conv_index_slot_t *slots;
+    unsigned           mask;    /* number of slots - 1 */
+    unsigned           used;
+};
+
+#define CONV_INDEX_INITIAL_SLOTS 16384   /* must be a power of two */
+
+static struct _conv_table_index *
+conv_index_new(void)
 {
-    const conv_key_t *key = (const conv_key_t *)v;
-    unsigned hash_val;
+    struct _conv_table_index *index = g_new(struct _conv_table_index, 1);
 
-    hash_val = 0;
-    hash_val = add_address_to_hash(hash_val, &key->addr1);
-    hash_val += key->port1;
-    hash_val = add_address_to_hash(hash_val, &key->addr2);
-    hash_val += key->port2;
-    hash_val ^= key->conv_id;
+    index->arena = wmem_allocator_new(WMEM_ALLOCATOR_BLOCK_FAST);
+    index->slots = g_new0(conv_index_slot_t, CONV_INDEX_INITIAL_SLOTS);
+    index->mask = CONV_INDEX_INITIAL_SLOTS - 1;
+    index->used = 0;
+    return index;
+}
 
-    return hash_val;
+static void
+conv_index_free(struct _conv_table_index *index)
+{
+    if (!index) {
+        return;
+    }
+    wmem_destroy_allocator(index->arena);
+    g_free(index->slots);
+    g_free(index);
 }
 
-/** Compare two conversation keys for an exact match.
- * (Parameter types are const void *for GHashTable compatibility.)
- *
- * @param key1 First conversation. MUST point to a conv_key_t struct.
- * @param key2 Second conversation. MUST point to a conv_key_t struct.
- * @return true if conversations are equal, false otherwise.
- */
-static gboolean
-conversation_equal(const void *key1, const void *key2)
+/* Keep the load factor below 1/2 so that probe sequences stay short. */
+static void
+conv_index_grow(struct _conv_table_index *index)
 {
-    const conv_key_t *ck1 = (const conv_key_t *)key1;
-    const conv_key_t *ck2 = (const conv_key_t *)key2;
-
-    if (ck1->conv_id == ck2->conv_id)
-    {
-        if (ck1->port1 == ck2->port1 &&
-            ck1->port2 == ck2->port2 &&
-            addresses_equal(&ck1->addr1, &ck2->addr1) &&
-            addresses_equal(&ck1->addr2, &ck2->addr2)) {
-            return TRUE;
+    unsigned old_size = index->mask + 1;
+    unsigned new_mask = old_size * 2 - 1;
+    conv_index_slot_t *old_slots = index->slots;
+    conv_index_slot_t *new_slots = g_new0(conv_index_slot_t, new_mask + 1);
+
+    for (unsigned i = 0; i < old_size; i++) {
+        if (old_slots[i].idx != 0) {
+            unsigned pos = old_slots[i].hash & new_mask;
+            while (new_slots[pos].idx != 0) {
+                pos = (pos + 1) & new_mask;
+            }
+            new_slots[pos] = old_slots[i];
         }
+    }
+    g_free(old_slots);
+    index->slots = new_slots;
+    index->mask = new_mask;
+}
+
+static void
+conv_index_insert(struct _conv_table_index *index, unsigned hash, unsigned idx)
+{
+    unsigned pos;
 
-        if (ck1->port2 == ck2->port1 &&
-            ck1->port1 == ck2->port2 &&
-            addresses_equal(&ck1->addr2, &ck2->addr1) &&
-            addresses_equal(&ck1->addr1, &ck2->addr2)) {
-            return TRUE;
+    if ((index->used + 1) * 2 > index->mask + 1) {
+        conv_index_grow(index);
+    }
+    pos = hash & index->mask;
+    while (index->slots[pos].idx != 0) {
+        pos = (pos + 1) & index->mask;
+    }
+    index->slots[pos].hash = hash;
+    index->slots[pos].idx = idx + 1;
+    index->used++;
+}
+
+/** Hash an address/port pair.
+ * Ethernet, IPv4 and IPv6 addresses (anything up to 16 bytes) are hashed a
+ * word at a time, longer ones byte by byte.
+ */
+static inline unsigned
+conv_endpoint_hash(const address *addr, uint32_t port)
+{
+    unsigned hash_val = port ^ ((unsigned)addr->type << 16);
+
+    if (addr->len > 0 && addr->len <= 16) {
+        uint32_t words[4] = { 0 };
+        int num_words = (addr->len + 3) / 4;
+
+        memcpy(words, addr->data, addr->len);
+        for (int i = 0; i < num_words; i++) {
+            hash_val = (hash_val ^ words[i]) * 0x9e3779b1U;
+            hash_val ^= hash_val >> 15;
         }
+        return hash_val;
     }
+    return add_address_to_hash(hash_val, addr);
+}
 
-    /*
-     * The addresses, ports, or conversation IDs don't match.
-     */
-    return FALSE;
+/** Compute the hash value for a conversation.
+ * The hash doesn't depend on the direction, so both directions of a
+ * conversation are found with a single probe sequence.
+ */
+static inline unsigned
+conversation_hash(const address *addr1, uint32_t port1, const address *addr2, uint32_t port2, conv_id_t conv_id)
+{
+    unsigned hash_val;
+
+    hash_val = conv_endpoint_hash(addr1, port1) + conv_endpoint_hash(addr2, port2);
+    hash_val ^= conv_id;
+    hash_val *= 0x85ebca6bU;
+    hash_val ^= hash_val >> 13;
+
+    return hash_val;
 }
 
 void
@@ -287,23 +355,15 @@ reset_conversation_table_data(conv_hash_t *ch)
         return;
     }
 
+    /* The addresses of the items live in the index arena. */
     if (ch->conv_array != NULL) {
-        unsigned i;
-        for(i = 0; i < ch->conv_array->len; i++){
-            conv_item_t *conv = &g_array_index(ch->conv_array, conv_item_t, i);
-            free_address(&conv->src_address);
-            free_address(&conv->dst_address);
-        }
-
         g_array_free(ch->conv_array, true);
     }
 
-    if (ch->hashtable != NULL) {
-        g_hash_table_destroy(ch->hashtable);
-    }
+    conv_index_free(ch->index);
 
     ch->conv_array=NULL;
-    ch->hashtable=NULL;
+    ch->index=NULL;
 }
 
 void reset_endpoint_table_data(conv_hash_t *ch)
@@ -312,22 +372,15 @@ void reset_endpoint_table_data(conv_hash_t *ch)
         return;
     }
 
+    /* The addresses of the items live in the index arena. */
     if (ch->conv_array != NULL) {
-        unsigned i;
-        for(i = 0; i < ch->conv_array->len; i++){
-            endpoint_item_t *endpoint = &g_array_index(ch->conv_array, endpoint_item_t, i);
-            free_address(&endpoint->myaddress);
-        }
-
         g_array_free(ch->conv_array, true);
     }
 
-    if (ch->hashtable != NULL) {
-        g_hash_table_destroy(ch->hashtable);
-    }
+    conv_index_free(ch->index);
 
     ch->conv_array=NULL;
-    ch->hashtable=NULL;
+    ch->index=NULL;
 }
 
 /* For backwards source and binary compatibility */
@@ -680,53 +733,53 @@ add_conversation_table_data_with_conv_id(
 {
     conv_item_t *conv_item = NULL;
     bool is_fwd_direction = false; /* direction of any conversation found */
+    struct _conv_table_index *index;
+    unsigned hash_val;
+    unsigned pos;
 
     /* if we don't have any entries at all yet */
     if (ch->conv_array == NULL) {
         ch->conv_array = g_array_sized_new(false, false, sizeof(conv_item_t), 10000);
+        ch->index = conv_index_new();
+    }
+    index = ch->index;
 
-        ch->hashtable = g_hash_table_new_full(conversation_hash,
-                                              conversation_equal, /* key_equal_func */
-                                              g_free,             /* key_destroy_func */
-                                              NULL);              /* value_destroy_func */
-
-    } else { /* try to find it among the existing known conversations */
-        /* first, check in the fwd conversations */
-        conv_key_t existing_key;
-        void *conversation_idx_hash_val;
-
-        existing_key.addr1 = *src;
-        existing_key.addr2 = *dst;
-        existing_key.port1 = src_port;
-        existing_key.port2 = dst_port;
-        existing_key.conv_id = conv_id;
-        if (g_hash_table_lookup_extended(ch->hashtable, &existing_key, NULL, &conversation_idx_hash_val)) {
-            conv_item = &g_array_index(ch->conv_array, conv_item_t, GPOINTER_TO_UINT(conversation_idx_hash_val));
+    /* try to find it among the existing known conversations, in either direction */
+    hash_val = conversation_hash(src, src_port, dst, dst_port, conv_id);
+    for (pos = hash_val & index->mask; index->slots[pos].idx != 0; pos = (pos + 1) & index->mask) {
+        conv_item_t *item;
+
+        if (index->slots[pos].hash != hash_val) {
+            continue;
         }
-        if (conv_item == NULL) {
-            /* then, check in the rev conversations if not found in 'fwd' */
-            existing_key.addr1 = *dst;
-            existing_key.addr2 = *src;
-            existing_key.port1 = dst_port;
-            existing_key.port2 = src_port;
-            if (g_hash_table_lookup_extended(ch->hashtable, &existing_key, NULL, &conversation_idx_hash_val)) {
-                conv_item = &g_array_index(ch->conv_array, conv_item_t, GPOINTER_TO_UINT(conversation_idx_hash_val));
-            }
-        } else {
+        item = &g_array_index(ch->conv_array, conv_item_t, index->slots[pos].idx - 1);
+        if (item->conv_id != conv_id) {
+            continue;
+        }
+        if (item->src_port == src_port && item->dst_port == dst_port &&
+            addresses_equal(&item->src_address, src) &&
+            addresses_equal(&item->dst_address, dst)) {
             /* a conversation was found in this same fwd direction */
+            conv_item = item;
             is_fwd_direction = true;
+            break;
+        }
+        if (item->src_port == dst_port && item->dst_port == src_port &&
+            addresses_equal(&item->src_address, dst) &&
+            addresses_equal(&item->dst_address, src)) {
+            conv_item = item;
+            break;
         }
     }
 
     /* if we still don't know what conversation this is it has to be a new one
        and we have to allocate it and append it to the end of the list */
     if (conv_item == NULL) {
-        conv_key_t *new_key;
         conv_item_t new_conv_item;
         unsigned int conversation_idx;
 
-        copy_address(&new_conv_item.src_address, src);
-        copy_address(&new_conv_item.dst_address, dst);
+        copy_address_wmem(index->arena, &new_conv_item.src_address, src);
+        copy_address_wmem(index->arena, &new_conv_item.dst_address, dst);
         new_conv_item.dissector_info = ct_info;
         new_conv_item.ctype = ctype;
         new_conv_item.src_port = src_port;
@@ -754,14 +807,7 @@ add_conversation_table_data_with_conv_id(
         conversation_idx = ch->conv_array->len - 1;
         conv_item = &g_array_index(ch->conv_array, conv_item_t, conversation_idx);
 
-        /* ct->conversations address is not a constant but src/dst_address.data are */
-        new_key = g_new(conv_key_t, 1);
-        set_address(&new_key->addr1, conv_item->src_address.type, conv_item->src_address.len, conv_item->src_address.data);
-        set_address(&new_key->addr2, conv_item->dst_address.type, conv_item->dst_address.len, conv_item->dst_address.data);
-        new_key->port1 = src_port;
-        new_key->port2 = dst_port;
-        new_key->conv_id = conv_id;
-        g_hash_table_insert(ch->hashtable, new_key, GUINT_TO_POINTER(conversation_idx));
+        conv_index_insert(index, hash_val, conversation_idx);
 
         /* update the conversation struct */
         conv_item->tx_frames_total += num_frames;
@@ -873,26 +919,21 @@ add_conversation_table_data_ipv4_subnet(
     bool is_src_aggregated = false;
     bool is_dst_aggregated = false;
 
-    hashipv4_t * volatile tpsrc;
-    tpsrc = new_ipv4(addrSRC);
-    is_src_aggregated = fill_dummy_ip4(addrSRC, tpsrc);
-
-    hashipv4_t * volatile tpdst;
-    tpdst = new_ipv4(addrDST);
-    is_dst_aggregated = fill_dummy_ip4(addrDST, tpdst);
+    /* These only live for this call; the addresses are copied when a new
+     * conversation is added, so nothing has to be allocated per packet. */
+    hashipv4_t tpsrc;
+    is_src_aggregated = fill_dummy_ip4(addrSRC, &tpsrc);
 
-    address *aggsrc = NULL;
-    aggsrc = wmem_new(wmem_epan_scope(), address);
+    hashipv4_t tpdst;
+    is_dst_aggregated = fill_dummy_ip4(addrDST, &tpdst);
 
-    aggsrc->len = (int)strlen(tpsrc->cidr_addr);
-    aggsrc->data = wmem_strdup(wmem_file_scope(), tpsrc->cidr_addr);
-    aggsrc->type = AT_STRINGZ;
+    address aggsrc_buf;
+    address *aggsrc = &aggsrc_buf;
+    set_address(aggsrc, AT_STRINGZ, (int)strlen(tpsrc.cidr_addr), tpsrc.cidr_addr);
 
-    address *aggdst = NULL;
-    aggdst = wmem_new(wmem_epan_scope(), address);
-    aggdst->len = (int)strlen(tpdst->cidr_addr);
-    aggdst->data = wmem_strdup(wmem_file_scope(), tpdst->cidr_addr);
-    aggdst->type = AT_STRINGZ;
+    address aggdst_buf;
+    address *aggdst = &aggdst_buf;
+    set_address(aggdst, AT_STRINGZ, (int)strlen(tpdst.cidr_addr), tpdst.cidr_addr);
 
     /* add data with subnets if we have any, or actual src & dst
      * unset the conv_id when dealing with subnets
@@ -910,77 +951,43 @@ add_conversation_table_data_ipv4_subnet(
     }
 }
 
-/*
- * Compute the hash value for a given address/port pair if the match
- * is to be exact.
- */
-static unsigned
-endpoint_hash(const void *v)
-{
-    const endpoint_key_t *key = (const endpoint_key_t *)v;
-    unsigned hash_val;
-
-    hash_val = 0;
-    hash_val = add_address_to_hash(hash_val, &key->myaddress);
-    hash_val += key->port;
-    return hash_val;
-}
-
-/*
- * Compare two endpoint keys for an exact match.
- */
-static int
-endpoint_match(const void *v, const void *w)
-{
-    const endpoint_key_t *v1 = (const endpoint_key_t *)v;
-    const endpoint_key_t *v2 = (const endpoint_key_t *)w;
-
-    if (v1->port == v2->port &&
-        addresses_equal(&v1->myaddress, &v2->myaddress)) {
-        return 1;
-    }
-    /*
-     * The addresses or the ports don't match.
-     */
-    return 0;
-}
-
 void
 add_endpoint_table_data(conv_hash_t *ch, const address *addr, uint32_t port, bool sender, int num_frames, int num_bytes, et_dissector_info_t *et_info, endpoint_type etype)
 {
     endpoint_item_t *endpoint_item = NULL;
+    struct _conv_table_index *index;
+    unsigned hash_val;
+    unsigned pos;
 
-    /* XXX should be optimized to allocate n extra entries at a time
-       instead of just one */
     /* if we don't have any entries at all yet */
     if(ch->conv_array==NULL){
         ch->conv_array=g_array_sized_new(false, false, sizeof(endpoint_item_t), 10000);
-        ch->hashtable = g_hash_table_new_full(endpoint_hash,
-                                              endpoint_match, /* key_equal_func */
-                                              g_free,     /* key_destroy_func */
-                                              NULL);      /* value_destroy_func */
+        ch->index = conv_index_new();
     }
-    else {
-        /* try to find it among the existing known conversations */
-        endpoint_key_t existing_key;
-        void *endpoint_idx_hash_val;
+    index = ch->index;
 
-        copy_address_shallow(&existing_key.myaddress, addr);
-        existing_key.port = port;
+    /* try to find it among the existing known endpoints */
+    hash_val = conv_endpoint_hash(addr, port);
+    for (pos = hash_val & index->mask; index->slots[pos].idx != 0; pos = (pos + 1) & index->mask) {
+        endpoint_item_t *item;
 
-        if (g_hash_table_lookup_extended(ch->hashtable, &existing_key, NULL, &endpoint_idx_hash_val)) {
-            endpoint_item = &g_array_index(ch->conv_array, endpoint_item_t, GPOINTER_TO_UINT(endpoint_idx_hash_val));
+        if (index->slots[pos].hash != hash_val) {
+            continue;
+        }
+        item = &g_array_index(ch->conv_array, endpoint_item_t, index->slots[pos].idx - 1);
+        if (item->port == port && addresses_equal(&item->myaddress, addr)) {
+            endpoint_item = item;
+            break;
         }
     }
 
     /* if we still don't know what endpoint this is it has to be a new one
        and we have to allocate it and append it to the end of the list */
     if(endpoint_item==NULL){
-        endpoint_key_t *new_key;
         endpoint_item_t new_endpoint_item;
         unsigned int endpoint_idx;
 
-        copy_address(&new_endpoint_item.myaddress, addr);
+        copy_address_wmem(index->arena, &new_endpoint_item.myaddress, addr);
         new_endpoint_item.dissector_info = et_info;
         new_endpoint_item.etype=etype;
         new_endpoint_item.port=port;
@@ -999,11 +1006,7 @@ add_endpoint_table_data(conv_hash_t *ch, const address *addr, uint32_t port, boo
         endpoint_idx = ch->conv_array->len - 1;
         endpoint_item = &g_array_index(ch->conv_array, endpoint_item_t, endpoint_idx);
 
-        /* hl->hosts address is not a constant but address.data is */
-        new_key = g_new(endpoint_key_t,1);
-        set_address(&new_key->myaddress, endpoint_item->myaddress.type, endpoint_item->myaddress.len, endpoint_item->myaddress.data);
-        new_key->port = port;
-        g_hash_table_insert(ch->hashtable, new_key, GUINT_TO_POINTER(endpoint_idx));
+        conv_index_insert(index, hash_val, endpoint_idx);
     }
 
     /* if this is a new endpoint we need to initialize the struct */
@@ -1046,16 +1049,12 @@ add_endpoint_table_data_ipv4_subnet(
 
     bool is_aggregated = false;
 
-    hashipv4_t * volatile tpaddr;
-    tpaddr = new_ipv4(addrSubnetted);
-    is_aggregated = fill_dummy_ip4(addrSubnetted, tpaddr);
-
-    address *aggaddr = NULL;
-    aggaddr = wmem_new(wmem_epan_scope(), address);
+    hashipv4_t tpaddr;
+    is_aggregated = fill_dummy_ip4(addrSubnetted, &tpaddr);
 
-    aggaddr->len = (int)strlen(tpaddr->cidr_addr);
-    aggaddr->data = wmem_strdup(wmem_file_scope(), tpaddr->cidr_addr);
-    aggaddr->type = AT_STRINGZ;
+    address aggaddr_buf;
+    address *aggaddr = &aggaddr_buf;
+    set_address(aggaddr, AT_STRINGZ, (int)strlen(tpaddr.cidr_addr), tpaddr.cidr_addr);
 
     /* add data with subnets if we have any, or actual addr
      */
@@ -47,11 +47,15 @@ typedef enum {
     CONV_DIR_ANY_FROM_B
 } conv_direction_e;
 
+struct _conv_table_index;
+
 /** Conversation hash + value storage
- * Hash table keys are conv_key_t. Hash table values are indexes into conv_array.
+ * The index is an open-addressing hash table of indexes into conv_array,
+ * keyed on the addresses and ports of the items themselves. The addresses
+ * of the items are allocated from an arena owned by the index.
  */
 typedef struct _conversation_hash_t {
-    GHashTable  *hashtable;       /**< conversations hash table */
+    struct _conv_table_index *index; /**< conversations/endpoints index (private) */
     GArray      *conv_array;      /**< array of conversation values */
     void        *user_data;       /**< "GUI" specifics (if necessary) */
     unsigned    flags;            /**< flags given to the tap packet */
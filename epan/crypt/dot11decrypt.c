@@ -79,6 +79,12 @@ static int Dot11DecryptGetHashAlgoFromAkm(int akm, int dh_group);
 /* PMK to PTK derive functions */
 #define DOT11DECRYPT_DERIVE_USING_PRF 0
 #define DOT11DECRYPT_DERIVE_USING_KDF 1
+
+/**
+ * Maximum number of (passphrase, SSID) pairs whose PSK is kept in the
+ * context's PMK cache before it is flushed.
+ */
+#define DOT11DECRYPT_PMK_CACHE_MAX_ENTRIES  4096
 /****************************************************************************/
 
 
@@ -149,6 +155,20 @@ static int Dot11DecryptRsnaPwd2Psk(
     unsigned char *output)
     ;
 
+/**
+ * Same as Dot11DecryptRsnaPwd2Psk(), but looks the PSK up in (and adds it
+ * to) the PMK cache of the context first, so that the 4096 PBKDF2
+ * iterations are done only once per passphrase-SSID pair.
+ * @param ctx [IN] pointer to the current context
+ * @param userPwd [IN] pointer to the struct containing a password and SSID
+ * @param output [OUT] calculated PSK (to use as PMK in WPA)
+ */
+static void Dot11DecryptRsnaPwd2PskCached(
+    PDOT11DECRYPT_CONTEXT ctx,
+    const struct DOT11DECRYPT_KEY_ITEMDATA_PWD *userPwd,
+    unsigned char *output)
+    ;
+
 static int Dot11DecryptRsnaMng(
     unsigned char *decrypt_data,
     unsigned mac_header_len,
@@ -1077,7 +1097,7 @@ int Dot11DecryptSetKeys(
     for (i=0, success=0; i<(int)keys_nr; i++) {
         if (Dot11DecryptValidateKey(keys+i)==true) {
             if (keys[i].KeyType==DOT11DECRYPT_KEY_TYPE_WPA_PWD) {
-                Dot11DecryptRsnaPwd2Psk(&keys[i].UserPwd, keys[i].KeyData.Wpa.Psk);
+                Dot11DecryptRsnaPwd2PskCached(ctx, &keys[i].UserPwd, keys[i].KeyData.Wpa.Psk);
                 keys[i].KeyData.Wpa.PskLen = DOT11DECRYPT_WPA_PWD_PSK_LEN;
             }
             memcpy(&ctx->keys[success], &keys[i], sizeof(keys[i]));
@@ -1194,6 +1214,11 @@ int Dot11DecryptDestroyContext(
     Dot11DecryptCleanKeys(ctx);
     Dot11DecryptCleanSecAssoc(ctx);
 
+    if (ctx->pmk_cache != NULL) {
+        g_hash_table_destroy(ctx->pmk_cache);
+        ctx->pmk_cache = NULL;
+    }
+
     ws_debug("Context destroyed!");
     return DOT11DECRYPT_RET_SUCCESS;
 }
@@ -1574,6 +1599,40 @@ Dot11DecryptIsPwdWildcardSsid(const PDOT11DECRYPT_CONTEXT ctx,
     return false;
 }
 
+/*
+ * Fill key_order with the indices of the context keys in the order they
+ * should be tried for a handshake: passphrase keys bound to the SSID last
+ * seen first, then keys that aren't bound to an SSID (PSK, PMK, MSK and
+ * wildcard passphrases), and passphrase keys for other SSIDs last.
+ * The last seen SSID isn't reliable (see Dot11DecryptSetLastSSID), so
+ * keys for other SSIDs are still tried rather than skipped.
+ */
+static void
+Dot11DecryptGetKeyOrder(const PDOT11DECRYPT_CONTEXT ctx, size_t *key_order)
+{
+    size_t n = 0;
+    int pass;
+
+    for (pass = 0; pass < 3; pass++) {
+        for (size_t i = 0; i < ctx->keys_nr; i++) {
+            const DOT11DECRYPT_KEY_ITEM *key = &ctx->keys[i];
+            int rank;
+
+            if (key->KeyType != DOT11DECRYPT_KEY_TYPE_WPA_PWD || key->UserPwd.SsidLen == 0) {
+                rank = 1;
+            } else if (key->UserPwd.SsidLen == ctx->pkt_ssid_len &&
+                       memcmp(key->UserPwd.Ssid, ctx->pkt_ssid, ctx->pkt_ssid_len) == 0) {
+                rank = 0;
+            } else {
+                rank = 2;
+            }
+            if (rank == pass) {
+                key_order[n++] = i;
+            }
+        }
+    }
+}
+
 /* Refer to IEEE 802.11i-2004, 8.5.3, pag. 85 */
 static int
 Dot11DecryptRsna4WHandshake(
@@ -1589,6 +1648,7 @@ Dot11DecryptRsna4WHandshake(
     int ret = 1;
     unsigned char useCache=false;
     unsigned char eapol[DOT11DECRYPT_EAPOL_MAX_LEN];
+    size_t key_order[DOT11DECRYPT_MAX_KEYS_NR];
 
     if (eapol_parsed->len > DOT11DECRYPT_EAPOL_MAX_LEN ||
         eapol_parsed->key_len > DOT11DECRYPT_EAPOL_MAX_LEN ||
@@ -1670,6 +1730,8 @@ Dot11DecryptRsna4WHandshake(
         uint8_t ptk[DOT11DECRYPT_WPA_PTK_MAX_LEN];
         size_t ptk_len = 0;
 
+        Dot11DecryptGetKeyOrder(ctx, key_order);
+
         /* now you can derive the PTK */
         for (key_index=0; key_index<(int)ctx->keys_nr || useCache; key_index++) {
             /* use the cached one, or try all keys */
@@ -1680,7 +1742,7 @@ Dot11DecryptRsna4WHandshake(
                 key_index--;
             } else {
                 ws_debug("Try WPA key...");
-                tmp_key = &ctx->keys[key_index];
+                tmp_key = &ctx->keys[key_order[key_index]];
             }
             useCache = false;
 
@@ -1695,7 +1757,7 @@ Dot11DecryptRsna4WHandshake(
                 memcpy(&pkt_key, tmp_key, sizeof(pkt_key));
                 memcpy(&pkt_key.UserPwd.Ssid, ctx->pkt_ssid, ctx->pkt_ssid_len);
                 pkt_key.UserPwd.SsidLen = ctx->pkt_ssid_len;
-                Dot11DecryptRsnaPwd2Psk(&pkt_key.UserPwd, pkt_key.KeyData.Wpa.Psk);
+                Dot11DecryptRsnaPwd2PskCached(ctx, &pkt_key.UserPwd, pkt_key.KeyData.Wpa.Psk);
                 tmp_pkt_key = &pkt_key;
             } else {
                 tmp_pkt_key = tmp_key;
@@ -1880,6 +1942,9 @@ Dot11DecryptScanFtAssocForKeys(
 
     uint8_t ptk[DOT11DECRYPT_WPA_PTK_MAX_LEN];
     size_t ptk_len;
+    size_t key_order[DOT11DECRYPT_MAX_KEYS_NR];
+
+    Dot11DecryptGetKeyOrder(ctx, key_order);
 
     /* now you can derive the PTK */
     for (key_index = 0; key_index < ctx->keys_nr || useCache; key_index++) {
@@ -1891,7 +1956,7 @@ Dot11DecryptScanFtAssocForKeys(
             key_index--;
         } else {
             ws_debug("Try WPA key...");
-            tmp_key = &ctx->keys[key_index];
+            tmp_key = &ctx->keys[key_order[key_index]];
         }
         useCache = false;
 
@@ -1906,7 +1971,7 @@ Dot11DecryptScanFtAssocForKeys(
             memcpy(&pkt_key, tmp_key, sizeof(pkt_key));
             memcpy(&pkt_key.UserPwd.Ssid, ctx->pkt_ssid, ctx->pkt_ssid_len);
             pkt_key.UserPwd.SsidLen = ctx->pkt_ssid_len;
-            Dot11DecryptRsnaPwd2Psk(&pkt_key.UserPwd, pkt_key.KeyData.Wpa.Psk);
+            Dot11DecryptRsnaPwd2PskCached(ctx, &pkt_key.UserPwd, pkt_key.KeyData.Wpa.Psk);
             tmp_pkt_key = &pkt_key;
         } else {
             tmp_pkt_key = tmp_key;
@@ -2755,8 +2820,21 @@ Dot11DecryptRsnaPwd2Psk(
     unsigned char *output)
 {
     unsigned char m_output[40] = { 0 };
-    GByteArray *pp_ba = g_byte_array_new();
+    GByteArray *pp_ba;
+
+    /* Let Libgcrypt do the PBKDF2 if it can; it keys the HMAC only once
+     * instead of on each of the 4096 iterations. It may refuse an empty
+     * salt (a wildcard SSID) or, in FIPS mode, short inputs, so fall back
+     * to doing it by hand. */
+    if (userPwd->SsidLen > 0 &&
+        gcry_kdf_derive(userPwd->Passphrase, userPwd->PassphraseLen,
+                        GCRY_KDF_PBKDF2, GCRY_MD_SHA1,
+                        userPwd->Ssid, userPwd->SsidLen, 4096,
+                        DOT11DECRYPT_WPA_PWD_PSK_LEN, output) == 0) {
+        return 0;
+    }
 
+    pp_ba = g_byte_array_new();
     g_byte_array_append(pp_ba, userPwd->Passphrase, (unsigned)userPwd->PassphraseLen);
 
     Dot11DecryptRsnaPwd2PskStep(pp_ba->data, pp_ba->len, userPwd->Ssid, userPwd->SsidLen, 4096, 1, m_output);
@@ -2768,6 +2846,51 @@ Dot11DecryptRsnaPwd2Psk(
     return 0;
 }
 
+static void
+Dot11DecryptRsnaPwd2PskCached(
+    PDOT11DECRYPT_CONTEXT ctx,
+    const struct DOT11DECRYPT_KEY_ITEMDATA_PWD *userPwd,
+    unsigned char *output)
+{
+    /* Key: passphrase length, passphrase, SSID */
+    uint8_t id[1 + DOT11DECRYPT_WPA_PASSPHRASE_MAX_LEN + DOT11DECRYPT_WPA_SSID_MAX_LEN];
+    size_t id_len;
+    GBytes *key;
+    const uint8_t *psk;
+
+    if (userPwd->PassphraseLen > DOT11DECRYPT_WPA_PASSPHRASE_MAX_LEN ||
+        userPwd->SsidLen > DOT11DECRYPT_WPA_SSID_MAX_LEN) {
+        Dot11DecryptRsnaPwd2Psk(userPwd, output);
+        return;
+    }
+
+    id[0] = (uint8_t)userPwd->PassphraseLen;
+    memcpy(&id[1], userPwd->Passphrase, userPwd->PassphraseLen);
+    memcpy(&id[1 + userPwd->PassphraseLen], userPwd->Ssid, userPwd->SsidLen);
+    id_len = 1 + userPwd->PassphraseLen + userPwd->SsidLen;
+
+    if (ctx->pmk_cache == NULL) {
+        ctx->pmk_cache = g_hash_table_new_full(g_bytes_hash, g_bytes_equal,
+                                               (GDestroyNotify)g_bytes_unref, g_free);
+    }
+
+    key = g_bytes_new_static(id, id_len);
+    psk = (const uint8_t *)g_hash_table_lookup(ctx->pmk_cache, key);
+    g_bytes_unref(key);
+    if (psk != NULL) {
+        memcpy(output, psk, DOT11DECRYPT_WPA_PWD_PSK_LEN);
+        return;
+    }
+
+    Dot11DecryptRsnaPwd2Psk(userPwd, output);
+
+    if (g_hash_table_size(ctx->pmk_cache) >= DOT11DECRYPT_PMK_CACHE_MAX_ENTRIES) {
+        g_hash_table_remove_all(ctx->pmk_cache);
+    }
+    g_hash_table_insert(ctx->pmk_cache, g_bytes_new(id, id_len),
+                        g_memdup2(output, DOT11DECRYPT_WPA_PWD_PSK_LEN));
+}
+
 /*
  * Returns the decryption_key_t struct given a string describing the key.
  * Returns NULL if the input_string cannot be parsed.
@@ -128,6 +128,7 @@ typedef struct _DOT11DECRYPT_CONTEXT {
 	size_t keys_nr;
 	char pkt_ssid[DOT11DECRYPT_WPA_SSID_MAX_LEN];
 	size_t pkt_ssid_len;
+	GHashTable *pmk_cache;	/* (passphrase, SSID) -> PSK, kept across key changes */
 } DOT11DECRYPT_CONTEXT, *PDOT11DECRYPT_CONTEXT;
 
 typedef enum _DOT11DECRYPT_HS_MSG_TYPE {
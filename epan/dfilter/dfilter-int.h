@@ -48,6 +48,7 @@ struct epan_dfilter {
 	GSList		*function_stack;
 	GSList		*set_stack;
 	ftenum_t	 ret_type;
+	struct _df_prefilter *prefilter;
 };
 
 typedef struct {
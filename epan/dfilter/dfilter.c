@@ -16,6 +16,7 @@
 #include "syntax-tree.h"
 #include "gencode.h"
 #include "semcheck.h"
+#include "prefilter.h"
 #include "dfvm.h"
 #include <epan/epan_dissect.h>
 #include <epan/exceptions.h>
@@ -198,6 +199,8 @@ dfilter_free(dfilter_t *df)
 	if (df->warnings)
 		g_slist_free_full(df->warnings, g_free);
 
+	df_prefilter_free(df->prefilter);
+
 	g_free(df->registers);
 	g_free(df->expanded_text);
 	g_free(df->syntax_tree_str);
@@ -472,6 +475,7 @@ static dfilter_t *
 dfwork_build(dfwork_t *dfw)
 {
 	dfilter_t	*dfilter;
+	df_prefilter_t	*prefilter;
 	char		*tree_str;
 
 	log_syntax_tree(LOG_LEVEL_NOISY, dfw->st_root, "Syntax tree before semantic check", NULL);
@@ -488,6 +492,10 @@ dfwork_build(dfwork_t *dfw)
 		tree_str = dump_syntax_tree_str(dfw->st_root);
 	}
 
+	/* Derive the raw-bytes prefilter, before code generation consumes
+	 * the set nodes of the tree. */
+	prefilter = dfw_prefilter(dfw);
+
 	/* Create bytecode */
 	dfw_gencode(dfw);
 
@@ -506,6 +514,7 @@ dfwork_build(dfwork_t *dfw)
 	dfilter->warnings = dfw->warnings;
 	dfw->warnings = NULL;
 	dfilter->ret_type = dfw->ret_type;
+	dfilter->prefilter = prefilter;
 
 	if (dfw->flags & DF_SAVE_TREE) {
 		ws_assert(tree_str);
@@ -731,6 +740,13 @@ dfilter_has_interesting_fields(const dfilter_t *df)
 	return (df->num_interesting_fields > 0);
 }
 
+const int *
+dfilter_interesting_fields(const dfilter_t *df, int *num_fields)
+{
+	*num_fields = df->num_interesting_fields;
+	return df->interesting_fields;
+}
+
 bool
 dfilter_interested_in_field(const dfilter_t *df, int hfid)
 {
@@ -785,6 +801,22 @@ dfilter_requires_columns(const dfilter_t *df)
 	return dfilter_interested_in_proto(df, proto_cols);
 }
 
+bool
+dfilter_has_prefilter(const dfilter_t *df)
+{
+	return df != NULL && df->prefilter != NULL;
+}
+
+bool
+dfilter_prefilter_rejects(const dfilter_t *df, int encap,
+			const uint8_t *data, unsigned len)
+{
+	if (df == NULL || df->prefilter == NULL)
+		return false;
+
+	return df_prefilter_rejects(df->prefilter, encap, data, len);
+}
+
 GPtrArray *
 dfilter_deprecated_tokens(dfilter_t *df) {
 	if (df->deprecated && df->deprecated->len > 0) {
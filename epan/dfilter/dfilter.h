@@ -153,6 +153,16 @@ dfilter_load_field_references_edt(const dfilter_t *df, struct epan_dissect *edt)
 bool
 dfilter_has_interesting_fields(const dfilter_t *df);
 
+/* Get the fields and protocols referenced by a dfilter
+ *
+ * @param df The dfilter
+ * @param num_fields Set to the number of fields returned
+ * @return The header field info IDs; owned by the dfilter
+ */
+WS_DLL_PUBLIC
+const int *
+dfilter_interesting_fields(const dfilter_t *df, int *num_fields);
+
 /* Check if dfilter is interested in a given field
  *
  * @param df The dfilter
@@ -176,6 +186,38 @@ WS_DLL_PUBLIC
 bool
 dfilter_requires_columns(const dfilter_t *df);
 
+/* Check if the dfilter has a raw-bytes prefilter, that can reject
+ * some packets without dissecting them. This is the case for filters
+ * that test Ethernet, VLAN, IPv4, IPv6, TCP or UDP header fields such
+ * as addresses and ports.
+ *
+ * @param df The dfilter
+ * @return true if dfilter_prefilter_rejects() might return true
+ */
+WS_DLL_PUBLIC
+bool
+dfilter_has_prefilter(const dfilter_t *df);
+
+/* Check if a packet can be rejected by looking at its raw bytes only.
+ * The prefilter is conservative: it returns false whenever it can't
+ * tell, for example for other encapsulations, tunnelled packets or
+ * TCP and UDP ports that have a dissector when the filter is compiled.
+ * It does not know about state kept by dissectors across packets,
+ * tunnels found by heuristic dissectors, or "Decode As" other than
+ * on TCP and UDP ports, so it is only suitable for callers that can
+ * do without dissecting the rejected packets.
+ *
+ * @param df The dfilter
+ * @param encap The WTAP_ENCAP_ type of the packet
+ * @param data The packet bytes
+ * @param len The captured length
+ * @return true if the packet can't match the filter
+ */
+WS_DLL_PUBLIC
+bool
+dfilter_prefilter_rejects(const dfilter_t *df, int encap,
+			const uint8_t *data, unsigned len);
+
 WS_DLL_PUBLIC
 GPtrArray *
 dfilter_deprecated_tokens(dfilter_t *df);
@@ -0,0 +1,1030 @@
+/*
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 2001 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+#define WS_LOG_DOMAIN LOG_DOMAIN_DFILTER
+
+#include "prefilter.h"
+#include "syntax-tree.h"
+#include "sttype-field.h"
+#include "sttype-op.h"
+#include "ftypes/ftypes.h"
+#include <epan/etypes.h>
+#include <epan/ipproto.h>
+#include <epan/packet.h>
+#include <wiretap/wtap.h>
+#include <wsutil/inet_cidr.h>
+#include <wsutil/pint.h>
+
+/*
+ * A display filter that only looks at a few fixed-offset header fields
+ * (addresses, ports, protocol numbers) can often be decided from the
+ * raw packet bytes, without dissecting the packet at all. We derive a
+ * small expression tree from the syntax tree and evaluate it in
+ * three-valued logic against a quick parse of the Ethernet, VLAN, ARP,
+ * IPv4, IPv6, TCP and UDP headers. Anything the expression doesn't
+ * model evaluates to "unknown", and a packet is only rejected if the
+ * whole expression is definitely false.
+ *
+ * Whether a field is absent, or whether all of its occurrences fail a
+ * test, can only be known if the packet was parsed as far as the
+ * dissectors would add that field. We call such a packet "complete":
+ * an ARP packet, or a TCP or UDP packet whose IP header has no options
+ * or extension headers and isn't a fragment. Any dissector registered
+ * on a TCP or UDP port might carry further headers (tunnels such as
+ * VXLAN, AMT or OpenFlow call the Ethernet or IP dissectors), so only
+ * packets whose ports have no enabled dissector, as of when the filter
+ * is compiled, and aren't well-known tunnel ports are complete. Tunnels
+ * found by heuristic dissectors, and dissector state kept across
+ * packets, are beyond what the prefilter can see; callers must only use
+ * it where that's fine.
+ */
+
+typedef enum {
+	PF_FALSE,
+	PF_TRUE,
+	PF_UNKNOWN
+} pf_result_t;
+
+typedef enum {
+	PF_KIND_PROTOCOL,
+	PF_KIND_UINT,
+	PF_KIND_IPV4,
+	PF_KIND_IPV6
+} pf_kind_t;
+
+typedef enum {
+	PF_FIELD_ETH,
+	PF_FIELD_ETH_TYPE,
+	PF_FIELD_VLAN,
+	PF_FIELD_VLAN_ID,
+	PF_FIELD_ARP,
+	PF_FIELD_IP,
+	PF_FIELD_IP_SRC,
+	PF_FIELD_IP_DST,
+	PF_FIELD_IP_ADDR,
+	PF_FIELD_IP_PROTO,
+	PF_FIELD_IP_TTL,
+	PF_FIELD_IPV6,
+	PF_FIELD_IPV6_SRC,
+	PF_FIELD_IPV6_DST,
+	PF_FIELD_IPV6_ADDR,
+	PF_FIELD_IPV6_NXT,
+	PF_FIELD_IPV6_HLIM,
+	PF_FIELD_TCP,
+	PF_FIELD_TCP_SRCPORT,
+	PF_FIELD_TCP_DSTPORT,
+	PF_FIELD_TCP_PORT,
+	PF_FIELD_UDP,
+	PF_FIELD_UDP_SRCPORT,
+	PF_FIELD_UDP_DSTPORT,
+	PF_FIELD_UDP_PORT
+} pf_field_t;
+
+static const struct {
+	const char	*abbrev;
+	pf_field_t	field;
+	pf_kind_t	kind;
+	ftenum_t	ftype;
+} pf_fields[] = {
+	{ "eth",		PF_FIELD_ETH,		PF_KIND_PROTOCOL,	FT_PROTOCOL },
+	{ "eth.type",		PF_FIELD_ETH_TYPE,	PF_KIND_UINT,		FT_UINT16 },
+	{ "vlan",		PF_FIELD_VLAN,		PF_KIND_PROTOCOL,	FT_PROTOCOL },
+	{ "vlan.id",		PF_FIELD_VLAN_ID,	PF_KIND_UINT,		FT_UINT16 },
+	{ "arp",		PF_FIELD_ARP,		PF_KIND_PROTOCOL,	FT_PROTOCOL },
+	{ "ip",			PF_FIELD_IP,		PF_KIND_PROTOCOL,	FT_PROTOCOL },
+	{ "ip.src",		PF_FIELD_IP_SRC,	PF_KIND_IPV4,		FT_IPv4 },
+	{ "ip.dst",		PF_FIELD_IP_DST,	PF_KIND_IPV4,		FT_IPv4 },
+	{ "ip.addr",		PF_FIELD_IP_ADDR,	PF_KIND_IPV4,		FT_IPv4 },
+	{ "ip.proto",		PF_FIELD_IP_PROTO,	PF_KIND_UINT,		FT_UINT8 },
+	{ "ip.ttl",		PF_FIELD_IP_TTL,	PF_KIND_UINT,		FT_UINT8 },
+	{ "ipv6",		PF_FIELD_IPV6,		PF_KIND_PROTOCOL,	FT_PROTOCOL },
+	{ "ipv6.src",		PF_FIELD_IPV6_SRC,	PF_KIND_IPV6,		FT_IPv6 },
+	{ "ipv6.dst",		PF_FIELD_IPV6_DST,	PF_KIND_IPV6,		FT_IPv6 },
+	{ "ipv6.addr",		PF_FIELD_IPV6_ADDR,	PF_KIND_IPV6,		FT_IPv6 },
+	{ "ipv6.nxt",		PF_FIELD_IPV6_NXT,	PF_KIND_UINT,		FT_UINT8 },
+	{ "ipv6.hlim",		PF_FIELD_IPV6_HLIM,	PF_KIND_UINT,		FT_UINT8 },
+	{ "tcp",		PF_FIELD_TCP,		PF_KIND_PROTOCOL,	FT_PROTOCOL },
+	{ "tcp.srcport",	PF_FIELD_TCP_SRCPORT,	PF_KIND_UINT,		FT_UINT16 },
+	{ "tcp.dstport",	PF_FIELD_TCP_DSTPORT,	PF_KIND_UINT,		FT_UINT16 },
+	{ "tcp.port",		PF_FIELD_TCP_PORT,	PF_KIND_UINT,		FT_UINT16 },
+	{ "udp",		PF_FIELD_UDP,		PF_KIND_PROTOCOL,	FT_PROTOCOL },
+	{ "udp.srcport",	PF_FIELD_UDP_SRCPORT,	PF_KIND_UINT,		FT_UINT16 },
+	{ "udp.dstport",	PF_FIELD_UDP_DSTPORT,	PF_KIND_UINT,		FT_UINT16 },
+	{ "udp.port",		PF_FIELD_UDP_PORT,	PF_KIND_UINT,		FT_UINT16 },
+};
+
+/* If any of these is disabled, the fields above aren't added. */
+static const char *pf_protocols[] = {
+	"eth", "vlan", "arp", "ip", "ipv6", "tcp", "udp"
+};
+
+/* TCP and UDP ports whose payload may contain further headers, even if
+ * the tunnel is only found by a heuristic dissector. */
+static const uint16_t pf_tunnel_ports[] = {
+	1194,	/* OpenVPN */
+	1701,	/* L2TP */
+	2152,	/* GTP-U */
+	3544,	/* Teredo */
+	4341,	/* LISP data */
+	4500,	/* IPsec NAT traversal */
+	4754,	/* GRE-in-UDP */
+	4789,	/* VXLAN */
+	5246,	/* CAPWAP control */
+	5247,	/* CAPWAP data */
+	6081,	/* Geneve */
+	6343,	/* sFlow */
+	6635,	/* MPLS-in-UDP */
+	8472,	/* VXLAN (Linux) */
+	37008,	/* TZSP */
+};
+
+typedef enum {
+	PF_NODE_UNKNOWN,
+	PF_NODE_NOT,
+	PF_NODE_AND,
+	PF_NODE_OR,
+	PF_NODE_EXISTS,
+	PF_NODE_RELATION
+} pf_node_type_t;
+
+typedef struct {
+	uint64_t	lo;		/* Integers and IPv4 addresses, inclusive. */
+	uint64_t	hi;
+	ws_in6_addr	addr6;		/* IPv6 addresses. */
+	uint32_t	prefix;
+} pf_value_t;
+
+typedef struct pf_node {
+	pf_node_type_t	type;
+	struct pf_node	*left;
+	struct pf_node	*right;
+	pf_field_t	field;
+	pf_kind_t	kind;
+	bool		all;		/* All occurrences must match, not any. */
+	bool		negate_value;	/* An occurrence matches if it is not in values. */
+	bool		negate_result;	/* "not in" */
+	GArray		*values;	/* Of pf_value_t. */
+} pf_node_t;
+
+#define PF_NUM_PORTS		(UINT16_MAX + 1)
+
+struct _df_prefilter {
+	pf_node_t	*root;
+	/* Bitmaps of the ports whose payload may contain further headers. */
+	uint8_t		tcp_ports[PF_NUM_PORTS / 8];
+	uint8_t		udp_ports[PF_NUM_PORTS / 8];
+};
+
+#define PF_MAX_VLANS		4
+#define PF_MAX_OCCURRENCES	PF_MAX_VLANS
+
+typedef struct {
+	const df_prefilter_t *pf;
+	bool		complete;
+	bool		has_eth;
+	bool		has_arp;
+	bool		has_ip;
+	bool		has_ipv6;
+	bool		has_tcp;
+	bool		has_udp;
+	uint16_t	eth_type;
+	unsigned	num_vlans;
+	uint16_t	vlan_id[PF_MAX_VLANS];
+	uint32_t	ip_src;
+	uint32_t	ip_dst;
+	uint8_t		ip_proto;
+	uint8_t		ip_ttl;
+	ws_in6_addr	ip6_src;
+	ws_in6_addr	ip6_dst;
+	uint8_t		ip6_nxt;
+	uint8_t		ip6_hlim;
+	uint16_t	src_port;
+	uint16_t	dst_port;
+} pf_packet_t;
+
+typedef struct {
+	uint64_t		num;
+	const ws_in6_addr	*addr6;
+} pf_occurrence_t;
+
+/*
+ * Building the expression.
+ */
+
+static pf_node_t *
+pf_node_new(pf_node_type_t type)
+{
+	pf_node_t *node = g_new0(pf_node_t, 1);
+	node->type = type;
+	return node;
+}
+
+static void
+pf_node_free(pf_node_t *node)
+{
+	if (node == NULL)
+		return;
+	pf_node_free(node->left);
+	pf_node_free(node->right);
+	if (node->values)
+		g_array_free(node->values, true);
+	g_free(node);
+}
+
+static bool
+pf_lookup_field(stnode_t *st_node, pf_field_t *field, pf_kind_t *kind)
+{
+	header_field_info *hfinfo;
+
+	if (stnode_type_id(st_node) != STTYPE_FIELD)
+		return false;
+
+	/* Layers, slices, raw bytes and value strings are out of scope. */
+	if (sttype_field_drange(st_node) || sttype_field_raw(st_node) ||
+			sttype_field_value_string(st_node))
+		return false;
+
+	/* Another field with the same name might be added anywhere. */
+	hfinfo = sttype_field_hfinfo(st_node);
+	if (hfinfo->same_name_prev_id != -1 || hfinfo->same_name_next != NULL)
+		return false;
+
+	for (size_t i = 0; i < G_N_ELEMENTS(pf_fields); i++) {
+		if (strcmp(hfinfo->abbrev, pf_fields[i].abbrev) == 0) {
+			if (hfinfo->type != pf_fields[i].ftype)
+				return false;
+			*field = pf_fields[i].field;
+			*kind = pf_fields[i].kind;
+			return true;
+		}
+	}
+	return false;
+}
+
+static bool
+pf_value_from_fvalue(pf_kind_t kind, fvalue_t *fv, pf_value_t *value)
+{
+	const ipv4_addr_and_mask *ipv4;
+	const ipv6_addr_and_prefix *ipv6;
+
+	memset(value, 0, sizeof(*value));
+
+	switch (kind) {
+		case PF_KIND_UINT:
+			switch (fvalue_type_ftenum(fv)) {
+				case FT_UINT8:
+				case FT_UINT16:
+				case FT_UINT24:
+				case FT_UINT32:
+					value->lo = value->hi = fvalue_get_uinteger(fv);
+					return true;
+				default:
+					return false;
+			}
+		case PF_KIND_IPV4:
+			if (fvalue_type_ftenum(fv) != FT_IPv4)
+				return false;
+			/* Equality with a subnet is membership of its range. */
+			ipv4 = fvalue_get_ipv4(fv);
+			value->lo = ipv4->addr & ipv4->nmask;
+			value->hi = ipv4->addr | ~ipv4->nmask;
+			return true;
+		case PF_KIND_IPV6:
+			if (fvalue_type_ftenum(fv) != FT_IPv6)
+				return false;
+			ipv6 = fvalue_get_ipv6(fv);
+			value->addr6 = ipv6->addr;
+			value->prefix = ipv6->prefix;
+			return true;
+		case PF_KIND_PROTOCOL:
+			return false;
+	}
+	return false;
+}
+
+static bool
+pf_add_fvalue(pf_node_t *node, stnode_t *st_node)
+{
+	pf_value_t value;
+
+	if (stnode_type_id(st_node) != STTYPE_FVALUE)
+		return false;
+	if (!pf_value_from_fvalue(node->kind, stnode_data(st_node), &value))
+		return false;
+	g_array_append_val(node->values, value);
+	return true;
+}
+
+static bool
+pf_add_set(pf_node_t *node, stnode_t *st_node)
+{
+	GSList *nodelist;
+	stnode_t *node1, *node2;
+	pf_value_t lo, hi;
+
+	if (stnode_type_id(st_node) != STTYPE_SET)
+		return false;
+
+	/* The set is a list of pairs, the second being NULL unless the
+	 * element is a range. */
+	nodelist = stnode_data(st_node);
+	while (nodelist) {
+		node1 = nodelist->data;
+		nodelist = g_slist_next(nodelist);
+		node2 = nodelist->data;
+		nodelist = g_slist_next(nodelist);
+
+		if (node2 == NULL) {
+			if (!pf_add_fvalue(node, node1))
+				return false;
+			continue;
+		}
+
+		/* Ranges of IPv6 addresses aren't supported. */
+		if (node->kind == PF_KIND_IPV6)
+			return false;
+		if (stnode_type_id(node1) != STTYPE_FVALUE ||
+				stnode_type_id(node2) != STTYPE_FVALUE)
+			return false;
+		if (!pf_value_from_fvalue(node->kind, stnode_data(node1), &lo) ||
+				!pf_value_from_fvalue(node->kind, stnode_data(node2), &hi))
+			return false;
+		lo.hi = hi.hi;
+		g_array_append_val(node->values, lo);
+	}
+	return true;
+}
+
+/* Turn an order relation on an integer into the range it accepts. */
+static bool
+pf_add_order(pf_node_t *node, stnode_op_t op, stnode_t *st_node)
+{
+	pf_value_t value;
+	uint64_t num;
+
+	if (node->kind != PF_KIND_UINT || stnode_type_id(st_node) != STTYPE_FVALUE)
+		return false;
+	if (!pf_value_from_fvalue(node->kind, stnode_data(st_node), &value))
+		return false;
+
+	num = value.lo;
+	switch (op) {
+		case STNODE_OP_GT:
+			if (num == UINT64_MAX)
+				return true;	/* Empty */
+			value.lo = num + 1;
+			value.hi = UINT64_MAX;
+			break;
+		case STNODE_OP_GE:
+			value.lo = num;
+			value.hi = UINT64_MAX;
+			break;
+		case STNODE_OP_LT:
+			if (num == 0)
+				return true;	/* Empty */
+			value.lo = 0;
+			value.hi = num - 1;
+			break;
+		case STNODE_OP_LE:
+			value.lo = 0;
+			value.hi = num;
+			break;
+		default:
+			return false;
+	}
+	g_array_append_val(node->values, value);
+	return true;
+}
+
+static stnode_op_t
+pf_reverse_op(stnode_op_t op)
+{
+	switch (op) {
+		case STNODE_OP_GT:	return STNODE_OP_LT;
+		case STNODE_OP_GE:	return STNODE_OP_LE;
+		case STNODE_OP_LT:	return STNODE_OP_GT;
+		case STNODE_OP_LE:	return STNODE_OP_GE;
+		default:		return op;
+	}
+}
+
+static pf_node_t *
+pf_build_relation(stnode_op_t op, stmatch_t how, stnode_t *st_arg1, stnode_t *st_arg2)
+{
+	pf_node_t *node;
+	bool ok;
+
+	node = pf_node_new(PF_NODE_RELATION);
+
+	/* A constant may be on either side of a comparison. */
+	if (!pf_lookup_field(st_arg1, &node->field, &node->kind)) {
+		if (op == STNODE_OP_IN || op == STNODE_OP_NOT_IN ||
+				!pf_lookup_field(st_arg2, &node->field, &node->kind)) {
+			node->type = PF_NODE_UNKNOWN;
+			return node;
+		}
+		st_arg2 = st_arg1;
+		op = pf_reverse_op(op);
+	}
+	if (node->kind == PF_KIND_PROTOCOL) {
+		node->type = PF_NODE_UNKNOWN;
+		return node;
+	}
+
+	node->values = g_array_new(false, false, sizeof(pf_value_t));
+
+	/* The default quantifiers match those of the code generator. */
+	switch (op) {
+		case STNODE_OP_ALL_EQ:
+			node->all = true;
+			ok = pf_add_fvalue(node, st_arg2);
+			break;
+		case STNODE_OP_ANY_EQ:
+			ok = pf_add_fvalue(node, st_arg2);
+			break;
+		case STNODE_OP_ALL_NE:
+			node->all = true;
+			node->negate_value = true;
+			ok = pf_add_fvalue(node, st_arg2);
+			break;
+		case STNODE_OP_ANY_NE:
+			node->negate_value = true;
+			ok = pf_add_fvalue(node, st_arg2);
+			break;
+		case STNODE_OP_GT:
+		case STNODE_OP_GE:
+		case STNODE_OP_LT:
+		case STNODE_OP_LE:
+			ok = pf_add_order(node, op, st_arg2);
+			break;
+		case STNODE_OP_IN:
+			ok = pf_add_set(node, st_arg2);
+			break;
+		case STNODE_OP_NOT_IN:
+			node->negate_result = true;
+			ok = pf_add_set(node, st_arg2);
+			break;
+		default:
+			ok = false;
+			break;
+	}
+
+	if (how == STNODE_MATCH_ALL)
+		node->all = true;
+	else if (how == STNODE_MATCH_ANY)
+		node->all = false;
+
+	if (!ok) {
+		g_array_free(node->values, true);
+		node->values = NULL;
+		node->type = PF_NODE_UNKNOWN;
+	}
+	return node;
+}
+
+static pf_node_t *
+pf_build(stnode_t *st_node)
+{
+	stnode_op_t op;
+	stnode_t *st_arg1, *st_arg2;
+	pf_node_t *node;
+
+	switch (stnode_type_id(st_node)) {
+		case STTYPE_FIELD:
+			node = pf_node_new(PF_NODE_EXISTS);
+			if (!pf_lookup_field(st_node, &node->field, &node->kind))
+				node->type = PF_NODE_UNKNOWN;
+			return node;
+
+		case STTYPE_TEST:
+			break;
+
+		default:
+			return pf_node_new(PF_NODE_UNKNOWN);
+	}
+
+	sttype_oper_get(st_node, &op, &st_arg1, &st_arg2);
+	switch (op) {
+		case STNODE_OP_NOT:
+			node = pf_node_new(PF_NODE_NOT);
+			node->left = pf_build(st_arg1);
+			return node;
+
+		case STNODE_OP_AND:
+		case STNODE_OP_OR:
+			node = pf_node_new(op == STNODE_OP_AND ? PF_NODE_AND : PF_NODE_OR);
+			node->left = pf_build(st_arg1);
+			node->right = pf_build(st_arg2);
+			return node;
+
+		default:
+			return pf_build_relation(op, sttype_test_get_match(st_node), st_arg1, st_arg2);
+	}
+}
+
+/*
+ * Whether the node can evaluate to false (or true, if "want" is true)
+ * for some packet. Used to discard expressions that can never reject
+ * anything.
+ */
+static bool
+pf_can_be(const pf_node_t *node, bool want)
+{
+	switch (node->type) {
+		case PF_NODE_UNKNOWN:
+			return false;
+		case PF_NODE_NOT:
+			return pf_can_be(node->left, !want);
+		case PF_NODE_AND:
+			if (want)
+				return pf_can_be(node->left, true) && pf_can_be(node->right, true);
+			return pf_can_be(node->left, false) || pf_can_be(node->right, false);
+		case PF_NODE_OR:
+			if (want)
+				return pf_can_be(node->left, true) || pf_can_be(node->right, true);
+			return pf_can_be(node->left, false) && pf_can_be(node->right, false);
+		case PF_NODE_EXISTS:
+		case PF_NODE_RELATION:
+			return true;
+	}
+	return false;
+}
+
+static void
+pf_set_port(uint8_t *ports, unsigned port)
+{
+	ports[port / 8] |= 1 << (port % 8);
+}
+
+static bool
+pf_test_port(const uint8_t *ports, unsigned port)
+{
+	return (ports[port / 8] & (1 << (port % 8))) != 0;
+}
+
+static void
+pf_add_registered_port(const char *table_name _U_, ftenum_t selector_type _U_,
+			void *key, void *value, void *user_data)
+{
+	uint8_t *ports = (uint8_t *)user_data;
+	unsigned port = GPOINTER_TO_UINT(key);
+	dissector_handle_t handle;
+	int proto_id;
+
+	/* "Decode As" may have changed the entry to no dissector at all. */
+	handle = dtbl_entry_get_handle((dtbl_entry_t *)value);
+	if (handle == NULL || port >= PF_NUM_PORTS)
+		return;
+
+	/* A disabled protocol's dissector isn't called. */
+	proto_id = dissector_handle_get_protocol_index(handle);
+	if (proto_id != -1 && !proto_is_protocol_enabled(find_protocol_by_id(proto_id)))
+		return;
+
+	pf_set_port(ports, port);
+}
+
+static void
+pf_add_ports(df_prefilter_t *pf)
+{
+	memset(pf->tcp_ports, 0, sizeof(pf->tcp_ports));
+	memset(pf->udp_ports, 0, sizeof(pf->udp_ports));
+
+	for (size_t i = 0; i < G_N_ELEMENTS(pf_tunnel_ports); i++) {
+		pf_set_port(pf->tcp_ports, pf_tunnel_ports[i]);
+		pf_set_port(pf->udp_ports, pf_tunnel_ports[i]);
+	}
+
+	dissector_table_foreach("tcp.port", pf_add_registered_port, pf->tcp_ports);
+	dissector_table_foreach("udp.port", pf_add_registered_port, pf->udp_ports);
+}
+
+df_prefilter_t *
+dfw_prefilter(dfwork_t *dfw)
+{
+	df_prefilter_t *pf;
+	pf_node_t *root;
+	protocol_t *protocol;
+
+	for (size_t i = 0; i < G_N_ELEMENTS(pf_protocols); i++) {
+		protocol = find_protocol_by_id(proto_get_id_by_filter_name(pf_protocols[i]));
+		if (protocol == NULL || !proto_is_protocol_enabled(protocol))
+			return NULL;
+	}
+
+	root = pf_build(dfw->st_root);
+	if (!pf_can_be(root, false)) {
+		pf_node_free(root);
+		return NULL;
+	}
+
+	ws_noisy("Derived a raw-bytes prefilter for \"%s\"", dfw->expanded_text);
+	pf = g_new(df_prefilter_t, 1);
+	pf->root = root;
+	pf_add_ports(pf);
+	return pf;
+}
+
+void
+df_prefilter_free(df_prefilter_t *pf)
+{
+	if (pf == NULL)
+		return;
+	pf_node_free(pf->root);
+	g_free(pf);
+}
+
+/*
+ * Parsing the packet.
+ */
+
+static void
+pf_parse_transport(pf_packet_t *pkt, uint8_t proto, const uint8_t *data, unsigned len)
+{
+	const uint8_t *ports;
+
+	if (proto == IP_PROTO_TCP && len >= 20) {
+		pkt->has_tcp = true;
+		ports = pkt->pf->tcp_ports;
+	} else if (proto == IP_PROTO_UDP && len >= 8) {
+		pkt->has_udp = true;
+		ports = pkt->pf->udp_ports;
+	} else {
+		return;
+	}
+
+	pkt->src_port = pntoh16(data);
+	pkt->dst_port = pntoh16(data + 2);
+	pkt->complete = !pf_test_port(ports, pkt->src_port) &&
+			!pf_test_port(ports, pkt->dst_port);
+}
+
+static void
+pf_parse_ipv4(pf_packet_t *pkt, const uint8_t *data, unsigned len)
+{
+	unsigned hlen, total_len;
+
+	if (len < 20 || (data[0] >> 4) != 4)
+		return;
+
+	pkt->has_ip = true;
+	pkt->ip_ttl = data[8];
+	pkt->ip_proto = data[9];
+	pkt->ip_src = pntoh32(data + 12);
+	pkt->ip_dst = pntoh32(data + 16);
+
+	/* Source route options add another ip.dst, and fragments may be
+	 * reassembled into anything. */
+	hlen = (data[0] & 0x0f) * 4;
+	total_len = pntoh16(data + 2);
+	if (hlen != 20 || total_len < hlen || (pntoh16(data + 6) & 0x3fff) != 0)
+		return;
+
+	len = MIN(len, total_len);
+	pf_parse_transport(pkt, pkt->ip_proto, data + hlen, len - hlen);
+}
+
+static void
+pf_parse_ipv6(pf_packet_t *pkt, const uint8_t *data, unsigned len)
+{
+	if (len < 40 || (data[0] >> 4) != 6)
+		return;
+
+	pkt->has_ipv6 = true;
+	pkt->ip6_nxt = data[6];
+	pkt->ip6_hlim = data[7];
+	memcpy(&pkt->ip6_src, data + 8, sizeof(ws_in6_addr));
+	memcpy(&pkt->ip6_dst, data + 24, sizeof(ws_in6_addr));
+
+	/* Extension headers other than those are not followed. */
+	pf_parse_transport(pkt, pkt->ip6_nxt, data + 40, len - 40);
+}
+
+static void
+pf_parse_ethertype(pf_packet_t *pkt, uint16_t etype, const uint8_t *data, unsigned len)
+{
+	switch (etype) {
+		case ETHERTYPE_IP:
+			pf_parse_ipv4(pkt, data, len);
+			break;
+		case ETHERTYPE_IPv6:
+			pf_parse_ipv6(pkt, data, len);
+			break;
+		case ETHERTYPE_ARP:
+			pkt->has_arp = true;
+			pkt->complete = true;
+			break;
+		default:
+			break;
+	}
+}
+
+static void
+pf_parse_ethernet(pf_packet_t *pkt, const uint8_t *data, unsigned len)
+{
+	uint16_t etype;
+
+	if (len < 14)
+		return;
+
+	/* 802.3 frames with a length field can carry anything. */
+	etype = pntoh16(data + 12);
+	if (etype < 0x0600)
+		return;
+
+	pkt->has_eth = true;
+	pkt->eth_type = etype;
+	data += 14;
+	len -= 14;
+
+	while (etype == ETHERTYPE_VLAN) {
+		if (len < 4 || pkt->num_vlans == PF_MAX_VLANS)
+			return;
+		pkt->vlan_id[pkt->num_vlans++] = pntoh16(data) & 0x0fff;
+		etype = pntoh16(data + 2);
+		if (etype < 0x0600)
+			return;
+		data += 4;
+		len -= 4;
+	}
+
+	pf_parse_ethertype(pkt, etype, data, len);
+}
+
+static bool
+pf_parse(pf_packet_t *pkt, const df_prefilter_t *pf, int encap,
+		const uint8_t *data, unsigned len)
+{
+	memset(pkt, 0, sizeof(*pkt));
+	pkt->pf = pf;
+
+	switch (encap) {
+		case WTAP_ENCAP_ETHERNET:
+			pf_parse_ethernet(pkt, data, len);
+			break;
+		case WTAP_ENCAP_RAW_IP:
+			if (len >= 1 && (data[0] >> 4) == 4)
+				pf_parse_ipv4(pkt, data, len);
+			else if (len >= 1 && (data[0] >> 4) == 6)
+				pf_parse_ipv6(pkt, data, len);
+			break;
+		case WTAP_ENCAP_RAW_IP4:
+			pf_parse_ipv4(pkt, data, len);
+			break;
+		case WTAP_ENCAP_RAW_IP6:
+			pf_parse_ipv6(pkt, data, len);
+			break;
+		default:
+			return false;
+	}
+	return true;
+}
+
+/*
+ * Evaluating the expression.
+ */
+
+static bool
+pf_has_protocol(const pf_packet_t *pkt, pf_field_t field)
+{
+	switch (field) {
+		case PF_FIELD_ETH:	return pkt->has_eth;
+		case PF_FIELD_VLAN:	return pkt->num_vlans > 0;
+		case PF_FIELD_ARP:	return pkt->has_arp;
+		case PF_FIELD_IP:	return pkt->has_ip;
+		case PF_FIELD_IPV6:	return pkt->has_ipv6;
+		case PF_FIELD_TCP:	return pkt->has_tcp;
+		case PF_FIELD_UDP:	return pkt->has_udp;
+		default:		return false;
+	}
+}
+
+static unsigned
+pf_get_occurrences(const pf_packet_t *pkt, pf_field_t field, pf_occurrence_t *occ)
+{
+	unsigned n = 0;
+
+#define PF_NUM(val)	do { occ[n].num = (val); occ[n].addr6 = NULL; n++; } while (0)
+#define PF_ADDR6(val)	do { occ[n].num = 0; occ[n].addr6 = (val); n++; } while (0)
+
+	switch (field) {
+		case PF_FIELD_ETH_TYPE:
+			if (pkt->has_eth)
+				PF_NUM(pkt->eth_type);
+			break;
+		case PF_FIELD_VLAN_ID:
+			for (unsigned i = 0; i < pkt->num_vlans; i++)
+				PF_NUM(pkt->vlan_id[i]);
+			break;
+		case PF_FIELD_IP_SRC:
+		case PF_FIELD_IP_DST:
+		case PF_FIELD_IP_ADDR:
+			if (!pkt->has_ip)
+				break;
+			if (field != PF_FIELD_IP_DST)
+				PF_NUM(pkt->ip_src);
+			if (field != PF_FIELD_IP_SRC)
+				PF_NUM(pkt->ip_dst);
+			break;
+		case PF_FIELD_IP_PROTO:
+			if (pkt->has_ip)
+				PF_NUM(pkt->ip_proto);
+			break;
+		case PF_FIELD_IP_TTL:
+			if (pkt->has_ip)
+				PF_NUM(pkt->ip_ttl);
+			break;
+		case PF_FIELD_IPV6_SRC:
+		case PF_FIELD_IPV6_DST:
+		case PF_FIELD_IPV6_ADDR:
+			if (!pkt->has_ipv6)
+				break;
+			if (field != PF_FIELD_IPV6_DST)
+				PF_ADDR6(&pkt->ip6_src);
+			if (field != PF_FIELD_IPV6_SRC)
+				PF_ADDR6(&pkt->ip6_dst);
+			break;
+		case PF_FIELD_IPV6_NXT:
+			if (pkt->has_ipv6)
+				PF_NUM(pkt->ip6_nxt);
+			break;
+		case PF_FIELD_IPV6_HLIM:
+			if (pkt->has_ipv6)
+				PF_NUM(pkt->ip6_hlim);
+			break;
+		case PF_FIELD_TCP_SRCPORT:
+		case PF_FIELD_TCP_DSTPORT:
+		case PF_FIELD_TCP_PORT:
+			if (!pkt->has_tcp)
+				break;
+			if (field != PF_FIELD_TCP_DSTPORT)
+				PF_NUM(pkt->src_port);
+			if (field != PF_FIELD_TCP_SRCPORT)
+				PF_NUM(pkt->dst_port);
+			break;
+		case PF_FIELD_UDP_SRCPORT:
+		case PF_FIELD_UDP_DSTPORT:
+		case PF_FIELD_UDP_PORT:
+			if (!pkt->has_udp)
+				break;
+			if (field != PF_FIELD_UDP_DSTPORT)
+				PF_NUM(pkt->src_port);
+			if (field != PF_FIELD_UDP_SRCPORT)
+				PF_NUM(pkt->dst_port);
+			break;
+		default:
+			break;
+	}
+
+#undef PF_NUM
+#undef PF_ADDR6
+
+	return n;
+}
+
+static bool
+pf_prefix_equal(const ws_in6_addr *a, const ws_in6_addr *b, uint32_t prefix)
+{
+	unsigned bytes = prefix / 8;
+	unsigned bits = prefix % 8;
+
+	if (prefix >= 128)
+		return memcmp(a, b, sizeof(ws_in6_addr)) == 0;
+	if (memcmp(a, b, bytes) != 0)
+		return false;
+	if (bits == 0)
+		return true;
+	return ((a->bytes[bytes] ^ b->bytes[bytes]) & (0xff << (8 - bits))) == 0;
+}
+
+static bool
+pf_in_values(const pf_node_t *node, const pf_occurrence_t *occ)
+{
+	const pf_value_t *value;
+
+	for (unsigned i = 0; i < node->values->len; i++) {
+		value = &g_array_index(node->values, pf_value_t, i);
+		if (node->kind == PF_KIND_IPV6) {
+			if (pf_prefix_equal(occ->addr6, &value->addr6, value->prefix))
+				return true;
+		}
+		else if (occ->num >= value->lo && occ->num <= value->hi) {
+			return true;
+		}
+	}
+	return false;
+}
+
+static pf_result_t
+pf_eval_relation(const pf_node_t *node, const pf_packet_t *pkt)
+{
+	pf_occurrence_t occ[PF_MAX_OCCURRENCES];
+	unsigned n;
+	bool some_match = false, some_fail = false;
+	pf_result_t result;
+
+	n = pf_get_occurrences(pkt, node->field, occ);
+
+	/* A relation on an absent field is false, whatever the operator. */
+	if (n == 0)
+		return pkt->complete ? PF_FALSE : PF_UNKNOWN;
+
+	for (unsigned i = 0; i < n; i++) {
+		if (pf_in_values(node, &occ[i]) != node->negate_value)
+			some_match = true;
+		else
+			some_fail = true;
+	}
+
+	/* Further occurrences we don't know about can make "any" true or
+	 * "all" false, but not the other way around. */
+	if (node->all)
+		result = some_fail ? PF_FALSE : pkt->complete ? PF_TRUE : PF_UNKNOWN;
+	else
+		result = some_match ? PF_TRUE : pkt->complete ? PF_FALSE : PF_UNKNOWN;
+
+	if (node->negate_result && result != PF_UNKNOWN)
+		result = result == PF_TRUE ? PF_FALSE : PF_TRUE;
+	return result;
+}
+
+static pf_result_t
+pf_eval(const pf_node_t *node, const pf_packet_t *pkt)
+{
+	pf_result_t r1, r2;
+	pf_occurrence_t occ[PF_MAX_OCCURRENCES];
+	bool present;
+
+	switch (node->type) {
+		case PF_NODE_UNKNOWN:
+			return PF_UNKNOWN;
+
+		case PF_NODE_NOT:
+			r1 = pf_eval(node->left, pkt);
+			if (r1 == PF_UNKNOWN)
+				return PF_UNKNOWN;
+			return r1 == PF_TRUE ? PF_FALSE : PF_TRUE;
+
+		case PF_NODE_AND:
+			r1 = pf_eval(node->left, pkt);
+			if (r1 == PF_FALSE)
+				return PF_FALSE;
+			r2 = pf_eval(node->right, pkt);
+			if (r2 == PF_FALSE)
+				return PF_FALSE;
+			return r1 == PF_TRUE && r2 == PF_TRUE ? PF_TRUE : PF_UNKNOWN;
+
+		case PF_NODE_OR:
+			r1 = pf_eval(node->left, pkt);
+			if (r1 == PF_TRUE)
+				return PF_TRUE;
+			r2 = pf_eval(node->right, pkt);
+			if (r2 == PF_TRUE)
+				return PF_TRUE;
+			return r1 == PF_FALSE && r2 == PF_FALSE ? PF_FALSE : PF_UNKNOWN;
+
+		case PF_NODE_EXISTS:
+			if (node->kind == PF_KIND_PROTOCOL)
+				present = pf_has_protocol(pkt, node->field);
+			else
+				present = pf_get_occurrences(pkt, node->field, occ) > 0;
+			if (present)
+				return PF_TRUE;
+			return pkt->complete ? PF_FALSE : PF_UNKNOWN;
+
+		case PF_NODE_RELATION:
+			return pf_eval_relation(node, pkt);
+	}
+	return PF_UNKNOWN;
+}
+
+bool
+df_prefilter_rejects(const df_prefilter_t *pf, int encap,
+			const uint8_t *data, unsigned len)
+{
+	pf_packet_t pkt;
+
+	if (!pf_parse(&pkt, pf, encap, data, len))
+		return false;
+
+	return pf_eval(pf->root, &pkt) == PF_FALSE;
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 noexpandtab:
+ * :indentSize=8:tabSize=8:noTabs=false:
+ */
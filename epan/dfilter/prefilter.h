@@ -0,0 +1,33 @@
+/** @file
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 2001 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef PREFILTER_H
+#define PREFILTER_H
+
+#include "dfilter-int.h"
+
+typedef struct _df_prefilter df_prefilter_t;
+
+/*
+ * Derive a raw-bytes prefilter from the semantically checked syntax
+ * tree. Must be called before the code is generated, because that
+ * consumes parts of the tree. Returns NULL if no packet could ever be
+ * rejected from its raw bytes alone.
+ */
+df_prefilter_t *
+dfw_prefilter(dfwork_t *dfw);
+
+void
+df_prefilter_free(df_prefilter_t *pf);
+
+bool
+df_prefilter_rejects(const df_prefilter_t *pf, int encap,
+			const uint8_t *data, unsigned len);
+
+#endif
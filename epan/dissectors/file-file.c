@@ -120,9 +120,9 @@ dissect_file_record(tvbuff_t *tvb, packet_info *pinfo, proto_tree *parent_tree,
 		ti = proto_tree_add_boolean(fh_tree, hf_file_ignored, tvb, 0, 0,pinfo->fd->ignored);
 		proto_item_set_generated(ti);
 
-		if(pinfo->fd->pfd != 0){
+		if(p_get_proto_data_count(wmem_file_scope(), pinfo) != 0){
 			proto_item *ppd_item;
-			unsigned num_entries = g_slist_length(pinfo->fd->pfd);
+			unsigned num_entries = p_get_proto_data_count(wmem_file_scope(), pinfo);
 			unsigned i;
 			ppd_item = proto_tree_add_uint(fh_tree, hf_file_num_p_prot_data, tvb, 0, 0, num_entries);
 			proto_item_set_generated(ppd_item);
@@ -5271,7 +5271,7 @@ proto_register_http2(void)
 
     register_follow_stream(proto_http2, "http2_follow", http2_follow_conv_filter, http2_follow_index_filter, tcp_follow_address_filter,
                            tcp_port_to_display, follow_http2_tap_listener, get_tcp_stream_count,
-                           http2_get_sub_stream_id);
+                           http2_get_sub_stream_id, get_tcp_stream_frames);
 }
 
 static void http2_stats_tree_init(stats_tree* st)
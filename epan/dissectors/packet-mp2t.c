@@ -1962,7 +1962,7 @@ proto_register_mp2t(void)
 
     /* MPEG2 TS is sometimes carried on UDP or RTP over UDP so using the UDP
      * address filter is better than nothing for tshark. */
-    register_follow_stream(proto_mp2t, "mp2t_follow", mp2t_follow_conv_filter, mp2t_follow_index_filter, udp_follow_address_filter, udp_port_to_display, follow_tvb_tap_listener, mp2t_get_stream_count, mp2t_get_sub_stream_id);
+    register_follow_stream(proto_mp2t, "mp2t_follow", mp2t_follow_conv_filter, mp2t_follow_index_filter, udp_follow_address_filter, udp_port_to_display, follow_tvb_tap_listener, mp2t_get_stream_count, mp2t_get_sub_stream_id, NULL);
 }
 
 
@@ -5908,7 +5908,7 @@ proto_register_quic(void)
 
     register_follow_stream(proto_quic, "quic_follow", quic_follow_conv_filter, quic_follow_index_filter, udp_follow_address_filter,
                            udp_port_to_display, follow_quic_tap_listener, get_quic_connections_count,
-                           quic_get_sub_stream_id);
+                           quic_get_sub_stream_id, NULL);
 
     reassembly_table_register(&quic_reassembly_table,
                               &quic_reassembly_table_functions);
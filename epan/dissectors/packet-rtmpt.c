@@ -607,9 +607,9 @@ typedef struct rtmpt_conv {
 static void
 rtmpt_packet_mark_depended(void *data, void *user_data)
 {
-    frame_data *fd = (frame_data *)user_data;
+    packet_info *pinfo = (packet_info *)user_data;
     uint32_t frame_num = GPOINTER_TO_UINT(data);
-    mark_frame_as_depended_upon(fd, frame_num);
+    mark_frame_as_depended_upon(pinfo, frame_num);
 }
 
 /* Header length helpers */
@@ -2559,7 +2559,7 @@ dissect_rtmpt_common(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, rtmpt_
                 if (tp->have == tp->want) {
                         /* Whole packet is complete */
                         wmem_tree_insert32(rconv->packets[cdir], tp->lastseq, tp);
-                        wmem_list_foreach(tp->frames, rtmpt_packet_mark_depended, pinfo->fd);
+                        wmem_list_foreach(tp->frames, rtmpt_packet_mark_depended, pinfo);
 
                         pktbuf = tvb_new_child_real_data(tvb, tp->data.p, tp->have, tp->have);
                         add_new_data_source(pinfo, pktbuf, "Unchunked RTMP");
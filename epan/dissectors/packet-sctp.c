@@ -3009,7 +3009,7 @@ fragment_reassembly(tvbuff_t *tvb, sctp_fragment *fragment,
                                      frag_i->frame_num, offset, offset + frag_i->len - 1, frag_i->len);
           offset += frag_i->len;
 
-          mark_frame_as_depended_upon(pinfo->fd, frag_i->frame_num);
+          mark_frame_as_depended_upon(pinfo, frag_i->frame_num);
         }
 
         for (frag_i = msg->fragments;
@@ -3021,7 +3021,7 @@ fragment_reassembly(tvbuff_t *tvb, sctp_fragment *fragment,
                                      frag_i->frame_num, offset, offset + frag_i->len - 1, frag_i->len);
           offset += frag_i->len;
 
-          mark_frame_as_depended_upon(pinfo->fd, frag_i->frame_num);
+          mark_frame_as_depended_upon(pinfo, frag_i->frame_num);
         }
       } else {
         for (frag_i = find_fragment(message->begin, stream_id, stream_seq_num, u_bit);
@@ -3033,7 +3033,7 @@ fragment_reassembly(tvbuff_t *tvb, sctp_fragment *fragment,
                                      frag_i->frame_num, offset, offset + frag_i->len - 1, frag_i->len);
           offset += frag_i->len;
 
-          mark_frame_as_depended_upon(pinfo->fd, frag_i->frame_num);
+          mark_frame_as_depended_upon(pinfo, frag_i->frame_num);
         }
       }
 
@@ -3248,7 +3248,7 @@ fragment_reassembly(tvbuff_t *tvb, sctp_fragment *fragment,
                                  frag_i->frame_num, offset, offset + frag_i->len - 1, frag_i->len);
       offset += frag_i->len;
 
-      mark_frame_as_depended_upon(pinfo->fd, frag_i->frame_num);
+      mark_frame_as_depended_upon(pinfo, frag_i->frame_num);
     }
 
     for (frag_i = msg->fragments;
@@ -3260,7 +3260,7 @@ fragment_reassembly(tvbuff_t *tvb, sctp_fragment *fragment,
                                  frag_i->frame_num, offset, offset + frag_i->len - 1, frag_i->len);
       offset += frag_i->len;
 
-      mark_frame_as_depended_upon(pinfo->fd, frag_i->frame_num);
+      mark_frame_as_depended_upon(pinfo, frag_i->frame_num);
     }
   } else {
     for (frag_i = find_fragment(message->begin, stream_id, stream_seq_num, u_bit);
@@ -3272,7 +3272,7 @@ fragment_reassembly(tvbuff_t *tvb, sctp_fragment *fragment,
                                  frag_i->frame_num, offset, offset + frag_i->len - 1, frag_i->len);
       offset += frag_i->len;
 
-      mark_frame_as_depended_upon(pinfo->fd, frag_i->frame_num);
+      mark_frame_as_depended_upon(pinfo, frag_i->frame_num);
     }
   }
 
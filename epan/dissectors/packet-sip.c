@@ -7735,7 +7735,7 @@ void proto_register_sip(void)
     ws_mempbrk_compile(&pbrk_via_param_end, "\t;, ");
 
     register_follow_stream(proto_sip, "sip_follow", sip_follow_conv_filter, sip_follow_index_filter, sip_follow_address_filter,
-                           udp_port_to_display, follow_tvb_tap_listener, NULL, NULL);
+                           udp_port_to_display, follow_tvb_tap_listener, NULL, NULL, NULL);
 }
 
 void
@@ -975,6 +975,7 @@ static dissector_handle_t tcp_opt_unknown_handle;
 static capture_dissector_handle_t tcp_cap_handle;
 
 static uint32_t tcp_stream_count;
+static follow_stream_index_t *tcp_stream_index;
 static uint32_t mptcp_stream_count;
 
 
@@ -2194,6 +2195,12 @@ uint32_t get_tcp_stream_count(void)
     return tcp_stream_count;
 }
 
+/* Return the frames of a stream */
+const uint32_t *get_tcp_stream_frames(unsigned stream, unsigned *num_frames)
+{
+    return follow_stream_index_get_frames(tcp_stream_index, stream, num_frames);
+}
+
 /* Return the mptcp current stream count */
 uint32_t get_mptcp_stream_count(void)
 {
@@ -8568,6 +8575,9 @@ dissect_tcp(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, void* data _U_)
         item = proto_tree_add_uint(tcp_tree, hf_tcp_stream, tvb, offset, 0, tcpd->stream);
         proto_item_set_generated(item);
         tcpinfo.stream = tcpd->stream;
+        if (!PINFO_FD_VISITED(pinfo)) {
+            follow_stream_index_add_frame(tcp_stream_index, tcpd->stream, pinfo->num);
+        }
 
         if (tcp_calculate_ts) {
             tcppd = (struct tcp_per_packet_data_t *)p_get_proto_data(wmem_file_scope(), pinfo, proto_tcp, pinfo->curr_layer_num);
@@ -9587,6 +9597,7 @@ static void
 tcp_init(void)
 {
     tcp_stream_count = 0;
+    tcp_stream_index = follow_stream_index_new(wmem_file_scope());
 
     /* MPTCP init */
     mptcp_stream_count = 0;
@@ -10884,7 +10895,8 @@ proto_register_tcp(void)
 
     register_conversation_table(proto_mptcp, false, mptcpip_conversation_packet, tcpip_endpoint_packet);
     register_follow_stream(proto_tcp, "tcp_follow", tcp_follow_conv_filter, tcp_follow_index_filter, tcp_follow_address_filter,
-                            tcp_port_to_display, follow_tcp_tap_listener, get_tcp_stream_count, NULL);
+                            tcp_port_to_display, follow_tcp_tap_listener, get_tcp_stream_count, NULL,
+                            get_tcp_stream_frames);
 
     tcp_tap = register_tap("tcp");
     tcp_follow_tap = register_tap("tcp_follow");
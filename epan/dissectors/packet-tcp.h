@@ -590,6 +590,15 @@ extern void add_tcp_process_info(uint32_t frame_num, address *local_addr, addres
  */
 WS_DLL_PUBLIC uint32_t get_tcp_stream_count(void);
 
+/** Get the frames of a TCP stream, as recorded during the first pass
+ *
+ * @param stream The TCP stream index
+ * @param num_frames Set to the number of frames
+ * @return The frame numbers in ascending order, or NULL if there are none
+ * or if stream indexing is disabled (see follow_set_stream_index_enabled())
+ */
+WS_DLL_PUBLIC const uint32_t *get_tcp_stream_frames(unsigned stream, unsigned *num_frames);
+
 /** Get the current number of MPTCP streams
  *
  * @return The number of MPTCP streams
@@ -5477,6 +5477,8 @@ tls_decrypt_aead_record(SslDecryptSession *ssl, SslDecoder *decoder,
     const uint8_t   draft_version = ssl->session.tls13_draft_version;
     const unsigned char   *auth_tag_wire;
     unsigned char   auth_tag_calc[16];
+    /* Large enough for the DTLS 1.2 CID AAD with the largest CID. */
+    unsigned char   aad_buf[23 + 255];
     unsigned char  *aad = NULL;
     unsigned        aad_len = 0;
 
@@ -5553,7 +5555,7 @@ tls_decrypt_aead_record(SslDecryptSession *ssl, SslDecoder *decoder,
     if (is_cid) { /* if connection ID */
         if (ssl->session.deprecated_cid) {
             aad_len = 14 + cidl;
-            aad = wmem_alloc(wmem_packet_scope(), aad_len);
+            aad = aad_buf;
             phton64(aad, decoder->seq);         /* record sequence number */
             phton16(aad, decoder->epoch);       /* DTLS 1.2 includes epoch. */
             aad[8] = ct;                        /* TLSCompressed.type */
@@ -5563,7 +5565,7 @@ tls_decrypt_aead_record(SslDecryptSession *ssl, SslDecoder *decoder,
             phton16(aad + 12 + cidl, ciphertext_len);  /* TLSCompressed.length */
         } else {
             aad_len = 23 + cidl;
-            aad = wmem_alloc(wmem_packet_scope(), aad_len);
+            aad = aad_buf;
             memset(aad, 0xFF, 8);               /* seq_num_placeholder */
             aad[8] = ct;                        /* TLSCompressed.type */
             aad[9] = cidl;                      /* cid_length */
@@ -5576,7 +5578,7 @@ tls_decrypt_aead_record(SslDecryptSession *ssl, SslDecoder *decoder,
         }
     } else if (is_v12) {
         aad_len = 13;
-        aad = wmem_alloc(wmem_packet_scope(), aad_len);
+        aad = aad_buf;
         phton64(aad, decoder->seq);         /* record sequence number */
         if (version == DTLSV1DOT2_VERSION) {
             phton16(aad, decoder->epoch);   /* DTLS 1.2 includes epoch. */
@@ -5589,7 +5591,7 @@ tls_decrypt_aead_record(SslDecryptSession *ssl, SslDecoder *decoder,
         aad = decoder->dtls13_aad.data;
     } else if (draft_version >= 25 || draft_version == 0) {
         aad_len = 5;
-        aad = wmem_alloc(wmem_packet_scope(), aad_len);
+        aad = aad_buf;
         aad[0] = ct;                        /* TLSCiphertext.opaque_type (23) */
         phton16(aad + 1, record_version);   /* TLSCiphertext.legacy_record_version (0x0303) */
         phton16(aad + 3, inl);              /* TLSCiphertext.length */
@@ -6279,8 +6281,11 @@ ssl_add_record_info(int proto, packet_info *pinfo, const unsigned char *data, in
     SslRecordInfo* rec, **prec;
     SslPacketInfo *pi = tls_add_packet_info(proto, pinfo, curr_layer_num_ssl);
 
-    rec = wmem_new(wmem_file_scope(), SslRecordInfo);
-    rec->plain_data = (unsigned char *)wmem_memdup(wmem_file_scope(), data, data_len);
+    /* There is one of these for every decrypted record, so keep the
+     * plaintext in the same allocation. */
+    rec = (SslRecordInfo *)wmem_alloc(wmem_file_scope(), sizeof(SslRecordInfo) + data_len);
+    rec->plain_data = (unsigned char *)(rec + 1);
+    memcpy(rec->plain_data, data, data_len);
     rec->data_len = data_len;
     rec->id = record_id;
     rec->type = type;
@@ -6804,6 +6809,59 @@ tls_save_crandom(SslDecryptSession *ssl, ssl_master_key_map_t *mk_map)
 
 /** SSL keylog file handling. {{{ */
 
+/* Names of the regex groups holding the key, in the order of mk_tables in
+ * tls_keylog_process_lines(). */
+static const char *ssl_keyfile_key_groups[] = {
+    "encrypted_pmk",
+    "session_id",
+    "client_random",
+    "client_random_pms",
+    "client_early",
+    "client_handshake",
+    "server_handshake",
+    "client_appdata",
+    "server_appdata",
+    "early_exporter",
+    "exporter",
+    "ech_secret",
+    "ech_config",
+};
+
+/* Names of the regex groups holding the secret, in order of preference. */
+static const char *ssl_keyfile_secret_groups[] = {
+    "master_secret",
+    "pms",
+    "derived_secret",
+};
+
+/*
+ * Group numbers for the names above. Resolving them once avoids a name lookup
+ * and a string copy per group for every line of (possibly huge) key logs.
+ */
+static int ssl_keyfile_key_group_nums[G_N_ELEMENTS(ssl_keyfile_key_groups)];
+static int ssl_keyfile_secret_group_nums[G_N_ELEMENTS(ssl_keyfile_secret_groups)];
+
+static void
+ssl_keyfile_resolve_groups(GRegex *regex)
+{
+    for (unsigned i = 0; i < G_N_ELEMENTS(ssl_keyfile_key_groups); i++) {
+        ssl_keyfile_key_group_nums[i] = g_regex_get_string_number(regex, ssl_keyfile_key_groups[i]);
+    }
+    for (unsigned i = 0; i < G_N_ELEMENTS(ssl_keyfile_secret_groups); i++) {
+        ssl_keyfile_secret_group_nums[i] = g_regex_get_string_number(regex, ssl_keyfile_secret_groups[i]);
+    }
+}
+
+/* Returns the position of a group which participated in the match and is not
+ * empty. */
+static bool
+ssl_keyfile_fetch_group(const GMatchInfo *mi, int group_num, int *start, int *end)
+{
+    return group_num >= 0 &&
+        g_match_info_fetch_pos(mi, group_num, start, end) &&
+        *start >= 0 && *end > *start;
+}
+
 static GRegex *
 ssl_compile_keyfile_regex(void)
 {
@@ -6851,36 +6909,37 @@ ssl_compile_keyfile_regex(void)
                              gerr->message);
             g_error_free(gerr);
             regex = NULL;
+        } else {
+            ssl_keyfile_resolve_groups(regex);
         }
     }
 
     return regex;
 }
 
-typedef struct ssl_master_key_match_group {
-    const char *re_group_name;
-    GHashTable *master_key_ht;
-} ssl_master_key_match_group_t;
-
 void
 tls_keylog_process_lines(const ssl_master_key_map_t *mk_map, const uint8_t *data, unsigned datalen)
 {
-    ssl_master_key_match_group_t mk_groups[] = {
-        { "encrypted_pmk",  mk_map->pre_master },
-        { "session_id",     mk_map->session },
-        { "client_random",  mk_map->crandom },
-        { "client_random_pms",  mk_map->pms },
+    GHashTable *mk_tables[] = {
+        mk_map->pre_master,
+        mk_map->session,
+        mk_map->crandom,
+        mk_map->pms,
         /* TLS 1.3 map from Client Random to derived secret. */
-        { "client_early",       mk_map->tls13_client_early },
-        { "client_handshake",   mk_map->tls13_client_handshake },
-        { "server_handshake",   mk_map->tls13_server_handshake },
-        { "client_appdata",     mk_map->tls13_client_appdata },
-        { "server_appdata",     mk_map->tls13_server_appdata },
-        { "early_exporter",     mk_map->tls13_early_exporter },
-        { "exporter",           mk_map->tls13_exporter },
-        { "ech_secret",         mk_map->ech_secret },
-        { "ech_config",         mk_map->ech_config },
+        mk_map->tls13_client_early,
+        mk_map->tls13_client_handshake,
+        mk_map->tls13_server_handshake,
+        mk_map->tls13_client_appdata,
+        mk_map->tls13_server_appdata,
+        mk_map->tls13_early_exporter,
+        mk_map->tls13_exporter,
+        mk_map->ech_secret,
+        mk_map->ech_config,
     };
+    unsigned added = 0, duplicates = 0;
+    size_t added_bytes = 0;
+
+    G_STATIC_ASSERT(G_N_ELEMENTS(mk_tables) == G_N_ELEMENTS(ssl_keyfile_key_groups));
 
     /* The format of the file is a series of records with one of the following formats:
      *   - "RSA xxxx yyyy"
@@ -6944,47 +7003,55 @@ tls_keylog_process_lines(const ssl_master_key_map_t *mk_map, const uint8_t *data
         ssl_debug_printf("  checking keylog line: %.*s\n", (int)linelen, line);
         GMatchInfo *mi;
         if (g_regex_match_full(regex, line, linelen, 0, G_REGEX_MATCH_ANCHORED, &mi, NULL)) {
-            char *hex_key, *hex_pre_ms_or_ms;
-            StringInfo *key = wmem_new(wmem_file_scope(), StringInfo);
-            StringInfo *pre_ms_or_ms = NULL;
+            StringInfo *key, *pre_ms_or_ms, *old_value;
             GHashTable *ht = NULL;
+            int start = -1, end = -1;
+            unsigned i;
 
             /* Is the PMS being supplied with the PMS_CLIENT_RANDOM
              * otherwise we will use the Master Secret
              */
-            hex_pre_ms_or_ms = g_match_info_fetch_named(mi, "master_secret");
-            if (hex_pre_ms_or_ms == NULL || !*hex_pre_ms_or_ms) {
-                g_free(hex_pre_ms_or_ms);
-                hex_pre_ms_or_ms = g_match_info_fetch_named(mi, "pms");
-            }
-            if (hex_pre_ms_or_ms == NULL || !*hex_pre_ms_or_ms) {
-                g_free(hex_pre_ms_or_ms);
-                hex_pre_ms_or_ms = g_match_info_fetch_named(mi, "derived_secret");
+            for (i = 0; i < G_N_ELEMENTS(ssl_keyfile_secret_group_nums); i++) {
+                if (ssl_keyfile_fetch_group(mi, ssl_keyfile_secret_group_nums[i], &start, &end)) {
+                    break;
+                }
             }
             /* There is always a match, otherwise the regex is wrong. */
-            DISSECTOR_ASSERT(hex_pre_ms_or_ms && strlen(hex_pre_ms_or_ms));
+            DISSECTOR_ASSERT(i < G_N_ELEMENTS(ssl_keyfile_secret_group_nums));
 
             /* convert from hex to bytes and save to hashtable */
             pre_ms_or_ms = wmem_new(wmem_file_scope(), StringInfo);
-            from_hex(pre_ms_or_ms, hex_pre_ms_or_ms, strlen(hex_pre_ms_or_ms));
-            g_free(hex_pre_ms_or_ms);
+            from_hex(pre_ms_or_ms, line + start, end - start);
 
             /* Find a master key from any format (CLIENT_RANDOM, SID, ...) */
-            for (unsigned i = 0; i < G_N_ELEMENTS(mk_groups); i++) {
-                ssl_master_key_match_group_t *g = &mk_groups[i];
-                hex_key = g_match_info_fetch_named(mi, g->re_group_name);
-                if (hex_key && *hex_key) {
-                    ssl_debug_printf("    matched %s\n", g->re_group_name);
-                    ht = g->master_key_ht;
-                    from_hex(key, hex_key, strlen(hex_key));
-                    g_free(hex_key);
+            key = wmem_new(wmem_file_scope(), StringInfo);
+            for (i = 0; i < G_N_ELEMENTS(ssl_keyfile_key_group_nums); i++) {
+                if (ssl_keyfile_fetch_group(mi, ssl_keyfile_key_group_nums[i], &start, &end)) {
+                    ssl_debug_printf("    matched %s\n", ssl_keyfile_key_groups[i]);
+                    ht = mk_tables[i];
+                    from_hex(key, line + start, end - start);
                     break;
                 }
-                g_free(hex_key);
             }
             DISSECTOR_ASSERT(ht); /* Cannot be reached, or regex is wrong. */
 
-            g_hash_table_insert(ht, key, pre_ms_or_ms);
+            /*
+             * Key logs are often shared between captures and may be read
+             * again when the file is replaced. Do not keep another copy of a
+             * secret that is already known.
+             */
+            old_value = (StringInfo *)g_hash_table_lookup(ht, key);
+            if (old_value && ssl_equal(old_value, pre_ms_or_ms)) {
+                wmem_free(wmem_file_scope(), key->data);
+                wmem_free(wmem_file_scope(), key);
+                wmem_free(wmem_file_scope(), pre_ms_or_ms->data);
+                wmem_free(wmem_file_scope(), pre_ms_or_ms);
+                duplicates++;
+            } else {
+                g_hash_table_insert(ht, key, pre_ms_or_ms);
+                added++;
+                added_bytes += sizeof(StringInfo) * 2 + key->data_len + pre_ms_or_ms->data_len;
+            }
 
         } else if (linelen > 0 && line[0] != '#') {
             ssl_debug_printf("    unrecognized line\n");
@@ -6992,6 +7059,11 @@ tls_keylog_process_lines(const ssl_master_key_map_t *mk_map, const uint8_t *data
         /* always free match info even if there is no match. */
         g_match_info_free(mi);
     }
+
+    if (added || duplicates) {
+        ssl_debug_printf("%s added %u secrets (%zu bytes), skipped %u already known\n",
+                         G_STRFUNC, added, added_bytes, duplicates);
+    }
 }
 
 void
@@ -7027,22 +7099,53 @@ ssl_load_keyfile(const char *tls_keylog_filename, FILE **keylog_file,
         }
     }
 
+    /*
+     * Read the file in large chunks rather than line by line, key logs from
+     * TLS inspection proxies can have millions of lines. Only complete lines
+     * are consumed; a trailing line that is still being written is read
+     * again next time, so appending to the file during a live capture works.
+     */
+    char buf[16384];
+    size_t buflen = 0;
     for (;;) {
-        char buf[1110], *line;
-        line = fgets(buf, sizeof(buf), *keylog_file);
-        if (!line) {
-            if (feof(*keylog_file)) {
-                /* Ensure that newly appended keys can be read in the future. */
-                clearerr(*keylog_file);
-            } else if (ferror(*keylog_file)) {
+        size_t nread = fread(buf + buflen, 1, sizeof(buf) - buflen, *keylog_file);
+        buflen += nread;
+        if (nread == 0) {
+            if (ferror(*keylog_file)) {
                 ssl_debug_printf("%s Error while reading key log file, closing it!\n", G_STRFUNC);
                 fclose(*keylog_file);
                 *keylog_file = NULL;
+                return;
             }
             break;
         }
-        tls_keylog_process_lines(mk_map, (uint8_t *)line, (int)strlen(line));
+
+        const char *last_lf = (const char *)ws_memrchr(buf, '\n', buflen);
+        size_t linelen = last_lf ? (size_t)(last_lf - buf) + 1 : 0;
+        if (linelen == 0 && buflen == sizeof(buf)) {
+            /* Overlong line, it cannot be a valid key anyway. */
+            linelen = buflen;
+        }
+        if (linelen > 0) {
+            tls_keylog_process_lines(mk_map, (uint8_t *)buf, (unsigned)linelen);
+            buflen -= linelen;
+            memmove(buf, buf + linelen, buflen);
+        }
+    }
+
+    if (buflen > 0) {
+        /*
+         * The last line has no newline (yet). Use it now in case the file
+         * simply ends this way, but rewind so that it is processed again
+         * once the writer has completed it.
+         */
+        tls_keylog_process_lines(mk_map, (uint8_t *)buf, (unsigned)buflen);
+        if (ws_fseek64(*keylog_file, -(int64_t)buflen, SEEK_CUR) != 0) {
+            ssl_debug_printf("%s failed to rewind key log file\n", G_STRFUNC);
+        }
     }
+    /* Ensure that newly appended keys can be read in the future. */
+    clearerr(*keylog_file);
 }
 /** SSL keylog file handling. }}} */
 
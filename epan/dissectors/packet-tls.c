@@ -4959,7 +4959,8 @@ proto_register_tls(void)
         "tls_follow", tls_follow_tap);
 
     register_follow_stream(proto_tls, "tls_follow", tcp_follow_conv_filter, tcp_follow_index_filter, tcp_follow_address_filter,
-                            tcp_port_to_display, ssl_follow_tap_listener, get_tcp_stream_count, NULL);
+                            tcp_port_to_display, ssl_follow_tap_listener, get_tcp_stream_count, NULL,
+                            get_tcp_stream_frames);
     secrets_register_type(SECRETS_TYPE_TLS, tls_secrets_block_callback);
 }
 
@@ -109,6 +109,7 @@ static bool udplite_check_checksum;
 static dissector_table_t udp_dissector_table;
 static heur_dissector_list_t heur_subdissector_list;
 static uint32_t udp_stream_count;
+static follow_stream_index_t *udp_stream_index;
 
 /* Determine if there is a sub-dissector and call it.  This has been */
 /* separated into a stand alone routine so other protocol dissectors */
@@ -467,6 +468,12 @@ uint32_t get_udp_stream_count(void)
     return udp_stream_count;
 }
 
+/* Return the frames of a stream */
+const uint32_t *get_udp_stream_frames(unsigned stream, unsigned *num_frames)
+{
+    return follow_stream_index_get_frames(udp_stream_index, stream, num_frames);
+}
+
 static void
 handle_export_pdu_dissection_table(packet_info *pinfo, tvbuff_t *tvb, uint32_t port)
 {
@@ -1269,6 +1276,10 @@ dissect(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, uint32_t ip_proto)
         */
         udph->uh_stream = udpd->stream;
 
+        if (!PINFO_FD_VISITED(pinfo)) {
+            follow_stream_index_add_frame(udp_stream_index, udpd->stream, pinfo->num);
+        }
+
         /* Copy the stream index into pinfo as well to make it available
          * to callback functions (essentially conversation following events in GUI)
          */
@@ -1344,6 +1355,7 @@ static void
 udp_init(void)
 {
     udp_stream_count = 0;
+    udp_stream_index = follow_stream_index_new(wmem_file_scope());
 }
 
 void
@@ -1559,7 +1571,8 @@ proto_register_udp(void)
     register_conversation_table(proto_udp, false, udpip_conversation_packet, udpip_endpoint_packet);
     register_conversation_filter("udp", "UDP", udp_filter_valid, udp_build_filter_by_id, NULL);
     register_follow_stream(proto_udp, "udp_follow", udp_follow_conv_filter, udp_follow_index_filter, udp_follow_address_filter,
-                        udp_port_to_display, follow_tvb_tap_listener, get_udp_stream_count, NULL);
+                        udp_port_to_display, follow_tvb_tap_listener, get_udp_stream_count, NULL,
+                        get_udp_stream_frames);
 
     register_init_routine(udp_init);
 
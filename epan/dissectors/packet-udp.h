@@ -111,6 +111,16 @@ add_udp_process_info(uint32_t frame_num, address *local_addr, address *remote_ad
 WS_DLL_PUBLIC uint32_t
 get_udp_stream_count(void);
 
+/** Get the frames of a UDP stream, as recorded during the first pass
+ *
+ * @param stream The UDP stream index
+ * @param num_frames Set to the number of frames
+ * @return The frame numbers in ascending order, or NULL if there are none
+ * or if stream indexing is disabled (see follow_set_stream_index_enabled())
+ */
+WS_DLL_PUBLIC const uint32_t *
+get_udp_stream_frames(unsigned stream, unsigned *num_frames);
+
 WS_DLL_PUBLIC void
 decode_udp_ports(tvbuff_t *, int, packet_info *, proto_tree *, int, int, int);
 
@@ -1343,7 +1343,7 @@ proto_register_usb_com(void)
     cdc_data_follow_tap = register_tap("cdc_data_follow");
     register_follow_stream(proto_usb_com, "cdc_data_follow", cdc_data_follow_conv_filter, cdc_data_follow_index_filter,
                            cdc_data_follow_address_filter, cdc_data_port_to_display, follow_cdc_data_tap_listener,
-                           get_cdc_data_stream_count, NULL);
+                           get_cdc_data_stream_count, NULL, NULL);
 }
 
 void
@@ -1045,7 +1045,7 @@ proto_register_websocket(void)
   websocket_follow_tap = register_tap("websocket_follow"); /* websocket follow tap */
   register_follow_stream(proto_websocket, "websocket_follow", tcp_follow_conv_filter, tcp_follow_index_filter,
                          tcp_follow_address_filter,	tcp_port_to_display, follow_tvb_tap_listener,
-                         get_tcp_stream_count, NULL);
+                         get_tcp_stream_count, NULL, get_tcp_stream_frames);
 
   proto_register_field_array(proto_websocket, hf, array_length(hf));
   proto_register_subtree_array(ett, array_length(ett));
@@ -40,6 +40,7 @@
 #include "conversation.h"
 #include "except.h"
 #include "packet.h"
+#include "proto_data.h"
 #include "prefs.h"
 #include "column-info.h"
 #include "tap.h"
@@ -538,6 +539,13 @@ epan_get_frame_ts(const epan_t *session, uint32_t frame_num)
 	return abs_ts;
 }
 
+void
+epan_add_dependent_frame(const epan_t *session, frame_data *fd, uint32_t frame_num)
+{
+	if (session && session->funcs.add_dependent_frame)
+		session->funcs.add_dependent_frame(session->prov, fd, frame_num);
+}
+
 void
 epan_free(epan_t *session)
 {
@@ -609,7 +617,7 @@ epan_dissect_reset(epan_dissect_t *edt)
 
 	wtap_block_unref(edt->pi.rec->block);
 
-	g_slist_free(edt->pi.proto_data);
+	p_free_proto_data_list(edt->pi.proto_data);
 
 	/* Free the data sources list. */
 	free_data_sources(&edt->pi);
@@ -720,7 +728,7 @@ epan_dissect_cleanup(epan_dissect_t* edt)
 
 	g_slist_foreach(epan_plugins, epan_plugin_dissect_cleanup, edt);
 
-	g_slist_free(edt->pi.proto_data);
+	p_free_proto_data_list(edt->pi.proto_data);
 
 	/* Free the data sources list. */
 	free_data_sources(&edt->pi);
@@ -756,6 +764,12 @@ epan_dissect_prime_with_dfilter(epan_dissect_t *edt, const dfilter_t* dfcode)
 	dfilter_prime_proto_tree(dfcode, edt->tree);
 }
 
+void
+epan_dissect_set_depth_limit(epan_dissect_t *edt, struct depth_limit *limit)
+{
+	edt->pi.depth_limit = limit;
+}
+
 void
 epan_dissect_prime_with_dfilter_print(epan_dissect_t *edt, const dfilter_t* dfcode)
 {
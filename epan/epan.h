@@ -60,6 +60,7 @@ struct packet_provider_funcs {
 	const char *(*get_interface_name)(struct packet_provider_data *prov, uint32_t interface_id, unsigned section_number);
 	const char *(*get_interface_description)(struct packet_provider_data *prov, uint32_t interface_id, unsigned section_number);
 	wtap_block_t (*get_modified_block)(struct packet_provider_data *prov, const frame_data *fd);
+	void (*add_dependent_frame)(struct packet_provider_data *prov, frame_data *fd, uint32_t frame_num);
 };
 
 /**
@@ -152,6 +153,8 @@ WS_DLL_PUBLIC const char *epan_get_interface_description(const epan_t *session,
 
 const nstime_t *epan_get_frame_ts(const epan_t *session, uint32_t frame_num);
 
+void epan_add_dependent_frame(const epan_t *session, frame_data *fd, uint32_t frame_num);
+
 WS_DLL_PUBLIC void epan_free(epan_t *session);
 
 WS_DLL_PUBLIC const char*
@@ -220,6 +223,12 @@ WS_DLL_PUBLIC
 void
 epan_dissect_prime_with_dfilter(epan_dissect_t *edt, const struct epan_dfilter *dfcode);
 
+/** Skip dissectors the display filter a depth limit was created from doesn't
+ * need when dissecting the next packet. Must be set again for every packet. */
+WS_DLL_PUBLIC
+void
+epan_dissect_set_depth_limit(epan_dissect_t *edt, struct depth_limit *limit);
+
 /** Prime an epan_dissect_t's proto_tree using the fields/protocols used in a dfilter, marked for print. */
 WS_DLL_PUBLIC
 void
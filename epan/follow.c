@@ -30,14 +30,24 @@ struct register_follow {
     tap_packet_cb tap_handler; /* tap listener handler */
     follow_stream_count_func stream_count; /* maximum stream count, used for UI */
     follow_sub_stream_id_func sub_stream_id; /* sub-stream id, used for UI */
+    follow_stream_frames_func stream_frames; /* frames of a stream, used for retapping */
+};
+
+struct _follow_stream_index {
+    wmem_allocator_t *allocator;
+    wmem_array_t **streams;    /* frame numbers (uint32_t) indexed by stream */
+    unsigned num_streams;
 };
 
 static wmem_tree_t *registered_followers;
 
+static bool stream_index_enabled;
+
 void register_follow_stream(const int proto_id, const char* tap_listener,
                             follow_conv_filter_func conv_filter, follow_index_filter_func index_filter, follow_address_filter_func address_filter,
                             follow_port_to_display_func port_to_display, tap_packet_cb tap_handler,
-                            follow_stream_count_func stream_count, follow_sub_stream_id_func sub_stream_id)
+                            follow_stream_count_func stream_count, follow_sub_stream_id_func sub_stream_id,
+                            follow_stream_frames_func stream_frames)
 {
   register_follow_t *follower;
   DISSECTOR_ASSERT(tap_listener);
@@ -58,6 +68,7 @@ void register_follow_stream(const int proto_id, const char* tap_listener,
   follower->tap_handler    = tap_handler;
   follower->stream_count   = stream_count;
   follower->sub_stream_id  = sub_stream_id;
+  follower->stream_frames  = stream_frames;
 
   if (registered_followers == NULL)
     registered_followers = wmem_tree_new(wmem_epan_scope());
@@ -116,6 +127,72 @@ follow_sub_stream_id_func get_follow_sub_stream_id_func(register_follow_t* follo
   return follower->sub_stream_id;
 }
 
+follow_stream_frames_func get_follow_stream_frames_func(register_follow_t* follower)
+{
+  return follower->stream_frames;
+}
+
+void follow_set_stream_index_enabled(bool enabled)
+{
+  stream_index_enabled = enabled;
+}
+
+follow_stream_index_t* follow_stream_index_new(wmem_allocator_t *allocator)
+{
+  follow_stream_index_t *index;
+
+  /* The index costs memory for every frame, so it is opt-in. */
+  if (!stream_index_enabled)
+    return NULL;
+
+  index = wmem_new0(allocator, follow_stream_index_t);
+
+  index->allocator = allocator;
+  return index;
+}
+
+void follow_stream_index_add_frame(follow_stream_index_t *index, unsigned stream, uint32_t frame_num)
+{
+  wmem_array_t *frames;
+  unsigned len;
+
+  if (index == NULL)
+    return;
+
+  if (stream >= index->num_streams) {
+    unsigned num_streams = MAX(index->num_streams * 2, 64);
+
+    while (stream >= num_streams)
+      num_streams *= 2;
+    index->streams = (wmem_array_t **)wmem_realloc(index->allocator, index->streams, num_streams * sizeof(wmem_array_t *));
+    memset(index->streams + index->num_streams, 0, (num_streams - index->num_streams) * sizeof(wmem_array_t *));
+    index->num_streams = num_streams;
+  }
+
+  frames = index->streams[stream];
+  if (frames == NULL) {
+    frames = wmem_array_sized_new(index->allocator, sizeof(uint32_t), 8);
+    index->streams[stream] = frames;
+  }
+
+  /* A frame can carry several PDUs of the same stream. */
+  len = wmem_array_get_count(frames);
+  if (len > 0 && *(uint32_t *)wmem_array_index(frames, len - 1) >= frame_num)
+    return;
+
+  wmem_array_append_one(frames, frame_num);
+}
+
+const uint32_t* follow_stream_index_get_frames(const follow_stream_index_t *index, unsigned stream, unsigned *num_frames)
+{
+  *num_frames = 0;
+  if (index == NULL || stream >= index->num_streams || index->streams[stream] == NULL)
+    return NULL;
+
+  *num_frames = wmem_array_get_count(index->streams[stream]);
+  return (const uint32_t *)wmem_array_get_raw(index->streams[stream]);
+}
+
 register_follow_t* get_follow_by_name(const char* proto_short_name)
 {
   return (register_follow_t*)wmem_tree_lookup_string(registered_followers, proto_short_name, 0);
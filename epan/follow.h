@@ -72,12 +72,14 @@ typedef char* (*follow_address_filter_func)(address* src_addr, address* dst_addr
 typedef char* (*follow_port_to_display_func)(wmem_allocator_t *allocator, unsigned port);
 typedef uint32_t (*follow_stream_count_func)(void);
 typedef bool (*follow_sub_stream_id_func)(unsigned stream, unsigned sub_stream, bool le, unsigned *sub_stream_out);
+typedef const uint32_t* (*follow_stream_frames_func)(unsigned stream, unsigned *num_frames);
 
 WS_DLL_PUBLIC
 void register_follow_stream(const int proto_id, const char* tap_listener,
                             follow_conv_filter_func conv_filter, follow_index_filter_func index_filter, follow_address_filter_func address_filter,
                             follow_port_to_display_func port_to_display, tap_packet_cb tap_handler,
-                            follow_stream_count_func stream_count, follow_sub_stream_id_func sub_stream_id);
+                            follow_stream_count_func stream_count, follow_sub_stream_id_func sub_stream_id,
+                            follow_stream_frames_func stream_frames);
 
 /** Get protocol ID from registered follower
  *
@@ -163,6 +165,58 @@ WS_DLL_PUBLIC follow_stream_count_func get_follow_stream_count_func(register_fol
  */
 WS_DLL_PUBLIC follow_sub_stream_id_func get_follow_sub_stream_id_func(register_follow_t* follower);
 
+/** Provide function that returns the frames of a stream, as recorded during
+ * the first pass, so that only those frames need to be tapped again to follow
+ * the stream. The returned frame numbers are in ascending order and include
+ * every frame which matches the index filter of the stream (and possibly a
+ * few more).
+ * The function can be NULL if the follower does not index its streams, and
+ * the function returns NULL if the stream is unknown or if stream indexing
+ * wasn't enabled with follow_set_stream_index_enabled().
+ *
+ * @param follower [in] Registered follower
+ * @return A stream frames handler
+ */
+WS_DLL_PUBLIC follow_stream_frames_func get_follow_stream_frames_func(register_follow_t* follower);
+
+/** Frame numbers per stream index, used to implement follow_stream_frames_func */
+typedef struct _follow_stream_index follow_stream_index_t;
+
+/** Enable or disable stream indexing. It is disabled by default, because
+ * the index of every stream is kept in memory until the file is closed.
+ * The setting applies to indexes created afterwards, i.e. to files opened
+ * after it is changed.
+ *
+ * @param enabled [in] true to record the frames of each stream
+ */
+WS_DLL_PUBLIC void follow_set_stream_index_enabled(bool enabled);
+
+/** Create an empty stream index
+ *
+ * @param allocator [in] Scope of the index, usually wmem_file_scope()
+ * @return The new index, or NULL if stream indexing is disabled. The other
+ * follow_stream_index_ functions accept NULL.
+ */
+WS_DLL_PUBLIC follow_stream_index_t* follow_stream_index_new(wmem_allocator_t *allocator);
+
+/** Record that a frame belongs to a stream. Frames must be added in
+ * ascending order, i.e. during the first pass.
+ *
+ * @param index [in] Stream index, may be NULL
+ * @param stream [in] Stream number
+ * @param frame_num [in] Frame number
+ */
+WS_DLL_PUBLIC void follow_stream_index_add_frame(follow_stream_index_t *index, unsigned stream, uint32_t frame_num);
+
+/** Get the frames recorded for a stream
+ *
+ * @param index [in] Stream index, may be NULL
+ * @param stream [in] Stream number
+ * @param num_frames [out] Number of frames
+ * @return The frame numbers in ascending order, or NULL if there are none
+ */
+WS_DLL_PUBLIC const uint32_t* follow_stream_index_get_frames(const follow_stream_index_t *index, unsigned stream, unsigned *num_frames);
+
 /** Tap function handler when dissector's tap provides follow data as a tvb.
  * Used by TCP, UDP and HTTP followers
  */
@@ -15,6 +15,7 @@
 
 #include <epan/epan.h>
 #include <epan/frame_data.h>
+#include <epan/proto_data.h>
 #include <epan/column-utils.h>
 #include <epan/timestamp.h>
 #include <wiretap/wtap.h>
@@ -260,7 +261,7 @@ frame_data_init(frame_data *fdata, uint32_t num, const wtap_rec *rec,
   fdata->file_off = offset;
   fdata->passed_dfilter = 1;
   fdata->dependent_of_displayed = 0;
-  fdata->dependent_frames = NULL;
+  fdata->has_dependent_frames = 0;
   fdata->encoding = PACKET_CHAR_ENC_CHAR_ASCII;
   fdata->visited = 0;
   fdata->marked = 0;
@@ -399,28 +400,22 @@ frame_data_reset(frame_data *fdata)
   fdata->visited = 0;
 
   if (fdata->pfd) {
-    g_slist_free(fdata->pfd);
+    p_free_proto_data_list(fdata->pfd);
     fdata->pfd = NULL;
   }
 
-  if (fdata->dependent_frames) {
-    g_hash_table_destroy(fdata->dependent_frames);
-    fdata->dependent_frames = NULL;
-  }
+  /* The frame's old set of dependent frames, if any, is replaced when
+     it's redissected. */
+  fdata->has_dependent_frames = 0;
 }
 
 void
 frame_data_destroy(frame_data *fdata)
 {
   if (fdata->pfd) {
-    g_slist_free(fdata->pfd);
+    p_free_proto_data_list(fdata->pfd);
     fdata->pfd = NULL;
   }
-
-  if (fdata->dependent_frames) {
-    g_hash_table_destroy(fdata->dependent_frames);
-    fdata->dependent_frames = NULL;
-  }
 }
 
 /*
@@ -21,6 +21,7 @@ extern "C" {
 
 typedef struct wtap_rec wtap_rec;
 struct _packet_info;
+struct _proto_data_list;
 struct epan_session;
 
 #define PINFO_FD_VISITED(pinfo)   ((pinfo)->fd->visited)
@@ -49,15 +50,14 @@ typedef enum {
    number unknown".
 
    There is one of these structures for every frame in the capture.
-   That means a lot of memory if we have a lot of frames.
-   They are packed into power-of-2 chunks, so their size is effectively
-   rounded up to a power of 2.
-   Try to keep it close to, and less than or equal to, a power of 2.
-   "Smaller than a power of 2" is OK for ILP32 platforms.
-
-   XXX - shuffle the fields to try to keep the most commonly-accessed
-   fields within the first 16 or 32 bytes, so they all fit in a cache
-   line? */
+   That means a lot of memory if we have a lot of frames, so the set of
+   frames a frame depends on, which only reassembled frames have, isn't
+   kept here but in the frame_data_sequence holding the frame; the
+   has_dependent_frames bit says whether the frame has an entry there
+   (see frame_data_sequence_get_dependent_frames()).
+
+   The fields that are used for every frame when reading, filtering and
+   sorting come first, so they share a cache line. */
 struct _color_filter; /* Forward */
 DIAG_OFF_PEDANTIC
 typedef struct _frame_data {
@@ -66,12 +66,7 @@ typedef struct _frame_data {
   uint32_t     pkt_len;      /**< Packet length */
   uint32_t     cap_len;      /**< Amount actually captured */
   int64_t      file_off;     /**< File offset */
-  /* These two are pointers, meaning 64-bit on LP64 (64-bit UN*X) and
-     LLP64 (64-bit Windows) platforms.  Put them here, one after the
-     other, so they don't require padding between them. */
-  GSList      *pfd;          /**< Per frame proto data */
-  GHashTable  *dependent_frames;     /**< A hash table of frames which this one depends on */
-  const struct _color_filter *color_filter;  /**< Per-packet matching color_filter_t object */
+  nstime_t     abs_ts;       /**< Absolute timestamp */
   uint32_t     cum_bytes;    /**< Cumulative bytes into the capture */
   uint8_t      tcp_snd_manual_analysis;   /**< TCP SEQ Analysis Overriding, 0 = none, 1 = OOO, 2 = RET , 3 = Fast RET, 4 = Spurious RET  */
   /* Keep the bitfields below to 24 bits, so this plus the previous field
@@ -88,10 +83,15 @@ typedef struct _frame_data {
   unsigned int has_modified_block : 1; /** 1 = block for this packet has been modified */
   unsigned int need_colorize    : 1; /**< 1 = need to (re-)calculate packet color */
   unsigned int tsprec           : 4; /**< Time stamp precision -2^tsprec gives up to femtoseconds */
-  nstime_t     abs_ts;       /**< Absolute timestamp */
-  nstime_t     shift_offset; /**< How much the abs_tm of the frame is shifted */
+  unsigned int has_dependent_frames : 1; /**< 1 = frame depends on other frames, see frame_data_sequence_get_dependent_frames() */
   uint32_t     frame_ref_num; /**< Previous reference frame (0 if this is one) */
   uint32_t     prev_dis_num; /**< Previous displayed frame (0 if first one) */
+  nstime_t     shift_offset; /**< How much the abs_ts of the frame is shifted */
+  /* These two are pointers, meaning 64-bit on LP64 (64-bit UN*X) and
+     LLP64 (64-bit Windows) platforms.  Put them here, one after the
+     other, so they don't require padding between them. */
+  struct _proto_data_list *pfd;  /**< Per frame proto data */
+  const struct _color_filter *color_filter;  /**< Per-packet matching color_filter_t object */
 } frame_data;
 DIAG_ON_PEDANTIC
 
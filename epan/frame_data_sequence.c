@@ -32,6 +32,7 @@
 struct _frame_data_sequence {
   uint32_t     count;           /* Total number of frames */
   void        *ptree_root;      /* Pointer to the root node */
+  GHashTable  *dependent_frames; /* Frame number -> set of frame numbers it depends on */
 };
 
 /*
@@ -55,6 +56,7 @@ new_frame_data_sequence(void)
   fds = (frame_data_sequence *)g_malloc(sizeof *fds);
   fds->count = 0;
   fds->ptree_root = NULL;
+  fds->dependent_frames = NULL;
   return fds;
 }
 
@@ -310,10 +312,51 @@ free_frame_data_sequence(frame_data_sequence *fds)
     free_frame_data_array(fds->ptree_root, fds->count, levels, true);
   }
 
+  if (fds->dependent_frames) {
+    g_hash_table_destroy(fds->dependent_frames);
+  }
+
   /* free the header struct */
   g_free(fds);
 }
 
+/*
+ * Record that a frame depends on another frame.  Only reassembled frames
+ * depend on other frames, so rather than having a hash table pointer in
+ * every frame_data, we keep the sets for the whole capture here.
+ */
+void
+frame_data_sequence_add_dependent_frame(frame_data_sequence *fds,
+    frame_data *fdata, uint32_t frame_num)
+{
+  GHashTable *dependent_frames;
+
+  if (fds->dependent_frames == NULL) {
+    fds->dependent_frames = g_hash_table_new_full(g_direct_hash, g_direct_equal,
+                                                  NULL, (GDestroyNotify)g_hash_table_destroy);
+  }
+
+  if (fdata->has_dependent_frames) {
+    dependent_frames = (GHashTable *)g_hash_table_lookup(fds->dependent_frames, GUINT_TO_POINTER(fdata->num));
+  } else {
+    /* This replaces the set from before the frame was reset, if any */
+    dependent_frames = g_hash_table_new(g_direct_hash, g_direct_equal);
+    g_hash_table_insert(fds->dependent_frames, GUINT_TO_POINTER(fdata->num), dependent_frames);
+    fdata->has_dependent_frames = 1;
+  }
+  g_hash_table_add(dependent_frames, GUINT_TO_POINTER(frame_num));
+}
+
+GHashTable *
+frame_data_sequence_get_dependent_frames(frame_data_sequence *fds,
+    const frame_data *fdata)
+{
+  if (!fdata->has_dependent_frames || fds->dependent_frames == NULL)
+    return NULL;
+
+  return (GHashTable *)g_hash_table_lookup(fds->dependent_frames, GUINT_TO_POINTER(fdata->num));
+}
+
 void
 find_and_mark_frame_depended_upon(void *key, void *value _U_, void *user_data)
 {
@@ -328,8 +371,8 @@ find_and_mark_frame_depended_upon(void *key, void *value _U_, void *user_data)
      */
     if (!(dependent_fd->dependent_of_displayed || dependent_fd->passed_dfilter)) {
       dependent_fd->dependent_of_displayed = 1;
-      if (dependent_fd->dependent_frames) {
-        g_hash_table_foreach(dependent_fd->dependent_frames, find_and_mark_frame_depended_upon, frames);
+      if (dependent_fd->has_dependent_frames) {
+        g_hash_table_foreach(frame_data_sequence_get_dependent_frames(frames, dependent_fd), find_and_mark_frame_depended_upon, frames);
       }
     }
   }
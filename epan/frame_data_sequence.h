@@ -33,6 +33,20 @@ WS_DLL_PUBLIC frame_data *frame_data_sequence_find(frame_data_sequence *fds,
  */
 WS_DLL_PUBLIC void free_frame_data_sequence(frame_data_sequence *fds);
 
+/*
+ * Record that a frame depends on another frame, for example because data
+ * from it was reassembled into this one.
+ */
+WS_DLL_PUBLIC void frame_data_sequence_add_dependent_frame(frame_data_sequence *fds,
+    frame_data *fdata, uint32_t frame_num);
+
+/*
+ * Get the set of frame numbers a frame depends on, or NULL if it doesn't
+ * depend on any other frame.
+ */
+WS_DLL_PUBLIC GHashTable *frame_data_sequence_get_dependent_frames(frame_data_sequence *fds,
+    const frame_data *fdata);
+
 WS_DLL_PUBLIC void find_and_mark_frame_depended_upon(void *key, void *value, void *user_data);
 
 
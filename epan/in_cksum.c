@@ -13,6 +13,8 @@
 
 #include "config.h"
 
+#include <string.h>
+
 #include <glib.h>
 
 #include <epan/tvbuff.h>
@@ -28,6 +30,34 @@
 #define ADDCARRY(x)  {if ((x) > 65535) (x) -= 65535;}
 #define REDUCE {l_util.l = sum; sum = l_util.s[0] + l_util.s[1]; ADDCARRY(sum);}
 
+/*
+ * Sum len bytes, a multiple of 8, 32 bits at a time into a 64-bit
+ * accumulator, and fold the result to 16 bits.  As RFC 1071 notes, the
+ * one's complement sum can be computed in wider words ("parallel
+ * summation") and folded, and the result is the same as summing 16-bit
+ * words in host byte order.  Each addition adds less than 2^32, so the
+ * accumulator can't overflow for any length we can be handed.  The loop
+ * has no carry handling, so compilers can vectorize it.
+ */
+static inline uint32_t
+in_cksum_sum_wide(const uint8_t *p, int len)
+{
+	uint64_t sum = 0;
+	uint64_t word;
+
+	while (len >= 8) {
+		memcpy(&word, p, sizeof word);
+		sum += (uint32_t)word;
+		sum += word >> 32;
+		p += 8;
+		len -= 8;
+	}
+	sum = (sum & 0xffff) + ((sum >> 16) & 0xffff) + ((sum >> 32) & 0xffff) + (sum >> 48);
+	sum = (sum & 0xffff) + (sum >> 16);
+	sum = (sum & 0xffff) + (sum >> 16);
+	return (uint32_t)sum;
+}
+
 /*
  * Linux and Windows, at least, when performing Local Checksum Offload
  * store the one's complement sum (not inverted to its bitwise complement)
@@ -95,22 +125,14 @@ in_cksum_ret_partial(const vec_t *vec, int veclen, uint16_t *partial)
 			byte_swapped = 1;
 		}
 		/*
-		 * Unroll the loop to make overhead from
-		 * branches &c small.
+		 * Sum as much as we can 8 bytes at a time.
 		 */
-		while ((mlen -= 32) >= 0) {
-			sum += w[0]; sum += w[1]; sum += w[2]; sum += w[3];
-			sum += w[4]; sum += w[5]; sum += w[6]; sum += w[7];
-			sum += w[8]; sum += w[9]; sum += w[10]; sum += w[11];
-			sum += w[12]; sum += w[13]; sum += w[14]; sum += w[15];
-			w += 16;
-		}
-		mlen += 32;
-		while ((mlen -= 8) >= 0) {
-			sum += w[0]; sum += w[1]; sum += w[2]; sum += w[3];
-			w += 4;
+		if (mlen >= 8) {
+			REDUCE;
+			sum += in_cksum_sum_wide((const uint8_t *)w, mlen & ~7);
+			w += (mlen & ~7) / 2;
+			mlen &= 7;
 		}
-		mlen += 8;
 		if (mlen == 0 && byte_swapped == 0)
 			continue;
 		REDUCE;
@@ -23,6 +23,7 @@ static mmdb_lookup_t mmdb_not_found;
 #ifdef HAVE_MAXMINDDB
 
 #include <stdio.h>
+#include <string.h>
 #include <errno.h>
 #include <fcntl.h>
 
@@ -43,6 +44,12 @@ static mmdb_lookup_t mmdb_not_found;
 #include <wsutil/strtoi.h>
 #include <wsutil/glib-compat.h>
 
+#include "maxmind_db_reader.h"
+
+// Lookups are done in process by maxmind_db_reader.c when it can read all
+// of the databases. Otherwise they're done by a child mmdbresolve process,
+// which uses libmaxminddb.
+//
 // To do:
 // - Add RBL lookups? Along with the "is this a spammer" information that most RBL databases
 //   provide, you can also fetch AS information: https://www.team-cymru.com/IP-ASN-mapping.html
@@ -72,14 +79,23 @@ typedef struct _mmdbr_response_t {
     mmdb_lookup_t mmdb_val;
 } mmdb_response_t;
 
-static wmem_map_t *mmdb_ipv4_map;
-static wmem_map_t *mmdb_ipv6_map;
 static GAsyncQueue *mmdbr_response_q; // g_allocated mmdbr_response_t *
 static GThread *read_mmdbr_stdout_thread;
 
-// Interned strings
+// Caches of lookup results by address. The results are interned in
+// mmdb_lookup_chunk, so the pointers we return stay valid after their
+// address is evicted, and addresses in the same network share one result.
+#define MMDB_CACHE_MAX_ENTRIES 16384
+
+static mmdb_cache_t mmdb_ipv4_cache;
+static mmdb_cache_t mmdb_ipv6_cache;
+
+// Interned strings and results
 static wmem_map_t *mmdb_str_chunk;
-static wmem_map_t *mmdb_ipv6_chunk;
+static wmem_map_t *mmdb_lookup_chunk;
+
+/* Databases opened in process, or NULL if we're using mmdbresolve */
+static GPtrArray *mmdb_readers; // mmdb_reader_t *
 
 /* Child mmdbresolve process */
 static ws_pipe_t mmdbr_pipe; // Requires mutex
@@ -125,7 +141,7 @@ static void mmdb_resolve_stop(void);
 #define RES_LOCATION_ACCURACY   "location.accuracy_radius"
 #define RES_END                 "# End "
 
-// Interned strings and v6 addresses, similar to GLib's string chunks.
+// Interned strings and results, similar to GLib's string chunks.
 static const char *chunkify_string(char *key) {
     char *chunk_string = (char *) wmem_map_lookup(mmdb_str_chunk, key);
 
@@ -137,15 +153,49 @@ static const char *chunkify_string(char *key) {
     return chunk_string;
 }
 
-static const void *chunkify_v6_addr(const ws_in6_addr *addr) {
-    void *chunk_v6_bytes = (char *) wmem_map_lookup(mmdb_ipv6_chunk, addr->bytes);
+// The strings of the results we hash are interned, so we can use their
+// addresses. g_double_hash() hashes the bits of a double, so we compare
+// the bits as well: 0.0 and -0.0 are equal doubles with different hashes.
+static bool mmdb_double_bits_equal(double d1, double d2) {
+    return memcmp(&d1, &d2, sizeof(double)) == 0;
+}
+
+static unsigned mmdb_lookup_hash(const void *key) {
+    const mmdb_lookup_t *lookup = (const mmdb_lookup_t *) key;
+    unsigned hash = g_direct_hash(lookup->city);
+
+    hash = hash * 31 + g_direct_hash(lookup->country_iso);
+    hash = hash * 31 + g_direct_hash(lookup->as_org);
+    hash = hash * 31 + lookup->as_number;
+    hash = hash * 31 + g_double_hash(&lookup->latitude);
+    hash = hash * 31 + g_double_hash(&lookup->longitude);
+    return hash;
+}
+
+static gboolean mmdb_lookup_equal(const void *v1, const void *v2) {
+    const mmdb_lookup_t *lookup1 = (const mmdb_lookup_t *) v1;
+    const mmdb_lookup_t *lookup2 = (const mmdb_lookup_t *) v2;
+
+    return lookup1->found == lookup2->found &&
+        lookup1->country == lookup2->country &&
+        lookup1->country_iso == lookup2->country_iso &&
+        lookup1->city == lookup2->city &&
+        lookup1->as_number == lookup2->as_number &&
+        lookup1->as_org == lookup2->as_org &&
+        mmdb_double_bits_equal(lookup1->latitude, lookup2->latitude) &&
+        mmdb_double_bits_equal(lookup1->longitude, lookup2->longitude) &&
+        lookup1->accuracy == lookup2->accuracy;
+}
+
+static const mmdb_lookup_t *chunkify_lookup(const mmdb_lookup_t *lookup) {
+    mmdb_lookup_t *chunk_lookup = (mmdb_lookup_t *) wmem_map_lookup(mmdb_lookup_chunk, lookup);
 
-    if (!chunk_v6_bytes) {
-        chunk_v6_bytes = wmem_memdup(wmem_epan_scope(), addr->bytes, sizeof(ws_in6_addr));
-        wmem_map_insert(mmdb_ipv6_chunk, chunk_v6_bytes, chunk_v6_bytes);
+    if (!chunk_lookup) {
+        chunk_lookup = (mmdb_lookup_t *) wmem_memdup(wmem_epan_scope(), lookup, sizeof(mmdb_lookup_t));
+        wmem_map_insert(mmdb_lookup_chunk, chunk_lookup, chunk_lookup);
     }
 
-    return chunk_v6_bytes;
+    return chunk_lookup;
 }
 
 static void init_lookup(mmdb_lookup_t *lookup) {
@@ -160,6 +210,123 @@ static bool mmdbr_pipe_valid(void) {
     return pipe_valid;
 }
 
+static bool mmdb_resolve_active(void) {
+    return mmdb_readers != NULL || mmdbr_pipe_valid();
+}
+
+static const char *mmdb_country_iso_path[] = { "country", "iso_code", NULL };
+static const char *mmdb_country_path[] = { "country", "names", "en", NULL };
+static const char *mmdb_city_path[] = { "city", "names", "en", NULL };
+static const char *mmdb_as_org_path[] = { "autonomous_system_organization", NULL };
+static const char *mmdb_as_number_path[] = { "autonomous_system_number", NULL };
+static const char *mmdb_latitude_path[] = { "location", "latitude", NULL };
+static const char *mmdb_longitude_path[] = { "location", "longitude", NULL };
+static const char *mmdb_accuracy_path[] = { "location", "accuracy_radius", NULL };
+
+static bool mmdb_get_value(const mmdb_reader_t *reader, uint32_t entry, const char **path,
+        mmdb_value_type_e type, mmdb_value_t *value) {
+    return mmdb_reader_get_value(reader, entry, path, value) && value->type == type;
+}
+
+static const char *mmdb_get_string(const mmdb_reader_t *reader, uint32_t entry, const char **path) {
+    mmdb_value_t value;
+
+    if (!mmdb_get_value(reader, entry, path, MMDB_VALUE_STRING, &value) || value.u.str.len == 0) {
+        return NULL;
+    }
+
+    char *str = g_strndup(value.u.str.ptr, value.u.str.len);
+    const char *chunk_str = chunkify_string(str);
+    g_free(str);
+    return chunk_str;
+}
+
+/**
+ * Look up an address in our open databases. As with mmdbresolve, values
+ * found in later databases replace those found in earlier ones.
+ */
+static const mmdb_lookup_t *mmdb_lookup_in_process(const uint8_t *addr, unsigned addr_bits) {
+    mmdb_lookup_t lookup;
+    mmdb_value_t value;
+    const char *str;
+    uint32_t entry;
+
+    init_lookup(&lookup);
+    for (unsigned i = 0; i < mmdb_readers->len; i++) {
+        const mmdb_reader_t *reader = (const mmdb_reader_t *) g_ptr_array_index(mmdb_readers, i);
+
+        if (!mmdb_reader_lookup(reader, addr, addr_bits, &entry)) {
+            continue;
+        }
+        if ((str = mmdb_get_string(reader, entry, mmdb_country_iso_path)) != NULL) {
+            lookup.found = true;
+            lookup.country_iso = str;
+        }
+        if ((str = mmdb_get_string(reader, entry, mmdb_country_path)) != NULL) {
+            lookup.found = true;
+            lookup.country = str;
+        }
+        if ((str = mmdb_get_string(reader, entry, mmdb_city_path)) != NULL) {
+            lookup.found = true;
+            lookup.city = str;
+        }
+        if ((str = mmdb_get_string(reader, entry, mmdb_as_org_path)) != NULL) {
+            lookup.found = true;
+            lookup.as_org = str;
+        }
+        if (mmdb_get_value(reader, entry, mmdb_as_number_path, MMDB_VALUE_UINT, &value) &&
+                value.u.uint_value <= UINT32_MAX) {
+            lookup.found = true;
+            lookup.as_number = (uint32_t) value.u.uint_value;
+        }
+        if (mmdb_get_value(reader, entry, mmdb_latitude_path, MMDB_VALUE_DOUBLE, &value)) {
+            lookup.found = true;
+            lookup.latitude = value.u.double_value;
+        }
+        if (mmdb_get_value(reader, entry, mmdb_longitude_path, MMDB_VALUE_DOUBLE, &value)) {
+            lookup.found = true;
+            lookup.longitude = value.u.double_value;
+        }
+        if (mmdb_get_value(reader, entry, mmdb_accuracy_path, MMDB_VALUE_UINT, &value) &&
+                value.u.uint_value <= UINT16_MAX) {
+            lookup.found = true;
+            lookup.accuracy = (uint16_t) value.u.uint_value;
+        }
+    }
+
+    if (!lookup.found) {
+        return &mmdb_not_found;
+    }
+    return chunkify_lookup(&lookup);
+}
+
+/**
+ * Open our databases for in-process lookups. If we can't read one of them,
+ * e.g. because it has a format we don't support, we leave them all to
+ * mmdbresolve.
+ */
+static bool mmdb_open_readers(void) {
+    GPtrArray *readers = g_ptr_array_new_with_free_func((GDestroyNotify) mmdb_reader_close);
+
+    for (unsigned i = 0; i < mmdb_file_arr->len; i++) {
+        const char *path = (const char *) g_ptr_array_index(mmdb_file_arr, i);
+        char *err_msg;
+        mmdb_reader_t *reader = mmdb_reader_open(path, &err_msg);
+
+        if (!reader) {
+            ws_debug("can't read %s in process (%s), using mmdbresolve", path, err_msg);
+            g_free(err_msg);
+            g_ptr_array_free(readers, true);
+            return false;
+        }
+        ws_debug("opened %s (%s) in process", path, mmdb_reader_database_type(reader));
+        g_ptr_array_add(readers, reader);
+    }
+
+    mmdb_readers = readers;
+    return true;
+}
+
 // Writing to mmdbr_pipe.stdin_fd can block. Do so in a separate thread.
 static void *
 write_mmdbr_stdin_worker(void *data _U_) {
@@ -373,6 +540,15 @@ static void mmdb_resolve_stop(void) {
     char *request;
     mmdb_response_t *response;
 
+    if (mmdb_readers) {
+        g_ptr_array_free(mmdb_readers, true);
+        mmdb_readers = NULL;
+    }
+
+    // The databases might change before we're started again.
+    mmdb_cache_clear(&mmdb_ipv4_cache);
+    mmdb_cache_clear(&mmdb_ipv6_cache);
+
     while (mmdbr_request_q && (request = (char *) g_async_queue_try_pop(mmdbr_request_q)) != NULL) {
         g_free(request);
     }
@@ -446,7 +622,7 @@ static void mmdb_resolve_stop(void) {
 }
 
 /**
- * Start an mmdbresolve process.
+ * Open our databases, or start an mmdbresolve process if we can't.
  */
 static void mmdb_resolve_start(void) {
     if (!mmdbr_request_q) {
@@ -457,20 +633,15 @@ static void mmdb_resolve_start(void) {
         mmdbr_response_q = g_async_queue_new();
     }
 
-    if (!mmdb_ipv4_map) {
-        mmdb_ipv4_map = wmem_map_new(wmem_epan_scope(), g_direct_hash, g_direct_equal);
-    }
-
-    if (!mmdb_ipv6_map) {
-        mmdb_ipv6_map = wmem_map_new(wmem_epan_scope(), ipv6_oat_hash, ipv6_equal);
-    }
+    mmdb_cache_init(&mmdb_ipv4_cache, MMDB_CACHE_MAX_ENTRIES, sizeof(ws_in4_addr), g_int_hash, g_int_equal);
+    mmdb_cache_init(&mmdb_ipv6_cache, MMDB_CACHE_MAX_ENTRIES, sizeof(ws_in6_addr), ipv6_oat_hash, ipv6_equal);
 
     if (!mmdb_str_chunk) {
         mmdb_str_chunk = wmem_map_new(wmem_epan_scope(), wmem_str_hash, g_str_equal);
     }
 
-    if (!mmdb_ipv6_chunk) {
-        mmdb_ipv6_chunk = wmem_map_new(wmem_epan_scope(), ipv6_oat_hash, ipv6_equal);
+    if (!mmdb_lookup_chunk) {
+        mmdb_lookup_chunk = wmem_map_new(wmem_epan_scope(), mmdb_lookup_hash, mmdb_lookup_equal);
     }
 
     if (!mmdb_file_arr) {
@@ -485,6 +656,10 @@ static void mmdb_resolve_start(void) {
         return;
     }
 
+    if (mmdb_open_readers()) {
+        return;
+    }
+
     GPtrArray *args = g_ptr_array_new();
     char *mmdbresolve = get_executable_path("mmdbresolve");
     g_ptr_array_add(args, mmdbresolve);
@@ -657,11 +832,11 @@ void maxmind_db_pref_cleanup(void)
 void maxmind_db_pref_apply(void)
 {
     if (gbl_resolv_flags.maxmind_geoip) {
-        if (!mmdbr_pipe_valid()) {
+        if (!mmdb_resolve_active()) {
             mmdb_resolve_start();
         }
     } else {
-        if (mmdbr_pipe_valid()) {
+        if (mmdb_resolve_active()) {
             mmdb_resolve_stop();
         }
     }
@@ -674,7 +849,7 @@ static void maxmind_db_pop_response(mmdb_response_t *response)
         mmdb_resolve_stop();
         /* XXX: We could call mmdb_resolve_start() instead */
     } else {
-        mmdb_lookup_t *mmdb_val = (mmdb_lookup_t *) wmem_memdup(wmem_epan_scope(), &response->mmdb_val, sizeof(mmdb_lookup_t));
+        mmdb_lookup_t *mmdb_val = &response->mmdb_val;
         if (response->mmdb_val.country_iso) {
             char *country_iso = (char *) response->mmdb_val.country_iso;
             mmdb_val->country_iso = chunkify_string(country_iso);
@@ -698,9 +873,9 @@ static void maxmind_db_pop_response(mmdb_response_t *response)
         ws_debug("popped response %s city %s country %s", response->is_ipv4 ? "v4" : "v6", mmdb_val->city, mmdb_val->country);
 
         if (response->is_ipv4) {
-            wmem_map_insert(mmdb_ipv4_map, GUINT_TO_POINTER(response->ipv4_addr), mmdb_val);
+            mmdb_cache_insert(&mmdb_ipv4_cache, &response->ipv4_addr, chunkify_lookup(mmdb_val));
         } else {
-            wmem_map_insert(mmdb_ipv6_map, chunkify_v6_addr(&response->ipv6_addr), mmdb_val);
+            mmdb_cache_insert(&mmdb_ipv6_cache, &response->ipv6_addr, chunkify_lookup(mmdb_val));
         }
     }
     g_free(response);
@@ -741,11 +916,14 @@ maxmind_db_lookup_ipv4(const ws_in4_addr *addr) {
         return &mmdb_not_found;
     }
 
-    mmdb_lookup_t *result = (mmdb_lookup_t *) wmem_map_lookup(mmdb_ipv4_map, GUINT_TO_POINTER(*addr));
+    const mmdb_lookup_t *result = (const mmdb_lookup_t *) mmdb_cache_lookup(&mmdb_ipv4_cache, addr);
 
-    if (!result) {
+    if (!result && mmdb_readers) {
+        result = mmdb_lookup_in_process((const uint8_t *) addr, 32);
+        mmdb_cache_insert(&mmdb_ipv4_cache, addr, result);
+    } else if (!result) {
         result = &mmdb_not_found;
-        wmem_map_insert(mmdb_ipv4_map, GUINT_TO_POINTER(*addr), result);
+        mmdb_cache_insert(&mmdb_ipv4_cache, addr, result);
 
         if (mmdbr_pipe_valid()) {
             char addr_str[WS_INET_ADDRSTRLEN];
@@ -754,7 +932,10 @@ maxmind_db_lookup_ipv4(const ws_in4_addr *addr) {
             g_async_queue_push(mmdbr_request_q, ws_strdup_printf("%s\n", addr_str));
             if (resolve_synchronously) {
                 maxmind_db_await_response();
-                result = (mmdb_lookup_t *) wmem_map_lookup(mmdb_ipv4_map, GUINT_TO_POINTER(*addr));
+                result = (const mmdb_lookup_t *) mmdb_cache_lookup(&mmdb_ipv4_cache, addr);
+                if (!result) {
+                    result = &mmdb_not_found;
+                }
             }
         }
     }
@@ -768,11 +949,14 @@ maxmind_db_lookup_ipv6(const ws_in6_addr *addr) {
         return &mmdb_not_found;
     }
 
-    mmdb_lookup_t * result = (mmdb_lookup_t *) wmem_map_lookup(mmdb_ipv6_map, addr->bytes);
+    const mmdb_lookup_t *result = (const mmdb_lookup_t *) mmdb_cache_lookup(&mmdb_ipv6_cache, addr->bytes);
 
-    if (!result) {
+    if (!result && mmdb_readers) {
+        result = mmdb_lookup_in_process(addr->bytes, 128);
+        mmdb_cache_insert(&mmdb_ipv6_cache, addr->bytes, result);
+    } else if (!result) {
         result = &mmdb_not_found;
-        wmem_map_insert(mmdb_ipv6_map, chunkify_v6_addr(addr), result);
+        mmdb_cache_insert(&mmdb_ipv6_cache, addr->bytes, result);
 
         if (mmdbr_pipe_valid()) {
             char addr_str[WS_INET6_ADDRSTRLEN];
@@ -781,7 +965,10 @@ maxmind_db_lookup_ipv6(const ws_in6_addr *addr) {
             g_async_queue_push(mmdbr_request_q, ws_strdup_printf("%s\n", addr_str));
             if (resolve_synchronously) {
                 maxmind_db_await_response();
-                result = (mmdb_lookup_t *) wmem_map_lookup(mmdb_ipv6_map, addr->bytes);
+                result = (const mmdb_lookup_t *) mmdb_cache_lookup(&mmdb_ipv6_cache, addr->bytes);
+                if (!result) {
+                    result = &mmdb_not_found;
+                }
             }
         }
     }
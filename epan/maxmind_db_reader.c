@@ -0,0 +1,700 @@
+/* maxmind_db_reader.c
+ * In-process reader for MaxMind DB (.mmdb) files
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#define WS_LOG_DOMAIN  LOG_DOMAIN_MMDB
+
+#include <string.h>
+
+#include <glib.h>
+
+#include <wsutil/pint.h>
+#include <wsutil/wmem/wmem.h>
+#include <wsutil/ws_assert.h>
+#include <wsutil/wslog.h>
+
+#include "maxmind_db_reader.h"
+
+/* Data section types */
+#define MMDB_TYPE_EXTENDED      0
+#define MMDB_TYPE_POINTER       1
+#define MMDB_TYPE_STRING        2
+#define MMDB_TYPE_DOUBLE        3
+#define MMDB_TYPE_BYTES         4
+#define MMDB_TYPE_UINT16        5
+#define MMDB_TYPE_UINT32        6
+#define MMDB_TYPE_MAP           7
+#define MMDB_TYPE_INT32         8
+#define MMDB_TYPE_UINT64        9
+#define MMDB_TYPE_UINT128       10
+#define MMDB_TYPE_ARRAY         11
+#define MMDB_TYPE_CONTAINER     12
+#define MMDB_TYPE_END_MARKER    13
+#define MMDB_TYPE_BOOLEAN       14
+#define MMDB_TYPE_FLOAT         15
+
+/* The metadata follows the last occurrence of this marker, which must be
+ * in the last 128 KiB of the file. */
+static const uint8_t mmdb_metadata_marker[] = "\xAB\xCD\xEF" "MaxMind.com";
+#define MMDB_METADATA_MARKER_LEN    (sizeof(mmdb_metadata_marker) - 1)
+#define MMDB_METADATA_MAX_SIZE      (128 * 1024)
+
+/* Between the search tree and the data section */
+#define MMDB_DATA_SECTION_SEPARATOR 16
+
+/* Maximum nesting of maps and arrays that we skip over */
+#define MMDB_MAX_DEPTH              32
+
+typedef struct _mmdb_section_t {
+    const uint8_t *data;
+    uint32_t len;
+} mmdb_section_t;
+
+struct _mmdb_reader_t {
+    GMappedFile *mapped_file;
+    const uint8_t *tree;
+    uint32_t node_count;
+    unsigned record_size;       /* Bits per record, 24, 28 or 32 */
+    unsigned node_size;         /* Bytes per node, two records */
+    unsigned ip_version;
+    uint32_t ipv4_start_node;   /* Node for ::/96, for IPv4 lookups in IPv6 trees */
+    mmdb_section_t data;
+    char *database_type;
+};
+
+/*
+ * Read the control byte(s) of the field at *offset. On return *offset is
+ * the start of the payload. Pointers aren't followed; their target is
+ * returned in *size.
+ */
+static bool
+mmdb_read_ctrl(const mmdb_section_t *sec, uint32_t *offset, unsigned *type, uint32_t *size)
+{
+    static const uint32_t pointer_bias[] = { 0, 2048, 526336, 0 };
+    static const uint32_t size_bias[] = { 29, 285, 65821 };
+    uint32_t off = *offset;
+    uint32_t val;
+    unsigned extra;
+    uint8_t ctrl;
+
+    if (off >= sec->len) {
+        return false;
+    }
+    ctrl = sec->data[off++];
+    *type = ctrl >> 5;
+
+    if (*type == MMDB_TYPE_POINTER) {
+        unsigned ss = (ctrl >> 3) & 0x3;
+
+        extra = ss + 1;
+        if (sec->len - off < extra) {
+            return false;
+        }
+        val = (ss == 3) ? 0 : (ctrl & 0x7);
+        for (unsigned i = 0; i < extra; i++) {
+            val = (val << 8) | sec->data[off + i];
+        }
+        *size = val + pointer_bias[ss];
+        *offset = off + extra;
+        return true;
+    }
+
+    if (*type == MMDB_TYPE_EXTENDED) {
+        if (off >= sec->len) {
+            return false;
+        }
+        *type = 7 + sec->data[off++];
+        if (*type < MMDB_TYPE_INT32) {
+            return false;
+        }
+    }
+
+    *size = ctrl & 0x1f;
+    if (*size >= 29) {
+        extra = *size - 28;
+        if (sec->len - off < extra) {
+            return false;
+        }
+        val = 0;
+        for (unsigned i = 0; i < extra; i++) {
+            val = (val << 8) | sec->data[off + i];
+        }
+        *size = val + size_bias[extra - 1];
+        off += extra;
+    }
+
+    *offset = off;
+    return true;
+}
+
+/* As mmdb_read_ctrl(), but follows a pointer to the field it points to. */
+static bool
+mmdb_read_ctrl_follow(const mmdb_section_t *sec, uint32_t *offset, unsigned *type, uint32_t *size)
+{
+    if (!mmdb_read_ctrl(sec, offset, type, size)) {
+        return false;
+    }
+    if (*type == MMDB_TYPE_POINTER) {
+        *offset = *size;
+        /* Pointers to pointers aren't allowed. */
+        if (!mmdb_read_ctrl(sec, offset, type, size) || *type == MMDB_TYPE_POINTER) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Read a string, such as a map key, and advance *offset past it. */
+static bool
+mmdb_read_string(const mmdb_section_t *sec, uint32_t *offset, const char **str, uint32_t *len)
+{
+    uint32_t str_offset;
+    unsigned type;
+    uint32_t size;
+
+    if (!mmdb_read_ctrl(sec, offset, &type, &size)) {
+        return false;
+    }
+    if (type == MMDB_TYPE_POINTER) {
+        str_offset = size;
+        if (!mmdb_read_ctrl(sec, &str_offset, &type, &size)) {
+            return false;
+        }
+    } else {
+        str_offset = *offset;
+        if (type == MMDB_TYPE_STRING && size <= sec->len - str_offset) {
+            *offset += size;
+        }
+    }
+    if (type != MMDB_TYPE_STRING || size > sec->len - str_offset) {
+        return false;
+    }
+
+    *str = (const char *)sec->data + str_offset;
+    *len = size;
+    return true;
+}
+
+/* Advance *offset past the field there, including any nested fields. */
+static bool
+mmdb_skip_value(const mmdb_section_t *sec, uint32_t *offset, unsigned depth)
+{
+    unsigned type;
+    uint32_t size;
+
+    if (depth > MMDB_MAX_DEPTH || !mmdb_read_ctrl(sec, offset, &type, &size)) {
+        return false;
+    }
+
+    switch (type) {
+    case MMDB_TYPE_POINTER:
+    case MMDB_TYPE_BOOLEAN:
+        return true;
+    case MMDB_TYPE_MAP:
+        for (uint64_t i = 0; i < (uint64_t)size * 2; i++) {
+            if (!mmdb_skip_value(sec, offset, depth + 1)) {
+                return false;
+            }
+        }
+        return true;
+    case MMDB_TYPE_ARRAY:
+        for (uint32_t i = 0; i < size; i++) {
+            if (!mmdb_skip_value(sec, offset, depth + 1)) {
+                return false;
+            }
+        }
+        return true;
+    case MMDB_TYPE_STRING:
+    case MMDB_TYPE_DOUBLE:
+    case MMDB_TYPE_BYTES:
+    case MMDB_TYPE_UINT16:
+    case MMDB_TYPE_UINT32:
+    case MMDB_TYPE_INT32:
+    case MMDB_TYPE_UINT64:
+    case MMDB_TYPE_UINT128:
+    case MMDB_TYPE_FLOAT:
+        if (size > sec->len - *offset) {
+            return false;
+        }
+        *offset += size;
+        return true;
+    default:
+        return false;
+    }
+}
+
+static uint64_t
+mmdb_read_uint(const uint8_t *p, uint32_t size)
+{
+    uint64_t val = 0;
+
+    for (uint32_t i = 0; i < size; i++) {
+        val = (val << 8) | p[i];
+    }
+    return val;
+}
+
+/* Decode the payload at offset of a field with the given type and size. */
+static bool
+mmdb_decode_scalar(const mmdb_section_t *sec, uint32_t offset, unsigned type,
+        uint32_t size, mmdb_value_t *value)
+{
+    const uint8_t *p = sec->data + offset;
+    uint64_t bits;
+
+    if (type != MMDB_TYPE_BOOLEAN && size > sec->len - offset) {
+        return false;
+    }
+
+    switch (type) {
+    case MMDB_TYPE_STRING:
+        value->type = MMDB_VALUE_STRING;
+        value->u.str.ptr = (const char *)p;
+        value->u.str.len = size;
+        return true;
+    case MMDB_TYPE_UINT16:
+    case MMDB_TYPE_UINT32:
+    case MMDB_TYPE_UINT64:
+    case MMDB_TYPE_UINT128:
+        /* We can't return values over 64 bits, which only appear in
+         * uint128 fields that we don't look up. */
+        if (size > 8 || (type == MMDB_TYPE_UINT16 && size > 2) ||
+                (type == MMDB_TYPE_UINT32 && size > 4)) {
+            return false;
+        }
+        value->type = MMDB_VALUE_UINT;
+        value->u.uint_value = mmdb_read_uint(p, size);
+        return true;
+    case MMDB_TYPE_INT32:
+        if (size > 4) {
+            return false;
+        }
+        value->type = MMDB_VALUE_INT;
+        value->u.int_value = (int32_t)(uint32_t)mmdb_read_uint(p, size);
+        return true;
+    case MMDB_TYPE_DOUBLE:
+        if (size != 8) {
+            return false;
+        }
+        bits = pntoh64(p);
+        value->type = MMDB_VALUE_DOUBLE;
+        memcpy(&value->u.double_value, &bits, sizeof(double));
+        return true;
+    case MMDB_TYPE_FLOAT:
+    {
+        uint32_t float_bits;
+        float float_value;
+
+        if (size != 4) {
+            return false;
+        }
+        float_bits = pntoh32(p);
+        memcpy(&float_value, &float_bits, sizeof(float));
+        value->type = MMDB_VALUE_DOUBLE;
+        value->u.double_value = float_value;
+        return true;
+    }
+    case MMDB_TYPE_BOOLEAN:
+        if (size > 1) {
+            return false;
+        }
+        value->type = MMDB_VALUE_BOOLEAN;
+        value->u.boolean = size != 0;
+        return true;
+    default:
+        return false;
+    }
+}
+
+/* Find the map entry named key in the map whose payload starts at *offset,
+ * and leave *offset at its value. */
+static bool
+mmdb_find_key(const mmdb_section_t *sec, uint32_t *offset, uint32_t map_size, const char *key)
+{
+    size_t key_len = strlen(key);
+    const char *name;
+    uint32_t name_len;
+
+    for (uint32_t i = 0; i < map_size; i++) {
+        if (!mmdb_read_string(sec, offset, &name, &name_len)) {
+            return false;
+        }
+        if (name_len == key_len && memcmp(name, key, key_len) == 0) {
+            return true;
+        }
+        if (!mmdb_skip_value(sec, offset, 0)) {
+            return false;
+        }
+    }
+    return false;
+}
+
+static uint32_t
+mmdb_read_record(const mmdb_reader_t *reader, uint32_t node, unsigned bit)
+{
+    const uint8_t *p = reader->tree + (size_t)node * reader->node_size;
+
+    switch (reader->record_size) {
+    case 24:
+        return pntoh24(p + bit * 3);
+    case 28:
+        /* The middle byte holds the high nibble of both records. */
+        if (bit) {
+            return ((uint32_t)(p[3] & 0x0f) << 24) | pntoh24(p + 4);
+        }
+        return ((uint32_t)(p[3] & 0xf0) << 20) | pntoh24(p);
+    default:
+        return pntoh32(p + bit * 4);
+    }
+}
+
+static bool
+mmdb_parse_metadata(mmdb_reader_t *reader, const mmdb_section_t *meta, char **err_msg)
+{
+    uint32_t offset = 0;
+    uint32_t map_size;
+    unsigned type;
+    const char *key;
+    uint32_t key_len;
+    uint64_t node_count = 0;
+    uint64_t format_version = 0;
+    mmdb_value_t value;
+
+    if (!mmdb_read_ctrl_follow(meta, &offset, &type, &map_size) || type != MMDB_TYPE_MAP) {
+        goto bad_metadata;
+    }
+
+    for (uint32_t i = 0; i < map_size; i++) {
+        uint32_t value_offset;
+        uint32_t size;
+
+        if (!mmdb_read_string(meta, &offset, &key, &key_len)) {
+            goto bad_metadata;
+        }
+        value_offset = offset;
+        if (!mmdb_skip_value(meta, &offset, 0)) {
+            goto bad_metadata;
+        }
+        if (!mmdb_read_ctrl_follow(meta, &value_offset, &type, &size) ||
+                !mmdb_decode_scalar(meta, value_offset, type, size, &value)) {
+            /* Maps and arrays, such as "languages" and "description" */
+            continue;
+        }
+
+#define MMDB_KEY_IS(name) (key_len == strlen(name) && memcmp(key, name, key_len) == 0)
+        if (MMDB_KEY_IS("node_count") && value.type == MMDB_VALUE_UINT) {
+            node_count = value.u.uint_value;
+        } else if (MMDB_KEY_IS("record_size") && value.type == MMDB_VALUE_UINT) {
+            reader->record_size = (unsigned)MIN(value.u.uint_value, UINT_MAX);
+        } else if (MMDB_KEY_IS("ip_version") && value.type == MMDB_VALUE_UINT) {
+            reader->ip_version = (unsigned)MIN(value.u.uint_value, UINT_MAX);
+        } else if (MMDB_KEY_IS("binary_format_major_version") && value.type == MMDB_VALUE_UINT) {
+            format_version = value.u.uint_value;
+        } else if (MMDB_KEY_IS("database_type") && value.type == MMDB_VALUE_STRING) {
+            g_free(reader->database_type);
+            reader->database_type = g_strndup(value.u.str.ptr, value.u.str.len);
+        }
+#undef MMDB_KEY_IS
+    }
+
+    if (node_count == 0 || node_count > UINT32_MAX) {
+        goto bad_metadata;
+    }
+    if (format_version != 2) {
+        if (err_msg) {
+            *err_msg = ws_strdup_printf("unsupported format version %" PRIu64, format_version);
+        }
+        return false;
+    }
+    reader->node_count = (uint32_t)node_count;
+
+    if (reader->record_size != 24 && reader->record_size != 28 && reader->record_size != 32) {
+        if (err_msg) {
+            *err_msg = ws_strdup_printf("unsupported record size %u", reader->record_size);
+        }
+        return false;
+    }
+    if (reader->ip_version != 4 && reader->ip_version != 6) {
+        if (err_msg) {
+            *err_msg = ws_strdup_printf("unsupported IP version %u", reader->ip_version);
+        }
+        return false;
+    }
+    reader->node_size = reader->record_size / 4;
+    return true;
+
+bad_metadata:
+    if (err_msg) {
+        *err_msg = g_strdup("invalid metadata");
+    }
+    return false;
+}
+
+mmdb_reader_t *
+mmdb_reader_open(const char *path, char **err_msg)
+{
+    mmdb_reader_t *reader;
+    GError *err = NULL;
+    const uint8_t *contents;
+    size_t file_len;
+    size_t marker_pos, search_end;
+    uint64_t tree_size, data_start;
+    mmdb_section_t meta;
+
+    if (err_msg) {
+        *err_msg = NULL;
+    }
+
+    reader = g_new0(mmdb_reader_t, 1);
+    reader->mapped_file = g_mapped_file_new(path, false, &err);
+    if (!reader->mapped_file) {
+        if (err_msg) {
+            *err_msg = g_strdup(err->message);
+        }
+        g_clear_error(&err);
+        g_free(reader);
+        return NULL;
+    }
+
+    contents = (const uint8_t *)g_mapped_file_get_contents(reader->mapped_file);
+    file_len = g_mapped_file_get_length(reader->mapped_file);
+
+    /* Find the last metadata marker. */
+    marker_pos = SIZE_MAX;
+    if (contents && file_len >= MMDB_METADATA_MARKER_LEN) {
+        search_end = file_len > MMDB_METADATA_MAX_SIZE ? file_len - MMDB_METADATA_MAX_SIZE : 0;
+        for (size_t pos = file_len - MMDB_METADATA_MARKER_LEN + 1; pos-- > search_end; ) {
+            if (memcmp(contents + pos, mmdb_metadata_marker, MMDB_METADATA_MARKER_LEN) == 0) {
+                marker_pos = pos;
+                break;
+            }
+        }
+    }
+    if (marker_pos == SIZE_MAX) {
+        if (err_msg) {
+            *err_msg = g_strdup("metadata not found");
+        }
+        goto fail;
+    }
+
+    meta.data = contents + marker_pos + MMDB_METADATA_MARKER_LEN;
+    meta.len = (uint32_t)(file_len - marker_pos - MMDB_METADATA_MARKER_LEN);
+    if (!mmdb_parse_metadata(reader, &meta, err_msg)) {
+        goto fail;
+    }
+
+    tree_size = (uint64_t)reader->node_count * reader->node_size;
+    data_start = tree_size + MMDB_DATA_SECTION_SEPARATOR;
+    if (data_start > marker_pos || marker_pos - data_start > UINT32_MAX) {
+        if (err_msg) {
+            *err_msg = g_strdup("invalid search tree size");
+        }
+        goto fail;
+    }
+    reader->tree = contents;
+    reader->data.data = contents + data_start;
+    reader->data.len = (uint32_t)(marker_pos - data_start);
+
+    if (reader->ip_version == 6) {
+        uint32_t node = 0;
+
+        for (unsigned i = 0; i < 96 && node < reader->node_count; i++) {
+            node = mmdb_read_record(reader, node, 0);
+        }
+        reader->ipv4_start_node = node;
+    }
+
+    ws_debug("opened %s: %s, %u nodes, %u bit records, IPv%u", path,
+            reader->database_type, reader->node_count, reader->record_size,
+            reader->ip_version);
+    return reader;
+
+fail:
+    mmdb_reader_close(reader);
+    return NULL;
+}
+
+void
+mmdb_reader_close(mmdb_reader_t *reader)
+{
+    if (!reader) {
+        return;
+    }
+    g_mapped_file_unref(reader->mapped_file);
+    g_free(reader->database_type);
+    g_free(reader);
+}
+
+const char *
+mmdb_reader_database_type(const mmdb_reader_t *reader)
+{
+    return reader->database_type ? reader->database_type : "";
+}
+
+bool
+mmdb_reader_lookup(const mmdb_reader_t *reader, const uint8_t *addr,
+        unsigned addr_bits, uint32_t *entry)
+{
+    uint32_t node = 0;
+    uint32_t record;
+
+    if (addr_bits == 32 && reader->ip_version == 6) {
+        node = reader->ipv4_start_node;
+    } else if (addr_bits == 128 && reader->ip_version == 4) {
+        return false;
+    }
+
+    for (unsigned i = 0; i < addr_bits && node < reader->node_count; i++) {
+        node = mmdb_read_record(reader, node, (addr[i >> 3] >> (7 - (i & 7))) & 1);
+    }
+
+    /* node_count itself means "not found", smaller values mean the tree
+     * is deeper than the address, and larger ones point into the data
+     * section. */
+    if (node <= reader->node_count) {
+        return false;
+    }
+    record = node - reader->node_count;
+    if (record < MMDB_DATA_SECTION_SEPARATOR ||
+            record - MMDB_DATA_SECTION_SEPARATOR >= reader->data.len) {
+        return false;
+    }
+
+    *entry = record - MMDB_DATA_SECTION_SEPARATOR;
+    return true;
+}
+
+bool
+mmdb_reader_get_value(const mmdb_reader_t *reader, uint32_t entry,
+        const char * const *path, mmdb_value_t *value)
+{
+    const mmdb_section_t *sec = &reader->data;
+    uint32_t offset = entry;
+    unsigned type;
+    uint32_t size;
+
+    value->type = MMDB_VALUE_NONE;
+
+    if (!mmdb_read_ctrl_follow(sec, &offset, &type, &size)) {
+        return false;
+    }
+    for (unsigned i = 0; path[i]; i++) {
+        if (type != MMDB_TYPE_MAP || !mmdb_find_key(sec, &offset, size, path[i]) ||
+                !mmdb_read_ctrl_follow(sec, &offset, &type, &size)) {
+            return false;
+        }
+    }
+
+    return mmdb_decode_scalar(sec, offset, type, size, value);
+}
+
+typedef struct _mmdb_cache_entry_t {
+    union {
+        ws_in4_addr ipv4;
+        ws_in6_addr ipv6;
+    } addr;
+    const void *result;
+} mmdb_cache_entry_t;
+
+void
+mmdb_cache_init(mmdb_cache_t *cache, unsigned max_entries, size_t addr_len,
+        GHashFunc hash_func, GEqualFunc key_equal_func)
+{
+    ws_assert(max_entries > 0 && addr_len <= sizeof(ws_in6_addr));
+
+    if (!cache->table) {
+        cache->table = g_hash_table_new(hash_func, key_equal_func);
+        g_queue_init(&cache->lru);
+        cache->max_entries = max_entries;
+        cache->addr_len = addr_len;
+    }
+}
+
+void
+mmdb_cache_clear(mmdb_cache_t *cache)
+{
+    mmdb_cache_entry_t *entry;
+
+    if (!cache->table) {
+        return;
+    }
+    g_hash_table_remove_all(cache->table);
+    while ((entry = (mmdb_cache_entry_t *)g_queue_pop_head(&cache->lru)) != NULL) {
+        g_free(entry);
+    }
+}
+
+void
+mmdb_cache_free(mmdb_cache_t *cache)
+{
+    mmdb_cache_clear(cache);
+    if (cache->table) {
+        g_hash_table_destroy(cache->table);
+        cache->table = NULL;
+    }
+}
+
+const void *
+mmdb_cache_lookup(mmdb_cache_t *cache, const void *addr)
+{
+    GList *link;
+
+    if (!cache->table || (link = (GList *)g_hash_table_lookup(cache->table, addr)) == NULL) {
+        return NULL;
+    }
+    g_queue_unlink(&cache->lru, link);
+    g_queue_push_head_link(&cache->lru, link);
+    return ((mmdb_cache_entry_t *)link->data)->result;
+}
+
+void
+mmdb_cache_insert(mmdb_cache_t *cache, const void *addr, const void *result)
+{
+    mmdb_cache_entry_t *entry;
+    GList *link;
+
+    if (!cache->table) {
+        return;
+    }
+
+    link = (GList *)g_hash_table_lookup(cache->table, addr);
+    if (link) {
+        g_queue_unlink(&cache->lru, link);
+        g_queue_push_head_link(&cache->lru, link);
+        ((mmdb_cache_entry_t *)link->data)->result = result;
+        return;
+    }
+
+    if (cache->lru.length >= cache->max_entries) {
+        /* Reuse the least recently used entry. */
+        entry = (mmdb_cache_entry_t *)g_queue_pop_tail(&cache->lru);
+        g_hash_table_remove(cache->table, &entry->addr);
+    } else {
+        entry = g_new0(mmdb_cache_entry_t, 1);
+    }
+    memcpy(&entry->addr, addr, cache->addr_len);
+    entry->result = result;
+    g_queue_push_head(&cache->lru, entry);
+    g_hash_table_insert(cache->table, &entry->addr, cache->lru.head);
+}
+
+/*
+ * Editor modelines
+ *
+ * Local Variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * ex: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
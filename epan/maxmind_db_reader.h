@@ -0,0 +1,167 @@
+/** @file
+ *
+ * In-process reader for MaxMind DB (.mmdb) files
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __MAXMIND_DB_READER_H__
+#define __MAXMIND_DB_READER_H__
+
+#include <glib.h>
+
+#include <wsutil/inet_addr.h>
+#include "ws_symbol_export.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * A minimal reader for the MaxMind DB file format, described at
+ * https://maxmind.github.io/MaxMind-DB/
+ *
+ * libmaxminddb isn't GPL-2 compatible, so it can only be used by the
+ * separate mmdbresolve program. This reader lets maxmind_db.c look up
+ * addresses without a child process. The file is memory mapped and every
+ * read is checked against the bounds of its section, so a corrupt file
+ * makes lookups fail instead of crashing.
+ */
+
+typedef struct _mmdb_reader_t mmdb_reader_t;
+
+// These functions are marked with WS_DLL_PUBLIC so they can be unit-tested
+
+typedef enum {
+    MMDB_VALUE_NONE,
+    MMDB_VALUE_STRING,
+    MMDB_VALUE_UINT,        /* uint16, uint32 and uint64 */
+    MMDB_VALUE_INT,         /* int32 */
+    MMDB_VALUE_DOUBLE,      /* double and float */
+    MMDB_VALUE_BOOLEAN
+} mmdb_value_type_e;
+
+typedef struct _mmdb_value_t {
+    mmdb_value_type_e type;
+    union {
+        struct {
+            const char *ptr;    /* Not NUL terminated */
+            size_t len;
+        } str;
+        uint64_t uint_value;
+        int32_t int_value;
+        double double_value;
+        bool boolean;
+    } u;
+} mmdb_value_t;
+
+/**
+ * Map a database file and parse its metadata.
+ *
+ * @param path Path of the .mmdb file
+ * @param err_msg Set to a g_allocated error message on failure, if not NULL
+ *
+ * @return The reader, or NULL if the file couldn't be read or isn't a
+ * database we understand.
+ */
+WS_DLL_PUBLIC mmdb_reader_t *mmdb_reader_open(const char *path, char **err_msg);
+
+WS_DLL_PUBLIC void mmdb_reader_close(mmdb_reader_t *reader);
+
+/** The database type from the metadata, e.g. "GeoLite2-City". */
+WS_DLL_PUBLIC const char *mmdb_reader_database_type(const mmdb_reader_t *reader);
+
+/**
+ * Find the data record for an address.
+ *
+ * @param reader The database
+ * @param addr Address bytes in network order
+ * @param addr_bits 32 for IPv4 or 128 for IPv6
+ * @param entry Set to the offset of the record, for mmdb_reader_get_value()
+ *
+ * @return true if the database has a record for the address.
+ */
+WS_DLL_PUBLIC bool mmdb_reader_lookup(const mmdb_reader_t *reader, const uint8_t *addr,
+        unsigned addr_bits, uint32_t *entry);
+
+/**
+ * Get a value from a data record by following a path of map keys, as
+ * MMDB_aget_value() does.
+ *
+ * @param reader The database
+ * @param entry Record offset from mmdb_reader_lookup()
+ * @param path NULL terminated list of keys, e.g. { "city", "names", "en", NULL }
+ * @param value Set to the value found. Strings point into the mapped file.
+ *
+ * @return true if the value exists and has a scalar type.
+ */
+WS_DLL_PUBLIC bool mmdb_reader_get_value(const mmdb_reader_t *reader, uint32_t entry,
+        const char * const *path, mmdb_value_t *value);
+
+/*
+ * A bounded cache of lookup results by address, which evicts the least
+ * recently used address when it's full. maxmind_db.c keeps one for IPv4
+ * and one for IPv6 addresses, whether they're looked up in process or by
+ * mmdbresolve. The results aren't owned by the cache.
+ */
+typedef struct _mmdb_cache_t {
+    GHashTable *table;      /* address -> link in lru */
+    GQueue lru;             /* g_allocated entries, most recently used first */
+    unsigned max_entries;
+    size_t addr_len;        /* sizeof(ws_in4_addr) or sizeof(ws_in6_addr) */
+} mmdb_cache_t;
+
+/**
+ * Set up an empty cache. Does nothing if the cache is already set up.
+ *
+ * @param cache The cache
+ * @param max_entries Number of addresses to keep
+ * @param addr_len Size of the addresses, at most sizeof(ws_in6_addr)
+ * @param hash_func Hash function for the addresses
+ * @param key_equal_func Comparison function for the addresses
+ */
+WS_DLL_PUBLIC void mmdb_cache_init(mmdb_cache_t *cache, unsigned max_entries, size_t addr_len,
+        GHashFunc hash_func, GEqualFunc key_equal_func);
+
+/** Remove all addresses from the cache, which stays usable. */
+WS_DLL_PUBLIC void mmdb_cache_clear(mmdb_cache_t *cache);
+
+/** Free the cache's memory. It must be set up again before it's used. */
+WS_DLL_PUBLIC void mmdb_cache_free(mmdb_cache_t *cache);
+
+/**
+ * Look up an address and mark it as the most recently used one.
+ *
+ * @return The cached result, or NULL if the address isn't cached or the
+ * cache isn't set up.
+ */
+WS_DLL_PUBLIC const void *mmdb_cache_lookup(mmdb_cache_t *cache, const void *addr);
+
+/**
+ * Add or replace the result for an address, evicting the least recently
+ * used address if the cache is full.
+ */
+WS_DLL_PUBLIC void mmdb_cache_insert(mmdb_cache_t *cache, const void *addr, const void *result);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __MAXMIND_DB_READER_H__ */
+
+/*
+ * Editor modelines
+ *
+ * Local Variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * ex: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
@@ -0,0 +1,952 @@
+/* maxmind_db_reader_test.c
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+#undef G_DISABLE_ASSERT
+
+#include <stdio.h>
+#include <string.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include <wsutil/inet_addr.h>
+#include <wsutil/glib-compat.h>
+
+#include "maxmind_db_reader.h"
+
+/*
+ * We build the databases we test with, as described in
+ * https://maxmind.github.io/MaxMind-DB/, instead of shipping binary
+ * fixtures.
+ */
+
+#define TYPE_STRING     2
+#define TYPE_DOUBLE     3
+#define TYPE_BYTES      4
+#define TYPE_UINT16     5
+#define TYPE_UINT32     6
+#define TYPE_MAP        7
+#define TYPE_ARRAY      11
+#define TYPE_BOOLEAN    14
+
+static const char metadata_marker[] = "\xAB\xCD\xEF" "MaxMind.com";
+#define METADATA_MARKER_LEN (sizeof(metadata_marker) - 1)
+#define METADATA_MAX_SIZE   (128 * 1024)
+
+static const char *city_path[] = { "city", "names", "en", NULL };
+static const char *country_path[] = { "country", "names", "en", NULL };
+static const char *latitude_path[] = { "location", "latitude", NULL };
+static const char *accuracy_path[] = { "location", "accuracy_radius", NULL };
+
+static uint32_t
+put_ctrl(GByteArray *ba, unsigned type, uint32_t size)
+{
+    uint32_t offset = ba->len;
+    uint8_t buf[5];
+    unsigned len = 1;
+
+    buf[0] = (uint8_t)((type <= 7 ? type : 0) << 5);
+    if (type > 7) {
+        buf[len++] = (uint8_t)(type - 7);
+    }
+    if (size < 29) {
+        buf[0] |= size;
+    } else if (size < 285) {
+        buf[0] |= 29;
+        buf[len++] = (uint8_t)(size - 29);
+    } else if (size < 65821) {
+        buf[0] |= 30;
+        buf[len++] = (uint8_t)((size - 285) >> 8);
+        buf[len++] = (uint8_t)(size - 285);
+    } else {
+        buf[0] |= 31;
+        buf[len++] = (uint8_t)((size - 65821) >> 16);
+        buf[len++] = (uint8_t)((size - 65821) >> 8);
+        buf[len++] = (uint8_t)(size - 65821);
+    }
+    g_byte_array_append(ba, buf, len);
+    return offset;
+}
+
+static uint32_t
+put_string(GByteArray *ba, const char *str)
+{
+    uint32_t offset = put_ctrl(ba, TYPE_STRING, (uint32_t)strlen(str));
+
+    g_byte_array_append(ba, (const uint8_t *)str, (unsigned)strlen(str));
+    return offset;
+}
+
+static uint32_t
+put_uint(GByteArray *ba, unsigned type, uint64_t value)
+{
+    uint8_t buf[8];
+    unsigned len = 0;
+
+    for (uint64_t v = value; v != 0; v >>= 8) {
+        len++;
+    }
+    for (unsigned i = 0; i < len; i++) {
+        buf[i] = (uint8_t)(value >> (8 * (len - 1 - i)));
+    }
+    uint32_t offset = put_ctrl(ba, type, len);
+    g_byte_array_append(ba, buf, len);
+    return offset;
+}
+
+static uint32_t
+put_double(GByteArray *ba, double value)
+{
+    uint64_t bits;
+    uint8_t buf[8];
+
+    memcpy(&bits, &value, sizeof(bits));
+    for (unsigned i = 0; i < 8; i++) {
+        buf[i] = (uint8_t)(bits >> (8 * (7 - i)));
+    }
+    uint32_t offset = put_ctrl(ba, TYPE_DOUBLE, 8);
+    g_byte_array_append(ba, buf, 8);
+    return offset;
+}
+
+static uint32_t
+put_bytes(GByteArray *ba, uint32_t len)
+{
+    uint32_t offset = put_ctrl(ba, TYPE_BYTES, len);
+
+    g_byte_array_set_size(ba, ba->len + len);
+    memset(ba->data + ba->len - len, 0x5a, len);
+    return offset;
+}
+
+/* Use the smallest pointer encoding, or the 32 bit one if wide is set. */
+static uint32_t
+put_pointer(GByteArray *ba, uint32_t target, bool wide)
+{
+    uint32_t offset = ba->len;
+    uint8_t buf[5];
+    unsigned len;
+    uint32_t val;
+
+    if (wide) {
+        buf[0] = 0x38;
+        val = target;
+        len = 4;
+    } else if (target < 2048) {
+        buf[0] = 0x20 | (uint8_t)(target >> 8);
+        val = target;
+        len = 1;
+    } else if (target < 526336) {
+        val = target - 2048;
+        buf[0] = 0x28 | (uint8_t)(val >> 16);
+        len = 2;
+    } else {
+        val = target - 526336;
+        buf[0] = 0x30 | (uint8_t)(val >> 24);
+        len = 3;
+    }
+    for (unsigned i = 0; i < len; i++) {
+        buf[1 + i] = (uint8_t)(val >> (8 * (len - 1 - i)));
+    }
+    g_byte_array_append(ba, buf, len + 1);
+    return offset;
+}
+
+/* A record like those of the GeoLite2 City databases */
+static uint32_t
+put_city_record(GByteArray *ba, const char *country, const char *city, double latitude)
+{
+    uint32_t offset = put_ctrl(ba, TYPE_MAP, 3);
+
+    put_string(ba, "country");
+    put_ctrl(ba, TYPE_MAP, 2);
+    put_string(ba, "iso_code");
+    put_string(ba, "XX");
+    put_string(ba, "names");
+    put_ctrl(ba, TYPE_MAP, 2);
+    put_string(ba, "de");
+    put_string(ba, "-");
+    put_string(ba, "en");
+    put_string(ba, country);
+
+    put_string(ba, "city");
+    put_ctrl(ba, TYPE_MAP, 1);
+    put_string(ba, "names");
+    put_ctrl(ba, TYPE_MAP, 1);
+    put_string(ba, "en");
+    put_string(ba, city);
+
+    put_string(ba, "location");
+    put_ctrl(ba, TYPE_MAP, 3);
+    put_string(ba, "latitude");
+    put_double(ba, latitude);
+    put_string(ba, "longitude");
+    put_double(ba, -latitude);
+    put_string(ba, "accuracy_radius");
+    put_uint(ba, TYPE_UINT16, 1000);
+    return offset;
+}
+
+static void
+put_metadata(GByteArray *meta, uint32_t node_count, unsigned record_size, unsigned ip_version)
+{
+    put_ctrl(meta, TYPE_MAP, 6);
+    put_string(meta, "node_count");
+    put_uint(meta, TYPE_UINT32, node_count);
+    put_string(meta, "record_size");
+    put_uint(meta, TYPE_UINT16, record_size);
+    put_string(meta, "ip_version");
+    put_uint(meta, TYPE_UINT16, ip_version);
+    put_string(meta, "database_type");
+    put_string(meta, "Wireshark-Test");
+    put_string(meta, "languages");
+    put_ctrl(meta, TYPE_ARRAY, 1);
+    put_string(meta, "en");
+    put_string(meta, "binary_format_major_version");
+    put_uint(meta, TYPE_UINT16, 2);
+}
+
+typedef struct {
+    const char *network;    /* Address, or NULL for the end of the list */
+    unsigned prefix_len;    /* In bits of the tree, e.g. 120 for ::1.2.3.0/24 in an IPv6 tree */
+    uint32_t data_offset;
+} test_network_t;
+
+#define MAX_NODES 1024
+
+typedef struct {
+    uint32_t record[2];
+    bool is_node[2];
+    bool is_data[2];
+} test_node_t;
+
+/* Build the search tree for a list of networks. */
+static GByteArray *
+build_tree(const test_network_t *networks, unsigned record_size, unsigned ip_version, uint32_t *node_count)
+{
+    test_node_t *nodes = g_new0(test_node_t, MAX_NODES);
+    unsigned num_nodes = 1;
+    GByteArray *tree = g_byte_array_new();
+
+    for (const test_network_t *net = networks; net->network; net++) {
+        uint8_t addr[16];
+        uint32_t node = 0;
+
+        if (ip_version == 4) {
+            g_assert_true(ws_inet_pton4(net->network, (ws_in4_addr *)addr));
+        } else {
+            g_assert_true(ws_inet_pton6(net->network, (ws_in6_addr *)addr));
+        }
+        for (unsigned i = 0; i < net->prefix_len; i++) {
+            unsigned bit = (addr[i >> 3] >> (7 - (i & 7))) & 1;
+
+            if (i == net->prefix_len - 1) {
+                nodes[node].is_data[bit] = true;
+                nodes[node].record[bit] = net->data_offset;
+            } else {
+                if (!nodes[node].is_node[bit]) {
+                    g_assert_cmpuint(num_nodes, <, MAX_NODES);
+                    /* A longer prefix in a network we already have */
+                    if (nodes[node].is_data[bit]) {
+                        nodes[num_nodes].is_data[0] = nodes[num_nodes].is_data[1] = true;
+                        nodes[num_nodes].record[0] = nodes[num_nodes].record[1] = nodes[node].record[bit];
+                        nodes[node].is_data[bit] = false;
+                    }
+                    nodes[node].is_node[bit] = true;
+                    nodes[node].record[bit] = num_nodes++;
+                }
+                node = nodes[node].record[bit];
+            }
+        }
+    }
+
+    for (unsigned n = 0; n < num_nodes; n++) {
+        uint32_t rec[2];
+        uint8_t buf[8];
+
+        for (unsigned bit = 0; bit < 2; bit++) {
+            if (nodes[n].is_node[bit]) {
+                rec[bit] = nodes[n].record[bit];
+            } else if (nodes[n].is_data[bit]) {
+                rec[bit] = num_nodes + 16 + nodes[n].record[bit];
+            } else {
+                rec[bit] = num_nodes;
+            }
+        }
+        switch (record_size) {
+        case 24:
+            for (unsigned i = 0; i < 3; i++) {
+                buf[i] = (uint8_t)(rec[0] >> (8 * (2 - i)));
+                buf[3 + i] = (uint8_t)(rec[1] >> (8 * (2 - i)));
+            }
+            g_byte_array_append(tree, buf, 6);
+            break;
+        case 28:
+            for (unsigned i = 0; i < 3; i++) {
+                buf[i] = (uint8_t)(rec[0] >> (8 * (2 - i)));
+                buf[4 + i] = (uint8_t)(rec[1] >> (8 * (2 - i)));
+            }
+            buf[3] = (uint8_t)(((rec[0] >> 24) << 4) | ((rec[1] >> 24) & 0x0f));
+            g_byte_array_append(tree, buf, 7);
+            break;
+        default:
+            for (unsigned i = 0; i < 4; i++) {
+                buf[i] = (uint8_t)(rec[0] >> (8 * (3 - i)));
+                buf[4 + i] = (uint8_t)(rec[1] >> (8 * (3 - i)));
+            }
+            g_byte_array_append(tree, buf, 8);
+            break;
+        }
+    }
+
+    g_free(nodes);
+    *node_count = num_nodes;
+    return tree;
+}
+
+/* The whole file: tree, separator, data section, marker and metadata. */
+static GByteArray *
+assemble_db(const GByteArray *tree, const GByteArray *data, const GByteArray *meta)
+{
+    GByteArray *file = g_byte_array_new();
+    static const uint8_t separator[16] = { 0 };
+
+    g_byte_array_append(file, tree->data, tree->len);
+    g_byte_array_append(file, separator, sizeof(separator));
+    g_byte_array_append(file, data->data, data->len);
+    g_byte_array_append(file, (const uint8_t *)metadata_marker, METADATA_MARKER_LEN);
+    g_byte_array_append(file, meta->data, meta->len);
+    return file;
+}
+
+static GByteArray *
+build_db(const test_network_t *networks, unsigned record_size, unsigned ip_version, const GByteArray *data)
+{
+    GByteArray *meta = g_byte_array_new();
+    uint32_t node_count;
+    GByteArray *tree = build_tree(networks, record_size, ip_version, &node_count);
+
+    put_metadata(meta, node_count, record_size, ip_version);
+    GByteArray *file = assemble_db(tree, data, meta);
+    g_byte_array_free(tree, true);
+    g_byte_array_free(meta, true);
+    return file;
+}
+
+/* Write a database to a temporary file and open it. */
+static mmdb_reader_t *
+open_db(const uint8_t *contents, unsigned len, char **err_msg)
+{
+    GError *err = NULL;
+    char *path;
+    int fd = g_file_open_tmp("mmdb_test_XXXXXX.mmdb", &path, &err);
+    mmdb_reader_t *reader;
+
+    g_assert_no_error(err);
+    g_assert_cmpint(fd, >=, 0);
+    g_close(fd, NULL);
+    g_assert_true(g_file_set_contents(path, (const char *)contents, len, &err));
+    g_assert_no_error(err);
+
+    reader = mmdb_reader_open(path, err_msg);
+#ifndef _WIN32
+    /* Mapped files can't be removed on Windows. */
+    g_remove(path);
+#endif
+    g_free(path);
+    return reader;
+}
+
+static bool
+lookup(const mmdb_reader_t *reader, const char *addr_str, uint32_t *entry)
+{
+    ws_in6_addr addr6;
+    ws_in4_addr addr4;
+
+    if (ws_inet_pton4(addr_str, &addr4)) {
+        return mmdb_reader_lookup(reader, (const uint8_t *)&addr4, 32, entry);
+    }
+    g_assert_true(ws_inet_pton6(addr_str, &addr6));
+    return mmdb_reader_lookup(reader, addr6.bytes, 128, entry);
+}
+
+/* The string at path for an address, or NULL. */
+static char *
+lookup_string(const mmdb_reader_t *reader, const char *addr_str, const char **path)
+{
+    mmdb_value_t value;
+    uint32_t entry;
+
+    if (!lookup(reader, addr_str, &entry) || !mmdb_reader_get_value(reader, entry, path, &value)) {
+        return NULL;
+    }
+    g_assert_cmpint(value.type, ==, MMDB_VALUE_STRING);
+    return g_strndup(value.u.str.ptr, value.u.str.len);
+}
+
+static void
+assert_lookup_string(const mmdb_reader_t *reader, const char *addr_str, const char **path, const char *expected)
+{
+    char *str = lookup_string(reader, addr_str, path);
+
+    g_assert_cmpstr(str, ==, expected);
+    g_free(str);
+}
+
+static void
+test_record_size(const void *user_data)
+{
+    unsigned record_size = GPOINTER_TO_UINT(user_data);
+    GByteArray *data = g_byte_array_new();
+    test_network_t networks[] = {
+        { "::1.2.3.0", 120, 0 },
+        { "2001:db8::", 32, 0 },
+        { "2001:db8:1::", 48, 0 },
+        { NULL, 0, 0 }
+    };
+    mmdb_value_t value;
+    uint32_t entry;
+    char *err_msg;
+
+    networks[0].data_offset = put_city_record(data, "Germany", "Berlin", 52.5);
+    /* Records past 2^24 need the high bits of 28 and 32 bit records. */
+    if (record_size > 24) {
+        put_bytes(data, 1U << 24);
+    }
+    networks[1].data_offset = put_city_record(data, "France", "Paris", 48.9);
+    networks[2].data_offset = networks[0].data_offset;
+
+    GByteArray *file = build_db(networks, record_size, 6, data);
+    mmdb_reader_t *reader = open_db(file->data, file->len, &err_msg);
+    g_assert_null(err_msg);
+    g_assert_nonnull(reader);
+    g_assert_cmpstr(mmdb_reader_database_type(reader), ==, "Wireshark-Test");
+
+    /* IPv4 addresses are looked up in ::/96 of IPv6 trees. */
+    assert_lookup_string(reader, "1.2.3.4", city_path, "Berlin");
+    assert_lookup_string(reader, "::1.2.3.255", city_path, "Berlin");
+    assert_lookup_string(reader, "1.2.3.4", country_path, "Germany");
+    assert_lookup_string(reader, "2001:db8::1", city_path, "Paris");
+    assert_lookup_string(reader, "2001:db8:ffff::1", country_path, "France");
+    /* A longer prefix takes precedence. */
+    assert_lookup_string(reader, "2001:db8:1::1", city_path, "Berlin");
+    g_assert_false(lookup(reader, "1.2.4.1", &entry));
+    g_assert_false(lookup(reader, "2001:db9::1", &entry));
+    g_assert_false(lookup(reader, "::", &entry));
+
+    g_assert_true(lookup(reader, "2001:db8::1", &entry));
+    g_assert_true(mmdb_reader_get_value(reader, entry, latitude_path, &value));
+    g_assert_cmpint(value.type, ==, MMDB_VALUE_DOUBLE);
+    g_assert_cmpfloat(value.u.double_value, ==, 48.9);
+    g_assert_true(mmdb_reader_get_value(reader, entry, accuracy_path, &value));
+    g_assert_cmpint(value.type, ==, MMDB_VALUE_UINT);
+    g_assert_cmpuint(value.u.uint_value, ==, 1000);
+
+    /* Missing keys and paths to maps */
+    const char *missing_path[] = { "city", "names", "fr", NULL };
+    const char *map_path[] = { "city", "names", NULL };
+    g_assert_false(mmdb_reader_get_value(reader, entry, missing_path, &value));
+    g_assert_false(mmdb_reader_get_value(reader, entry, map_path, &value));
+
+    mmdb_reader_close(reader);
+    g_byte_array_free(file, true);
+    g_byte_array_free(data, true);
+}
+
+static void
+test_ipv4_tree(void)
+{
+    GByteArray *data = g_byte_array_new();
+    test_network_t networks[] = {
+        { "10.0.0.0", 8, 0 },
+        { NULL, 0, 0 }
+    };
+    uint32_t entry;
+
+    networks[0].data_offset = put_city_record(data, "Germany", "Berlin", 52.5);
+    GByteArray *file = build_db(networks, 24, 4, data);
+    mmdb_reader_t *reader = open_db(file->data, file->len, NULL);
+    g_assert_nonnull(reader);
+
+    assert_lookup_string(reader, "10.1.2.3", city_path, "Berlin");
+    g_assert_false(lookup(reader, "11.1.2.3", &entry));
+    /* IPv4 trees have no IPv6 addresses, not even ::10.1.2.3. */
+    g_assert_false(lookup(reader, "::10.1.2.3", &entry));
+
+    mmdb_reader_close(reader);
+    g_byte_array_free(file, true);
+    g_byte_array_free(data, true);
+}
+
+static void
+test_pointers(void)
+{
+    GByteArray *data = g_byte_array_new();
+    GByteArray *meta = g_byte_array_new();
+    test_network_t networks[] = {
+        { "::1.0.0.0", 104, 0 },
+        { "::2.0.0.0", 104, 0 },
+        { "::3.0.0.0", 104, 0 },
+        { NULL, 0, 0 }
+    };
+    uint32_t en_offset, germany_offset, names_offset, city_offset, city_map_offset;
+    uint32_t city_pointer_offset, record_offset, node_count;
+    mmdb_reader_t *reader;
+    char *err_msg;
+
+    /* Pointers of each size, to keys and to values. */
+    en_offset = put_string(data, "en");
+    germany_offset = put_string(data, "Germany");
+    put_bytes(data, 4096);
+    names_offset = put_ctrl(data, TYPE_MAP, 1);
+    put_pointer(data, en_offset, false);
+    put_pointer(data, germany_offset, true);
+    put_bytes(data, 600000);
+    city_offset = put_string(data, "city");
+    city_map_offset = put_ctrl(data, TYPE_MAP, 1);
+    put_string(data, "names");
+    put_ctrl(data, TYPE_MAP, 1);
+    put_pointer(data, en_offset, false);
+    put_string(data, "Berlin");
+    city_pointer_offset = put_pointer(data, city_map_offset, false);
+    g_assert_cmpuint(names_offset, >=, 2048);
+    g_assert_cmpuint(city_offset, >=, 526336);
+
+    record_offset = put_ctrl(data, TYPE_MAP, 3);
+    put_string(data, "country");
+    put_ctrl(data, TYPE_MAP, 1);
+    put_string(data, "names");
+    put_pointer(data, names_offset, false);
+    put_pointer(data, city_offset, false);
+    put_pointer(data, city_map_offset, false);
+    /* Pointers to pointers aren't allowed. */
+    put_string(data, "location");
+    put_pointer(data, city_pointer_offset, false);
+
+    /* A record, a pointer to it, and a pointer to that pointer */
+    networks[0].data_offset = record_offset;
+    networks[1].data_offset = put_pointer(data, record_offset, false);
+    networks[2].data_offset = put_pointer(data, networks[1].data_offset, false);
+    GByteArray *tree = build_tree(networks, 32, 6, &node_count);
+
+    /* The metadata can have pointers as well, relative to its start. We
+     * leave room for two pointers to the map in front of it. */
+    g_byte_array_set_size(meta, 4);
+    uint32_t type_offset = put_string(meta, "Wireshark-Pointers");
+    uint32_t node_count_offset = put_string(meta, "node_count");
+    uint32_t map_offset = put_ctrl(meta, TYPE_MAP, 5);
+    put_pointer(meta, node_count_offset, false);
+    put_uint(meta, TYPE_UINT32, node_count);
+    put_string(meta, "record_size");
+    put_uint(meta, TYPE_UINT16, 32);
+    put_string(meta, "ip_version");
+    put_uint(meta, TYPE_UINT16, 6);
+    put_string(meta, "database_type");
+    put_pointer(meta, type_offset, false);
+    put_string(meta, "binary_format_major_version");
+    put_uint(meta, TYPE_UINT16, 2);
+
+    GByteArray *prefix = g_byte_array_new();
+    put_pointer(prefix, map_offset, false);
+    put_pointer(prefix, map_offset, false);
+    memcpy(meta->data, prefix->data, 4);
+
+    GByteArray *file = assemble_db(tree, data, meta);
+    reader = open_db(file->data, file->len, &err_msg);
+    g_assert_null(err_msg);
+    g_assert_nonnull(reader);
+    g_assert_cmpstr(mmdb_reader_database_type(reader), ==, "Wireshark-Pointers");
+
+    assert_lookup_string(reader, "1.2.3.4", country_path, "Germany");
+    assert_lookup_string(reader, "1.2.3.4", city_path, "Berlin");
+    assert_lookup_string(reader, "2.2.3.4", country_path, "Germany");
+    assert_lookup_string(reader, "2.2.3.4", city_path, "Berlin");
+    assert_lookup_string(reader, "3.2.3.4", city_path, NULL);
+    assert_lookup_string(reader, "1.2.3.4", latitude_path, NULL);
+
+    mmdb_reader_close(reader);
+    g_byte_array_free(file, true);
+
+    /* A pointer to a pointer to the metadata map */
+    g_byte_array_set_size(prefix, 0);
+    put_pointer(prefix, 2, false);
+    put_pointer(prefix, map_offset, false);
+    memcpy(meta->data, prefix->data, 4);
+    file = assemble_db(tree, data, meta);
+    reader = open_db(file->data, file->len, &err_msg);
+    g_assert_null(reader);
+    g_assert_cmpstr(err_msg, ==, "invalid metadata");
+    g_free(err_msg);
+    g_byte_array_free(file, true);
+
+    g_byte_array_free(prefix, true);
+    g_byte_array_free(tree, true);
+    g_byte_array_free(meta, true);
+    g_byte_array_free(data, true);
+}
+
+/* A metadata map with one changed value */
+static void
+assert_bad_metadata(const GByteArray *tree, const GByteArray *data,
+        uint32_t node_count, unsigned record_size, unsigned ip_version,
+        unsigned format_version, const char *expected_err)
+{
+    GByteArray *meta = g_byte_array_new();
+    char *err_msg;
+
+    put_ctrl(meta, TYPE_MAP, 4);
+    put_string(meta, "node_count");
+    put_uint(meta, TYPE_UINT32, node_count);
+    put_string(meta, "record_size");
+    put_uint(meta, TYPE_UINT16, record_size);
+    put_string(meta, "ip_version");
+    put_uint(meta, TYPE_UINT16, ip_version);
+    put_string(meta, "binary_format_major_version");
+    put_uint(meta, TYPE_UINT16, format_version);
+
+    GByteArray *file = assemble_db(tree, data, meta);
+    mmdb_reader_t *reader = open_db(file->data, file->len, &err_msg);
+    g_assert_null(reader);
+    g_assert_cmpstr(err_msg, ==, expected_err);
+    g_free(err_msg);
+    g_byte_array_free(file, true);
+    g_byte_array_free(meta, true);
+}
+
+static void
+test_bad_metadata(void)
+{
+    GByteArray *data = g_byte_array_new();
+    GByteArray *meta = g_byte_array_new();
+    test_network_t networks[] = {
+        { "::1.0.0.0", 104, 0 },
+        { NULL, 0, 0 }
+    };
+    uint32_t node_count;
+    mmdb_reader_t *reader;
+    char *err_msg;
+
+    networks[0].data_offset = put_city_record(data, "Germany", "Berlin", 52.5);
+    GByteArray *tree = build_tree(networks, 24, 6, &node_count);
+
+    assert_bad_metadata(tree, data, node_count, 24, 6, 1, "unsupported format version 1");
+    assert_bad_metadata(tree, data, node_count, 20, 6, 2, "unsupported record size 20");
+    assert_bad_metadata(tree, data, node_count, 24, 5, 2, "unsupported IP version 5");
+    assert_bad_metadata(tree, data, 0, 24, 6, 2, "invalid metadata");
+    /* The tree can't be larger than the file. */
+    assert_bad_metadata(tree, data, 1000000, 24, 6, 2, "invalid search tree size");
+    assert_bad_metadata(tree, data, node_count + 1000, 32, 6, 2, "invalid search tree size");
+
+    /* No marker */
+    put_metadata(meta, node_count, 24, 6);
+    GByteArray *file = assemble_db(tree, data, meta);
+    file->data[file->len - meta->len - 1] ^= 0xff;
+    reader = open_db(file->data, file->len, &err_msg);
+    g_assert_null(reader);
+    g_assert_cmpstr(err_msg, ==, "metadata not found");
+    g_free(err_msg);
+    g_byte_array_free(file, true);
+
+    /* The marker must be in the last 128 KiB. */
+    unsigned padding = METADATA_MAX_SIZE - (unsigned)METADATA_MARKER_LEN - meta->len;
+    g_byte_array_set_size(meta, meta->len + padding);
+    memset(meta->data + meta->len - padding, 0, padding);
+    file = assemble_db(tree, data, meta);
+    reader = open_db(file->data, file->len, &err_msg);
+    g_assert_null(err_msg);
+    g_assert_nonnull(reader);
+    assert_lookup_string(reader, "1.2.3.4", city_path, "Berlin");
+    mmdb_reader_close(reader);
+    g_byte_array_free(file, true);
+
+    g_byte_array_append(meta, (const uint8_t *)"", 1);
+    file = assemble_db(tree, data, meta);
+    reader = open_db(file->data, file->len, &err_msg);
+    g_assert_null(reader);
+    g_assert_cmpstr(err_msg, ==, "metadata not found");
+    g_free(err_msg);
+    g_byte_array_free(file, true);
+
+    /* Too deeply nested metadata */
+    g_byte_array_set_size(meta, 0);
+    put_ctrl(meta, TYPE_MAP, 1);
+    put_string(meta, "description");
+    for (unsigned i = 0; i < 64; i++) {
+        put_ctrl(meta, TYPE_ARRAY, 1);
+    }
+    put_string(meta, "deep");
+    file = assemble_db(tree, data, meta);
+    reader = open_db(file->data, file->len, &err_msg);
+    g_assert_null(reader);
+    g_assert_cmpstr(err_msg, ==, "invalid metadata");
+    g_free(err_msg);
+    g_byte_array_free(file, true);
+
+    g_byte_array_free(tree, true);
+    g_byte_array_free(meta, true);
+    g_byte_array_free(data, true);
+}
+
+static void
+test_bad_data(void)
+{
+    GByteArray *data = g_byte_array_new();
+    test_network_t networks[] = {
+        { "::1.0.0.0", 104, 0 },
+        { "::2.0.0.0", 104, 0 },
+        { "::3.0.0.0", 104, 0 },
+        { "::4.0.0.0", 104, 0 },
+        { "::5.0.0.0", 104, 0 },
+        { NULL, 0, 0 }
+    };
+    uint32_t entry;
+
+    /* Nested arrays that we can skip over... */
+    networks[0].data_offset = put_ctrl(data, TYPE_MAP, 2);
+    put_string(data, "nested");
+    for (unsigned i = 0; i < 30; i++) {
+        put_ctrl(data, TYPE_ARRAY, 1);
+    }
+    put_ctrl(data, TYPE_BOOLEAN, 1);
+    put_string(data, "city");
+    put_ctrl(data, TYPE_MAP, 1);
+    put_string(data, "names");
+    put_ctrl(data, TYPE_MAP, 1);
+    put_string(data, "en");
+    put_string(data, "Berlin");
+
+    /* ...and ones that are too deep. */
+    networks[1].data_offset = put_ctrl(data, TYPE_MAP, 2);
+    put_string(data, "nested");
+    for (unsigned i = 0; i < 64; i++) {
+        put_ctrl(data, TYPE_ARRAY, 1);
+    }
+    put_ctrl(data, TYPE_BOOLEAN, 1);
+    put_string(data, "city");
+    put_ctrl(data, TYPE_MAP, 1);
+    put_string(data, "names");
+    put_ctrl(data, TYPE_MAP, 1);
+    put_string(data, "en");
+    put_string(data, "Berlin");
+
+    /* A map with more entries than the data section has room for */
+    networks[2].data_offset = put_ctrl(data, TYPE_MAP, 100000);
+    put_string(data, "country");
+    put_string(data, "Germany");
+
+    /* A record past the end of the data section */
+    networks[3].data_offset = 1000000;
+
+    /* A string longer than the rest of the data section */
+    networks[4].data_offset = put_ctrl(data, TYPE_MAP, 1);
+    put_string(data, "city");
+    put_ctrl(data, TYPE_MAP, 1);
+    put_string(data, "names");
+    put_ctrl(data, TYPE_MAP, 1);
+    put_string(data, "en");
+    put_ctrl(data, TYPE_STRING, 1000);
+    g_byte_array_append(data, (const uint8_t *)"Berlin", 6);
+
+    GByteArray *file = build_db(networks, 28, 6, data);
+    mmdb_reader_t *reader = open_db(file->data, file->len, NULL);
+    g_assert_nonnull(reader);
+
+    assert_lookup_string(reader, "1.2.3.4", city_path, "Berlin");
+    assert_lookup_string(reader, "2.2.3.4", city_path, NULL);
+    assert_lookup_string(reader, "3.2.3.4", city_path, NULL);
+    g_assert_false(lookup(reader, "4.2.3.4", &entry));
+    assert_lookup_string(reader, "5.2.3.4", city_path, NULL);
+
+    mmdb_reader_close(reader);
+    g_byte_array_free(file, true);
+    g_byte_array_free(data, true);
+}
+
+/* Truncated and damaged files must fail cleanly, which is best checked
+ * with AddressSanitizer. */
+static void
+test_damaged_files(void)
+{
+    GByteArray *data = g_byte_array_new();
+    test_network_t networks[] = {
+        { "::1.2.3.0", 120, 0 },
+        { "2001:db8::", 32, 0 },
+        { NULL, 0, 0 }
+    };
+    static const char *addrs[] = { "1.2.3.4", "2001:db8::1", "2001:db9::1" };
+    static const char **paths[] = { city_path, country_path, latitude_path, accuracy_path };
+
+    networks[0].data_offset = put_city_record(data, "Germany", "Berlin", 52.5);
+    networks[1].data_offset = put_pointer(data, networks[0].data_offset, false);
+    GByteArray *file = build_db(networks, 24, 6, data);
+
+    for (unsigned len = 0; len <= file->len; len++) {
+        for (unsigned damage = 0; damage <= 1; damage++) {
+            uint8_t *contents = (uint8_t *)g_memdup2(file->data, file->len);
+            unsigned damage_at = len;
+
+            if (damage) {
+                if (len == file->len) {
+                    g_free(contents);
+                    continue;
+                }
+                contents[damage_at] ^= 0xff;
+            }
+            mmdb_reader_t *reader = open_db(contents, damage ? file->len : len, NULL);
+
+            for (unsigned a = 0; reader && a < G_N_ELEMENTS(addrs); a++) {
+                mmdb_value_t value;
+                uint32_t entry;
+
+                if (!lookup(reader, addrs[a], &entry)) {
+                    continue;
+                }
+                for (unsigned p = 0; p < G_N_ELEMENTS(paths); p++) {
+                    mmdb_reader_get_value(reader, entry, paths[p], &value);
+                }
+            }
+            mmdb_reader_close(reader);
+            g_free(contents);
+        }
+    }
+
+    g_byte_array_free(file, true);
+    g_byte_array_free(data, true);
+}
+
+static void
+test_cache_lru(void)
+{
+    mmdb_cache_t cache = { 0 };
+    ws_in4_addr addrs[5];
+    int results[5];
+
+    for (unsigned i = 0; i < G_N_ELEMENTS(addrs); i++) {
+        addrs[i] = g_htonl(0x0a000001 + i);
+    }
+
+    /* Not set up yet */
+    g_assert_null(mmdb_cache_lookup(&cache, &addrs[0]));
+    mmdb_cache_insert(&cache, &addrs[0], &results[0]);
+    g_assert_null(mmdb_cache_lookup(&cache, &addrs[0]));
+
+    mmdb_cache_init(&cache, 3, sizeof(ws_in4_addr), g_int_hash, g_int_equal);
+    for (unsigned i = 0; i < 3; i++) {
+        mmdb_cache_insert(&cache, &addrs[i], &results[i]);
+    }
+
+    /* Using 0 makes 1 the least recently used address. */
+    g_assert_true(mmdb_cache_lookup(&cache, &addrs[0]) == &results[0]);
+    mmdb_cache_insert(&cache, &addrs[3], &results[3]);
+    g_assert_null(mmdb_cache_lookup(&cache, &addrs[1]));
+    g_assert_true(mmdb_cache_lookup(&cache, &addrs[0]) == &results[0]);
+    g_assert_true(mmdb_cache_lookup(&cache, &addrs[2]) == &results[2]);
+    g_assert_true(mmdb_cache_lookup(&cache, &addrs[3]) == &results[3]);
+    g_assert_cmpuint(g_queue_get_length(&cache.lru), ==, 3);
+    g_assert_cmpuint(g_hash_table_size(cache.table), ==, 3);
+
+    /* Replacing a result makes its address the most recently used one. */
+    mmdb_cache_insert(&cache, &addrs[0], &results[4]);
+    mmdb_cache_insert(&cache, &addrs[4], &results[4]);
+    g_assert_null(mmdb_cache_lookup(&cache, &addrs[2]));
+    g_assert_true(mmdb_cache_lookup(&cache, &addrs[0]) == &results[4]);
+    g_assert_true(mmdb_cache_lookup(&cache, &addrs[3]) == &results[3]);
+    g_assert_true(mmdb_cache_lookup(&cache, &addrs[4]) == &results[4]);
+
+    /* Setting up a cache again keeps its contents. */
+    mmdb_cache_init(&cache, 3, sizeof(ws_in4_addr), g_int_hash, g_int_equal);
+    g_assert_true(mmdb_cache_lookup(&cache, &addrs[4]) == &results[4]);
+
+    mmdb_cache_free(&cache);
+    g_assert_null(mmdb_cache_lookup(&cache, &addrs[4]));
+}
+
+static unsigned
+test_ipv6_hash(const void *key)
+{
+    const uint8_t *bytes = (const uint8_t *)key;
+    unsigned hash = 0;
+
+    for (unsigned i = 0; i < sizeof(ws_in6_addr); i++) {
+        hash = hash * 31 + bytes[i];
+    }
+    return hash;
+}
+
+static gboolean
+test_ipv6_equal(const void *v1, const void *v2)
+{
+    return memcmp(v1, v2, sizeof(ws_in6_addr)) == 0;
+}
+
+static void
+test_cache_clear(void)
+{
+    mmdb_cache_t cache = { 0 };
+    ws_in6_addr addrs[100];
+    int result;
+
+    mmdb_cache_init(&cache, 10, sizeof(ws_in6_addr), test_ipv6_hash, test_ipv6_equal);
+    for (unsigned i = 0; i < G_N_ELEMENTS(addrs); i++) {
+        char *addr_str = g_strdup_printf("2001:db8::%x", i);
+        g_assert_true(ws_inet_pton6(addr_str, &addrs[i]));
+        g_free(addr_str);
+        mmdb_cache_insert(&cache, &addrs[i], &result);
+    }
+    g_assert_cmpuint(g_queue_get_length(&cache.lru), ==, 10);
+    for (unsigned i = 0; i < G_N_ELEMENTS(addrs); i++) {
+        g_assert_true(mmdb_cache_lookup(&cache, &addrs[i]) == (i < 90 ? NULL : &result));
+    }
+
+    /* Clearing the cache leaves it usable. */
+    mmdb_cache_clear(&cache);
+    g_assert_cmpuint(g_queue_get_length(&cache.lru), ==, 0);
+    g_assert_cmpuint(g_hash_table_size(cache.table), ==, 0);
+    g_assert_null(mmdb_cache_lookup(&cache, &addrs[99]));
+    mmdb_cache_insert(&cache, &addrs[0], &result);
+    g_assert_true(mmdb_cache_lookup(&cache, &addrs[0]) == &result);
+
+    mmdb_cache_free(&cache);
+}
+
+int
+main(int argc, char **argv)
+{
+    int result;
+
+    g_test_init(&argc, &argv, NULL);
+
+    g_test_add_data_func("/maxmind_db_reader/record_size/24", GUINT_TO_POINTER(24), test_record_size);
+    g_test_add_data_func("/maxmind_db_reader/record_size/28", GUINT_TO_POINTER(28), test_record_size);
+    g_test_add_data_func("/maxmind_db_reader/record_size/32", GUINT_TO_POINTER(32), test_record_size);
+    g_test_add_func("/maxmind_db_reader/ipv4_tree",         test_ipv4_tree);
+    g_test_add_func("/maxmind_db_reader/pointers",          test_pointers);
+    g_test_add_func("/maxmind_db_reader/bad_metadata",      test_bad_metadata);
+    g_test_add_func("/maxmind_db_reader/bad_data",          test_bad_data);
+    g_test_add_func("/maxmind_db_reader/damaged_files",     test_damaged_files);
+    g_test_add_func("/maxmind_db_reader/cache/lru",         test_cache_lru);
+    g_test_add_func("/maxmind_db_reader/cache/clear",       test_cache_clear);
+
+    result = g_test_run();
+
+    return result;
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
@@ -29,6 +29,7 @@
 #include "addr_resolv.h"
 #include "tvbuff.h"
 #include "epan_dissect.h"
+#include "dfilter/dfilter.h"
 
 #include <epan/wmem_scopes.h>
 
@@ -41,6 +42,7 @@
 #include <epan/range.h>
 
 #include <wsutil/str_util.h>
+#include <wsutil/time_util.h>
 #include <wsutil/wslog.h>
 #include <wsutil/ws_assert.h>
 
@@ -121,6 +123,9 @@ struct depend_dissector_list {
 /* Maps char *dissector_name to depend_dissector_list_t */
 static GHashTable *depend_dissector_lists;
 
+/* Maps int proto_id to dissector_profile_entry_t, when profiling */
+static GHashTable *dissector_profile;
+
 /* Allow protocols to register a "cleanup" routine to be
  * run after the initial sequential run through the packets.
  * Note that the file can still be open after this; this is not
@@ -300,6 +305,10 @@ packet_cleanup(void)
 		}
 		g_array_free(postdissectors, true);
 	}
+	if (dissector_profile) {
+		g_hash_table_destroy(dissector_profile);
+		dissector_profile = NULL;
+	}
 }
 
 /*
@@ -521,17 +530,14 @@ free_data_sources(packet_info *pinfo)
 }
 
 void
-mark_frame_as_depended_upon(frame_data *fd, uint32_t frame_num)
+mark_frame_as_depended_upon(packet_info *pinfo, uint32_t frame_num)
 {
 	/* Don't mark a frame as dependent on itself */
-	if (frame_num != fd->num) {
-		/* ws_assert(frame_num < fd->num) - we assume in several other
+	if (frame_num != pinfo->num) {
+		/* ws_assert(frame_num < pinfo->num) - we assume in several other
 		 * places in the code that frames don't depend on future
 		 * frames. */
-		if (fd->dependent_frames == NULL) {
-			fd->dependent_frames = g_hash_table_new(g_direct_hash, g_direct_equal);
-		}
-		g_hash_table_add(fd->dependent_frames, GUINT_TO_POINTER(frame_num));
+		epan_add_dependent_frame(pinfo->epan, pinfo->fd, frame_num);
 	}
 }
 
@@ -576,7 +582,7 @@ dissect_record(epan_dissect_t *edt, int file_type_subtype, wtap_rec *rec,
 	}
 
 	if (cinfo != NULL)
-		col_init(cinfo, edt->session);
+		col_init(cinfo, edt->session, edt->tree);
 	edt->pi.epan = edt->session;
 	/* edt->pi.pool created in epan_dissect_init() */
 	edt->pi.current_proto = "<Missing Protocol Name>";
@@ -731,7 +737,7 @@ dissect_file(epan_dissect_t *edt, wtap_rec *rec,
 	}
 
 	if (cinfo != NULL)
-		col_init(cinfo, edt->session);
+		col_init(cinfo, edt->session, edt->tree);
 	edt->pi.epan = edt->session;
 	/* edt->pi.pool created in epan_dissect_init() */
 	edt->pi.current_proto = "<Missing Filetype Name>";
@@ -870,6 +876,292 @@ remove_last_layer(packet_info *pinfo, bool reduce_count)
 	}
 }
 
+struct depth_limit {
+	int      *proto_ids;		/* protocols referenced by the filter */
+	unsigned  num_proto_ids;
+	int       ethertype_proto_id;	/* helper that adds its caller's trailer */
+	int       caller_proto_id;	/* protocol whose dissector is running, or -1 */
+	uint64_t  skipped;		/* dissector calls skipped */
+};
+
+depth_limit_t *
+depth_limit_new(const dfilter_t *dfcode)
+{
+	const int *fields;
+	int num_fields;
+	GArray *proto_ids;
+	depth_limit_t *limit;
+
+	fields = dfilter_interesting_fields(dfcode, &num_fields);
+	if (num_fields == 0)
+		return NULL;
+
+	proto_ids = g_array_new(false, false, sizeof(int));
+	for (int i = 0; i < num_fields; i++) {
+		header_field_info *hfinfo = proto_registrar_get_nth(fields[i]);
+		int proto_id;
+		unsigned j;
+
+		/*
+		 * These are filled in by the frame dissector after all
+		 * the other dissectors have returned.
+		 */
+		if (strcmp(hfinfo->abbrev, "frame.protocols") == 0 ||
+		    g_str_has_prefix(hfinfo->abbrev, "frame.coloring_rule")) {
+			g_array_free(proto_ids, true);
+			return NULL;
+		}
+
+		proto_id = hfinfo->parent == -1 ? hfinfo->id : hfinfo->parent;
+		for (j = 0; j < proto_ids->len; j++) {
+			if (g_array_index(proto_ids, int, j) == proto_id)
+				break;
+		}
+		if (j == proto_ids->len)
+			g_array_append_val(proto_ids, proto_id);
+	}
+
+	limit = g_new0(depth_limit_t, 1);
+	limit->num_proto_ids = proto_ids->len;
+	limit->proto_ids = (int *)g_array_free(proto_ids, false);
+	limit->ethertype_proto_id = proto_get_id_by_filter_name("ethertype");
+	limit->caller_proto_id = -1;
+	return limit;
+}
+
+void
+depth_limit_free(depth_limit_t *limit)
+{
+	if (limit == NULL)
+		return;
+	g_free(limit->proto_ids);
+	g_free(limit);
+}
+
+uint64_t
+depth_limit_get_skipped(const depth_limit_t *limit)
+{
+	return limit->skipped;
+}
+
+static bool
+depth_limit_references(const depth_limit_t *limit, int proto_id)
+{
+	for (unsigned i = 0; i < limit->num_proto_ids; i++) {
+		if (limit->proto_ids[i] == proto_id)
+			return true;
+	}
+	return false;
+}
+
+/*
+ * Return true, and count the call as skipped, if a dissector for
+ * "protocol" doesn't need to be called because the display filter
+ * can't reference anything it or the dissectors it calls would add.
+ */
+static bool
+depth_limit_skip(packet_info *pinfo, protocol_t *protocol)
+{
+	depth_limit_t *limit = pinfo->depth_limit;
+	int *proto_layer_num_ptr;
+
+	/*
+	 * Handles without a protocol are often wrappers for dissectors
+	 * of other protocols, so always call them.
+	 */
+	if (protocol == NULL || pinfo->proto_layers == NULL ||
+	    depth_limit_references(limit, proto_get_id(protocol)))
+		return false;
+
+	/*
+	 * Every referenced protocol has to have been seen already, as
+	 * we can't tell which of them would turn up further down.
+	 */
+	for (unsigned i = 0; i < limit->num_proto_ids; i++) {
+		proto_layer_num_ptr = wmem_map_lookup(pinfo->proto_layers,
+		    GINT_TO_POINTER(limit->proto_ids[i]));
+		if (proto_layer_num_ptr == NULL || *proto_layer_num_ptr == 0)
+			return false;
+	}
+
+	/*
+	 * A referenced protocol can add fields according to what the
+	 * dissector it calls does: the Ethernet padding and trailer
+	 * depend on the length IP sets, and the reassembly fields of
+	 * TCP depend on what the protocol on top of it asks for. So
+	 * always call the dissectors a referenced protocol calls.
+	 */
+	if (limit->caller_proto_id != -1 &&
+	    depth_limit_references(limit, limit->caller_proto_id))
+		return false;
+
+	limit->skipped++;
+	return true;
+}
+
+/*
+ * Make "protocol" the caller of the dissectors called from now on, and
+ * return the previous caller to restore once its dissector returns. The
+ * last layer added isn't necessarily the caller: after TCP has handed
+ * one PDU to HTTP, it calls HTTP again for the next one.
+ */
+static int
+depth_limit_enter(depth_limit_t *limit, protocol_t *protocol)
+{
+	int saved_caller_proto_id = limit->caller_proto_id;
+	int proto_id;
+
+	/*
+	 * Handles without a protocol and helper protocols act for the
+	 * protocol that called them. Ethertype adds the trailer of the
+	 * protocol that called it, so look through it to that protocol.
+	 */
+	if (protocol != NULL && !proto_is_pino(protocol)) {
+		proto_id = proto_get_id(protocol);
+		if (proto_id != limit->ethertype_proto_id)
+			limit->caller_proto_id = proto_id;
+	}
+	return saved_caller_proto_id;
+}
+
+/*
+ * Dissector profiling. Each profiled call pushes a frame, so that the
+ * time spent in the dissectors it calls can be subtracted from its own.
+ */
+typedef struct dissector_profile_frame {
+	struct dissector_profile_frame *parent;
+	int       proto_id;
+	uint64_t  start_ns;
+	uint64_t  child_ns;
+} dissector_profile_frame_t;
+
+/* Number of users that enabled profiling */
+static unsigned dissector_profiling;
+static dissector_profile_frame_t *dissector_profile_current;
+
+void
+dissector_profile_enable(bool enable)
+{
+	if (enable)
+		dissector_profiling++;
+	else if (dissector_profiling > 0)
+		dissector_profiling--;
+}
+
+bool
+dissector_profile_is_enabled(void)
+{
+	return dissector_profiling > 0;
+}
+
+void
+dissector_profile_reset(void)
+{
+	if (dissector_profile)
+		g_hash_table_remove_all(dissector_profile);
+}
+
+void
+dissector_profile_foreach(dissector_profile_func func, void *user_data)
+{
+	GHashTableIter iter;
+	void *value;
+
+	if (!dissector_profile)
+		return;
+
+	g_hash_table_iter_init(&iter, dissector_profile);
+	while (g_hash_table_iter_next(&iter, NULL, &value))
+		func((const dissector_profile_entry_t *)value, user_data);
+}
+
+static void
+dissector_profile_enter(dissector_profile_frame_t *frame, int proto_id)
+{
+	frame->parent = dissector_profile_current;
+	frame->proto_id = proto_id;
+	frame->child_ns = 0;
+	dissector_profile_current = frame;
+	frame->start_ns = ws_monotonic_ns();
+}
+
+static void
+dissector_profile_leave(dissector_profile_frame_t *frame, bool heuristic, bool accepted)
+{
+	uint64_t elapsed = ws_monotonic_ns() - frame->start_ns;
+	dissector_profile_entry_t *entry;
+
+	dissector_profile_current = frame->parent;
+	if (dissector_profile_current)
+		dissector_profile_current->child_ns += elapsed;
+
+	if (!dissector_profile)
+		dissector_profile = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, g_free);
+	entry = g_hash_table_lookup(dissector_profile, GINT_TO_POINTER(frame->proto_id));
+	if (!entry) {
+		entry = g_new0(dissector_profile_entry_t, 1);
+		entry->name = proto_get_protocol_filter_name(frame->proto_id);
+		g_hash_table_insert(dissector_profile, GINT_TO_POINTER(frame->proto_id), entry);
+	}
+	entry->calls++;
+	entry->inclusive_ns += elapsed;
+	if (elapsed > entry->max_ns)
+		entry->max_ns = elapsed;
+	/* The child time can't exceed the elapsed time unless the clock
+	 * is too coarse to tell them apart. */
+	if (elapsed > frame->child_ns)
+		entry->exclusive_ns += elapsed - frame->child_ns;
+	if (heuristic) {
+		entry->heur_attempts++;
+		if (accepted)
+			entry->heur_accepts++;
+	}
+}
+
+/*
+ * File scope memory accounting. The protocol of the running dissector is
+ * set as the wmem accounting tag around each dissector call; if a dissector
+ * throws, its caller's allocations are attributed to it until the caller
+ * returns.
+ */
+static bool memory_accounting;
+
+void
+dissector_memory_accounting_enable(bool enable)
+{
+	memory_accounting = enable;
+	if (enable)
+		wmem_accounting_start(wmem_file_scope());
+	else
+		wmem_accounting_stop(wmem_file_scope());
+}
+
+bool
+dissector_memory_accounting_is_enabled(void)
+{
+	return memory_accounting;
+}
+
+typedef struct {
+	dissector_memory_func func;
+	void *user_data;
+} dissector_memory_foreach_t;
+
+static void
+dissector_memory_accounting_foreach_cb(int tag, const wmem_accounting_stats_t *stats, void *user_data)
+{
+	dissector_memory_foreach_t *info = (dissector_memory_foreach_t *)user_data;
+
+	info->func(tag < 0 ? NULL : proto_get_protocol_filter_name(tag), stats, info->user_data);
+}
+
+void
+dissector_memory_accounting_foreach(dissector_memory_func func, void *user_data)
+{
+	dissector_memory_foreach_t info = { func, user_data };
+
+	wmem_accounting_foreach(wmem_file_scope(), dissector_memory_accounting_foreach_cb, &info);
+}
 
 /* This function will return
  *   >0  this protocol was successfully dissected and this was this protocol.
@@ -928,6 +1220,94 @@ static int
 call_dissector_work_error(dissector_handle_t handle, tvbuff_t *tvb,
 			  packet_info *pinfo_arg, proto_tree *tree, void *);
 
+static int
+call_dissector_profiled(dissector_handle_t handle, tvbuff_t *tvb,
+			packet_info *pinfo, proto_tree *tree, void *data);
+
+/*
+ * Call a dissector through a handle, profiling it if enabled.
+ */
+static int
+call_dissector_dispatch(dissector_handle_t handle, tvbuff_t *tvb,
+			packet_info *pinfo, proto_tree *tree, void *data)
+{
+	if (G_UNLIKELY(dissector_profiling) && handle->protocol != NULL) {
+		return call_dissector_profiled(handle, tvb, pinfo, tree, data);
+	} else if (pinfo->flags.in_error_pkt) {
+		return call_dissector_work_error(handle, tvb, pinfo, tree, data);
+	} else {
+		/*
+		 * Just call the subdissector.
+		 */
+		return call_dissector_through_handle(handle, tvb, pinfo, tree, data);
+	}
+}
+
+/*
+ * Call a dissector through a handle, with its protocol as the caller
+ * seen by the depth limit and as the tag its file scope allocations are
+ * counted under. Exceptions thrown by the dissector are caught only to
+ * restore the previous caller and tag, as the caller may catch them and
+ * go on dissecting, and rethrown.
+ */
+static int
+call_dissector_guarded(dissector_handle_t handle, tvbuff_t *tvb,
+		       packet_info *pinfo, proto_tree *tree, void *data)
+{
+	depth_limit_t *limit = pinfo->depth_limit;
+	int saved_caller_proto_id = -1;
+	bool tagged = false;
+	int saved_tag = -1;
+	volatile int len = 0;
+
+	if (limit != NULL)
+		saved_caller_proto_id = depth_limit_enter(limit, handle->protocol);
+	if (memory_accounting && handle->protocol != NULL) {
+		saved_tag = wmem_accounting_set_tag(proto_get_id(handle->protocol));
+		tagged = true;
+	}
+	TRY {
+		len = call_dissector_dispatch(handle, tvb, pinfo, tree, data);
+	}
+	FINALLY {
+		if (tagged)
+			wmem_accounting_set_tag(saved_tag);
+		if (limit != NULL)
+			limit->caller_proto_id = saved_caller_proto_id;
+	}
+	ENDTRY;
+
+	return len;
+}
+
+/*
+ * Call a dissector through a handle, recording the call in the dissector
+ * profile. Exceptions thrown by the dissector are caught only to pop the
+ * profile frame, and rethrown.
+ */
+static int
+call_dissector_profiled(dissector_handle_t handle, tvbuff_t *tvb,
+			packet_info *pinfo, proto_tree *tree, void *data)
+{
+	dissector_profile_frame_t frame;
+	volatile int len = 0;
+
+	dissector_profile_enter(&frame, proto_get_id(handle->protocol));
+	TRY {
+		if (pinfo->flags.in_error_pkt) {
+			len = call_dissector_work_error(handle, tvb, pinfo, tree, data);
+		} else {
+			len = call_dissector_through_handle(handle, tvb, pinfo, tree, data);
+		}
+	}
+	FINALLY {
+		dissector_profile_leave(&frame, false, false);
+	}
+	ENDTRY;
+
+	return len;
+}
+
 static int
 call_dissector_work(dissector_handle_t handle, tvbuff_t *tvb, packet_info *pinfo,
 		    proto_tree *tree, bool add_proto_name, void *data)
@@ -949,6 +1329,15 @@ call_dissector_work(dissector_handle_t handle, tvbuff_t *tvb, packet_info *pinfo
 		return 0;
 	}
 
+	if (pinfo->depth_limit != NULL &&
+	    depth_limit_skip(pinfo, handle->protocol)) {
+		/*
+		 * Claim the data, so that the caller doesn't go on
+		 * to try other dissectors.
+		 */
+		return tvb_reported_length(tvb);
+	}
+
 	saved_proto = pinfo->current_proto;
 	saved_proto_layer_num = pinfo->curr_proto_layer_num;
 	saved_can_desegment = pinfo->can_desegment;
@@ -984,13 +1373,10 @@ call_dissector_work(dissector_handle_t handle, tvbuff_t *tvb, packet_info *pinfo
 		}
 	}
 
-	if (pinfo->flags.in_error_pkt) {
-		len = call_dissector_work_error(handle, tvb, pinfo, tree, data);
+	if (pinfo->depth_limit != NULL || G_UNLIKELY(memory_accounting)) {
+		len = call_dissector_guarded(handle, tvb, pinfo, tree, data);
 	} else {
-		/*
-		 * Just call the subdissector.
-		 */
-		len = call_dissector_through_handle(handle, tvb, pinfo, tree, data);
+		len = call_dissector_dispatch(handle, tvb, pinfo, tree, data);
 	}
 	consumed_none = len == 0 || (pinfo->desegment_len != saved_desegment_len && pinfo->desegment_offset == 0);
 	/* If len == 0, then the dissector didn't accept the packet.
@@ -3007,6 +3393,78 @@ heur_dissector_delete(const char *name, heur_dissector_t dissector, const int pr
 	}
 }
 
+/*
+ * Call a heuristic dissector, recording the attempt in the dissector
+ * profile.
+ */
+static int
+call_heur_dissector_profiled(heur_dtbl_entry_t *hdtbl_entry, tvbuff_t *tvb,
+			     packet_info *pinfo, proto_tree *tree, void *data)
+{
+	dissector_profile_frame_t frame;
+	volatile int len = 0;
+
+	dissector_profile_enter(&frame, proto_get_id(hdtbl_entry->protocol));
+	TRY {
+		len = (hdtbl_entry->dissector)(tvb, pinfo, tree, data);
+	}
+	FINALLY {
+		dissector_profile_leave(&frame, true, len > 0);
+	}
+	ENDTRY;
+
+	return len;
+}
+
+/*
+ * Call a heuristic dissector, profiling it if enabled.
+ */
+static int
+call_heur_dissector_dispatch(heur_dtbl_entry_t *hdtbl_entry, tvbuff_t *tvb,
+			     packet_info *pinfo, proto_tree *tree, void *data)
+{
+	if (G_UNLIKELY(dissector_profiling) && hdtbl_entry->protocol != NULL) {
+		return call_heur_dissector_profiled(hdtbl_entry, tvb, pinfo, tree, data);
+	} else {
+		return (hdtbl_entry->dissector)(tvb, pinfo, tree, data);
+	}
+}
+
+/*
+ * Call a heuristic dissector with its protocol as the caller seen by the
+ * depth limit and as the memory accounting tag, restoring both even if
+ * it throws, as call_dissector_guarded() does.
+ */
+static int
+call_heur_dissector_guarded(heur_dtbl_entry_t *hdtbl_entry, tvbuff_t *tvb,
+			    packet_info *pinfo, proto_tree *tree, void *data)
+{
+	depth_limit_t *limit = pinfo->depth_limit;
+	int saved_caller_proto_id = -1;
+	bool tagged = false;
+	int saved_tag = -1;
+	volatile int len = 0;
+
+	if (limit != NULL)
+		saved_caller_proto_id = depth_limit_enter(limit, hdtbl_entry->protocol);
+	if (memory_accounting && hdtbl_entry->protocol != NULL) {
+		saved_tag = wmem_accounting_set_tag(proto_get_id(hdtbl_entry->protocol));
+		tagged = true;
+	}
+	TRY {
+		len = call_heur_dissector_dispatch(hdtbl_entry, tvb, pinfo, tree, data);
+	}
+	FINALLY {
+		if (tagged)
+			wmem_accounting_set_tag(saved_tag);
+		if (limit != NULL)
+			limit->caller_proto_id = saved_caller_proto_id;
+	}
+	ENDTRY;
+
+	return len;
+}
+
 bool
 dissector_try_heuristic(heur_dissector_list_t sub_dissectors, tvbuff_t *tvb,
 			packet_info *pinfo, proto_tree *tree, heur_dtbl_entry_t **heur_dtbl_entry, void *data)
@@ -3063,6 +3521,11 @@ dissector_try_heuristic(heur_dissector_list_t sub_dissectors, tvbuff_t *tvb,
 			continue;
 		}
 
+		if (pinfo->depth_limit != NULL &&
+		    depth_limit_skip(pinfo, hdtbl_entry->protocol)) {
+			continue;
+		}
+
 		if (hdtbl_entry->protocol != NULL) {
 			proto_id = proto_get_id(hdtbl_entry->protocol);
 			/* do NOT change this behavior - wslua uses the protocol short name set here in order
@@ -3080,7 +3543,11 @@ dissector_try_heuristic(heur_dissector_list_t sub_dissectors, tvbuff_t *tvb,
 		pinfo->heur_list_name = hdtbl_entry->list_name;
 
 		saved_desegment_len = pinfo->desegment_len;
-		len = (hdtbl_entry->dissector)(tvb, pinfo, tree, data);
+		if (pinfo->depth_limit != NULL || G_UNLIKELY(memory_accounting)) {
+			len = call_heur_dissector_guarded(hdtbl_entry, tvb, pinfo, tree, data);
+		} else {
+			len = call_heur_dissector_dispatch(hdtbl_entry, tvb, pinfo, tree, data);
+		}
 		consumed_none = len == 0 || (pinfo->desegment_len != saved_desegment_len && pinfo->desegment_offset == 0);
 		if (hdtbl_entry->protocol != NULL &&
 			(consumed_none || (tree && saved_tree_count == tree->tree_data->count))) {
@@ -911,7 +911,7 @@ extern void free_data_sources(packet_info *pinfo);
  * if the user does a File->Save-As of only the Displayed packets and the
  * current frame passed the display filter.
  */
-WS_DLL_PUBLIC void mark_frame_as_depended_upon(frame_data *fd, uint32_t frame_num);
+WS_DLL_PUBLIC void mark_frame_as_depended_upon(packet_info *pinfo, uint32_t frame_num);
 
 /* Structure passed to the frame dissector */
 typedef struct frame_data_s
@@ -1032,6 +1032,84 @@ WS_DLL_PUBLIC bool postdissectors_want_hfids(void);
 extern void
 prime_epan_dissect_with_postdissector_wanted_hfids(epan_dissect_t *edt);
 
+/*
+ * Display filter driven depth limit. Once every protocol referenced by
+ * a display filter has been added to the layers of a packet, calls to
+ * dissectors for protocols the filter doesn't reference are skipped,
+ * unless the protocol whose dissector makes the call is referenced.
+ * Set it for a packet with epan_dissect_set_depth_limit().
+ */
+typedef struct depth_limit depth_limit_t;
+
+/*
+ * Create a depth limit for a display filter. Returns NULL if the filter
+ * references no fields or fields that are only known once the whole
+ * packet has been dissected, such as frame.protocols.
+ */
+WS_DLL_PUBLIC depth_limit_t *depth_limit_new(const struct epan_dfilter *dfcode);
+
+WS_DLL_PUBLIC void depth_limit_free(depth_limit_t *limit);
+
+/* Return the number of dissector calls skipped so far. */
+WS_DLL_PUBLIC uint64_t depth_limit_get_skipped(const depth_limit_t *limit);
+
+/*
+ * Per-protocol dissector profile. Times are in nanoseconds; the inclusive
+ * time includes the dissectors called by the protocol's dissectors, the
+ * exclusive time doesn't. Heuristic dissectors count as calls as well as
+ * attempts.
+ */
+typedef struct dissector_profile_entry {
+	const char *name;		/* protocol filter name */
+	uint64_t    calls;
+	uint64_t    inclusive_ns;
+	uint64_t    exclusive_ns;
+	uint64_t    max_ns;		/* longest inclusive time of a call */
+	uint64_t    heur_attempts;
+	uint64_t    heur_accepts;
+} dissector_profile_entry_t;
+
+typedef void (*dissector_profile_func)(const dissector_profile_entry_t *entry,
+    void *user_data);
+
+/*
+ * Start or stop profiling calls to dissectors. When stopped, the only
+ * overhead is a check of a flag per dissector call. Several users can
+ * share the profile: it is collected until each call with enable set
+ * has been matched by one without.
+ */
+WS_DLL_PUBLIC void dissector_profile_enable(bool enable);
+
+WS_DLL_PUBLIC bool dissector_profile_is_enabled(void);
+
+/* Discard the collected profile. Users sharing it should only do this
+ * while no one else has profiling enabled. */
+WS_DLL_PUBLIC void dissector_profile_reset(void);
+
+/* Call func for every protocol with at least one profiled call. */
+WS_DLL_PUBLIC void dissector_profile_foreach(dissector_profile_func func,
+    void *user_data);
+
+/*
+ * Per-protocol accounting of the memory allocated in wmem_file_scope().
+ * Allocations are attributed to the protocol whose dissector is running;
+ * see wmem_accounting_start() for what is counted.
+ */
+typedef void (*dissector_memory_func)(const char *name,
+    const wmem_accounting_stats_t *stats, void *user_data);
+
+WS_DLL_PUBLIC void dissector_memory_accounting_enable(bool enable);
+
+WS_DLL_PUBLIC bool dissector_memory_accounting_is_enabled(void);
+
+/*
+ * Call func for every protocol with allocations counted since the
+ * file scope was last freed. The name is the protocol filter name, or
+ * NULL for allocations made outside any dissector.
+ */
+WS_DLL_PUBLIC void dissector_memory_accounting_foreach(dissector_memory_func func,
+    void *user_data);
+
 /** Increment the dissection depth.
  * This should be used to limit recursion outside the tree depth checks in
  * call_dissector and dissector_try_heuristic.
@@ -149,14 +149,17 @@ typedef struct _packet_info {
   int16_t src_win_scale;        /**< Rcv.Wind.Shift src applies when sending segments; -1 unknown; -2 disabled */
   int16_t dst_win_scale;        /**< Rcv.Wind.Shift dst applies when sending segments; -1 unknown; -2 disabled */
 
-  GSList* proto_data;          /**< Per packet proto data */
+  struct _proto_data_list *proto_data; /**< Per packet proto data */
 
   GSList* frame_end_routines;
 
+  struct _tap_packet_queue *tap_queue; /**< Data queued for tap listeners, NULL if not tapping */
+
   wmem_allocator_t *pool;      /**< Memory pool scoped to the pinfo struct */
   struct epan_session *epan;
   const char *heur_list_name;    /**< name of heur list if this packet is being heuristically dissected */
   int dissection_depth;         /**< The current "depth" or layer number in the current frame */
+  struct depth_limit *depth_limit; /**< Skip dissectors the display filter doesn't need, or NULL */
 
   uint32_t stream_id;            /**< Conversation Stream ID of the highest protocol */
 } packet_info;
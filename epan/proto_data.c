@@ -10,6 +10,8 @@
 
 #include "config.h"
 
+#include <string.h>
+
 #include <glib.h>
 
 #include <epan/wmem_scopes.h>
@@ -17,82 +19,112 @@
 #include <epan/proto_data.h>
 #include <epan/proto.h>
 
-/* Protocol-specific data attached to a frame_data structure - protocol
-   index, key for multiple items with the same protocol index,
-   and opaque pointer. */
+/* Protocol-specific data attached to a frame_data or packet_info
+   structure - protocol index, key for multiple items with the same
+   protocol index, and opaque pointer. */
 typedef struct _proto_data {
   int   proto;
   uint32_t key;
   void *proto_data;
 } proto_data_t;
 
-static int
-p_compare(const void *a, const void *b)
+/* The entries are kept in an array sorted by protocol index and key, so
+   they can be found with a binary search; TCP, TLS, HTTP/2, QUIC and
+   others look up several of them for every packet on every pass.
+   Entries with the same protocol index and key are kept most recently
+   added first. */
+struct _proto_data_list {
+  unsigned     count;
+  unsigned     size;          /* Number of entries allocated */
+  proto_data_t entries[];
+};
+
+#define PROTO_DATA_LIST_MIN_SIZE 4
+
+static proto_data_list_t **
+p_get_list(wmem_allocator_t *scope, struct _packet_info* pinfo)
 {
-  const proto_data_t *ap = (const proto_data_t *)a;
-  const proto_data_t *bp = (const proto_data_t *)b;
-
-  if (ap -> proto > bp -> proto) {
-    return 1;
-  } else if (ap -> proto == bp -> proto) {
-    if (ap->key > bp->key){
-      return 1;
-    } else if (ap -> key == bp -> key) {
-      return 0;
-    }
-    return -1;
-  } else {
-    return -1;
+  if (scope == pinfo->pool) {
+    return &pinfo->proto_data;
+  } else if (scope == wmem_file_scope()) {
+    return &pinfo->fd->pfd;
   }
+
+  DISSECTOR_ASSERT(!"invalid wmem scope");
+  return NULL;
 }
 
-void
-p_add_proto_data(wmem_allocator_t *tmp_scope, struct _packet_info* pinfo, int proto, uint32_t key, void *proto_data)
+/* Index of the first entry that isn't less than (proto, key) */
+static unsigned
+p_lower_bound(const proto_data_list_t *list, int proto, uint32_t key)
 {
-  proto_data_t     *p1;
-  GSList          **proto_list;
-  wmem_allocator_t *scope;
-
-  if (tmp_scope == pinfo->pool) {
-    scope = tmp_scope;
-    proto_list = &pinfo->proto_data;
-  } else if (tmp_scope == wmem_file_scope()) {
-    scope = wmem_file_scope();
-    proto_list = &pinfo->fd->pfd;
-  } else {
-    DISSECTOR_ASSERT(!"invalid wmem scope");
+  unsigned low = 0;
+  unsigned high = list->count;
+
+  while (low < high) {
+    unsigned mid = low + (high - low) / 2;
+    const proto_data_t *pd = &list->entries[mid];
+
+    if (pd->proto < proto || (pd->proto == proto && pd->key < key)) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
   }
 
-  p1 = wmem_new(scope, proto_data_t);
+  return low;
+}
+
+static proto_data_t *
+p_find(proto_data_list_t *list, int proto, uint32_t key)
+{
+  unsigned i;
+
+  if (list == NULL) {
+    return NULL;
+  }
 
-  p1->proto = proto;
-  p1->key = key;
-  p1->proto_data = proto_data;
+  i = p_lower_bound(list, proto, key);
+  if (i < list->count && list->entries[i].proto == proto && list->entries[i].key == key) {
+    return &list->entries[i];
+  }
 
-  /* Add it to the GSLIST */
-  *proto_list = g_slist_prepend(*proto_list, p1);
+  return NULL;
 }
 
 void
-p_set_proto_data(wmem_allocator_t *scope, struct _packet_info* pinfo, int proto, uint32_t key, void *proto_data)
+p_add_proto_data(wmem_allocator_t *tmp_scope, struct _packet_info* pinfo, int proto, uint32_t key, void *proto_data)
 {
-  proto_data_t  temp;
-  GSList       *item;
+  proto_data_list_t **plist = p_get_list(tmp_scope, pinfo);
+  proto_data_list_t  *list = *plist;
+  unsigned            i;
 
-  temp.proto = proto;
-  temp.key = key;
-  temp.proto_data = NULL;
+  if (list == NULL || list->count == list->size) {
+    unsigned size = list ? list->size * 2 : PROTO_DATA_LIST_MIN_SIZE;
 
-  if (scope == pinfo->pool) {
-    item = g_slist_find_custom(pinfo->proto_data, &temp, p_compare);
-  } else if (scope == wmem_file_scope()) {
-    item = g_slist_find_custom(pinfo->fd->pfd, &temp, p_compare);
-  } else {
-    DISSECTOR_ASSERT(!"invalid wmem scope");
+    list = (proto_data_list_t *)g_realloc(list, sizeof(proto_data_list_t) + size * sizeof(proto_data_t));
+    if (*plist == NULL) {
+      list->count = 0;
+    }
+    list->size = size;
+    *plist = list;
   }
 
-  if (item) {
-    proto_data_t *pd = (proto_data_t *)item->data;
+  /* Insert it before any entries with the same protocol index and key */
+  i = p_lower_bound(list, proto, key);
+  memmove(&list->entries[i + 1], &list->entries[i], (list->count - i) * sizeof(proto_data_t));
+  list->entries[i].proto = proto;
+  list->entries[i].key = key;
+  list->entries[i].proto_data = proto_data;
+  list->count++;
+}
+
+void
+p_set_proto_data(wmem_allocator_t *scope, struct _packet_info* pinfo, int proto, uint32_t key, void *proto_data)
+{
+  proto_data_t *pd = p_find(*p_get_list(scope, pinfo), proto, key);
+
+  if (pd) {
     pd->proto_data = proto_data;
     return;
   }
@@ -103,24 +135,10 @@ p_set_proto_data(wmem_allocator_t *scope, struct _packet_info* pinfo, int proto,
 void *
 p_get_proto_data(wmem_allocator_t *scope, struct _packet_info* pinfo, int proto, uint32_t key)
 {
-  proto_data_t  temp, *p1;
-  GSList       *item;
-
-  temp.proto = proto;
-  temp.key = key;
-  temp.proto_data = NULL;
+  proto_data_t *pd = p_find(*p_get_list(scope, pinfo), proto, key);
 
-  if (scope == pinfo->pool) {
-    item = g_slist_find_custom(pinfo->proto_data, &temp, p_compare);
-  } else if (scope == wmem_file_scope()) {
-    item = g_slist_find_custom(pinfo->fd->pfd, &temp, p_compare);
-  } else {
-    DISSECTOR_ASSERT(!"invalid wmem scope");
-  }
-
-  if (item) {
-    p1 = (proto_data_t *)item->data;
-    return p1->proto_data;
+  if (pd) {
+    return pd->proto_data;
   }
 
   return NULL;
@@ -129,44 +147,42 @@ p_get_proto_data(wmem_allocator_t *scope, struct _packet_info* pinfo, int proto,
 void
 p_remove_proto_data(wmem_allocator_t *scope, struct _packet_info* pinfo, int proto, uint32_t key)
 {
-  proto_data_t  temp;
-  GSList       *item;
-  GSList      **proto_list;
+  proto_data_list_t *list = *p_get_list(scope, pinfo);
+  proto_data_t      *pd = p_find(list, proto, key);
 
-  temp.proto = proto;
-  temp.key = key;
-  temp.proto_data = NULL;
+  if (pd) {
+    unsigned i = (unsigned)(pd - list->entries);
 
-  if (scope == pinfo->pool) {
-    item = g_slist_find_custom(pinfo->proto_data, &temp, p_compare);
-    proto_list = &pinfo->proto_data;
-  } else if (scope == wmem_file_scope()) {
-    item = g_slist_find_custom(pinfo->fd->pfd, &temp, p_compare);
-    proto_list = &pinfo->fd->pfd;
-  } else {
-    DISSECTOR_ASSERT(!"invalid wmem scope");
+    list->count--;
+    memmove(&list->entries[i], &list->entries[i + 1], (list->count - i) * sizeof(proto_data_t));
   }
+}
 
-  if (item) {
-    *proto_list = g_slist_remove(*proto_list, item->data);
-  }
+unsigned
+p_get_proto_data_count(wmem_allocator_t *scope, struct _packet_info* pinfo)
+{
+  proto_data_list_t *list = *p_get_list(scope, pinfo);
+
+  return list ? list->count : 0;
 }
 
 char *
 p_get_proto_name_and_key(wmem_allocator_t *scope, struct _packet_info* pinfo, unsigned pfd_index){
-  proto_data_t  *temp;
+  proto_data_list_t *list = *p_get_list(scope, pinfo);
+  proto_data_t      *temp;
 
-  if (scope == pinfo->pool) {
-    temp = (proto_data_t *)g_slist_nth_data(pinfo->proto_data, pfd_index);
-  } else if (scope == wmem_file_scope()) {
-    temp = (proto_data_t *)g_slist_nth_data(pinfo->fd->pfd, pfd_index);
-  } else {
-    DISSECTOR_ASSERT(!"invalid wmem scope");
-  }
+  DISSECTOR_ASSERT(list != NULL && pfd_index < list->count);
+  temp = &list->entries[pfd_index];
 
   return wmem_strdup_printf(pinfo->pool, "[%s, key %u]",proto_get_protocol_name(temp->proto), temp->key);
 }
 
+void
+p_free_proto_data_list(proto_data_list_t *list)
+{
+  g_free(list);
+}
+
 #define PROTO_DEPTH_KEY 0x3c233fb5 // printf "0x%02x%02x\n" ${RANDOM} ${RANDOM}
 
 void p_set_proto_depth(struct _packet_info *pinfo, int proto, unsigned depth) {
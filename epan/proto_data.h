@@ -28,6 +28,9 @@ extern "C" {
 
 /* Allocator should be either pinfo->pool or wmem_file_scope() */
 
+/** Protocol data entries of a packet or frame, see p_add_proto_data(). */
+typedef struct _proto_data_list proto_data_list_t;
+
 /**
  * Add data associated with a protocol.
  *
@@ -86,8 +89,23 @@ WS_DLL_PUBLIC void *p_get_proto_data(wmem_allocator_t *scope, struct _packet_inf
  */
 WS_DLL_PUBLIC void p_remove_proto_data(wmem_allocator_t *scope, struct _packet_info* pinfo, int proto, uint32_t key);
 
+/**
+ * Return the number of protocol data entries.
+ *
+ * @param scope The memory scope, typically pinfo->pool or wmem_file_scope().
+ * @param pinfo This dissection's packet info.
+ * @return The number of entries, which can be passed to p_get_proto_name_and_key().
+ */
+unsigned p_get_proto_data_count(wmem_allocator_t *scope, struct _packet_info* pinfo);
+
 char *p_get_proto_name_and_key(wmem_allocator_t *scope, struct _packet_info* pinfo, unsigned pfd_index);
 
+/**
+ * Free a protocol data list. The data the entries point to isn't freed,
+ * as it belongs to the memory scope it was allocated from.
+ */
+WS_DLL_PUBLIC void p_free_proto_data_list(proto_data_list_t *list);
+
 /**
  * Initialize or update a per-protocol and per-packet check for recursion, nesting, cycling, etc.
  *
@@ -13,6 +13,8 @@
 #include "config.h"
 #define WS_LOG_DOMAIN LOG_DOMAIN_EPAN
 
+#include <string.h>
+
 #include "sequence_analysis.h"
 
 #include "addr_resolv.h"
@@ -219,7 +221,23 @@ sequence_analysis_sort_compare(const void *a, const void *b, void *user_data _U_
 void
 sequence_analysis_list_sort(seq_analysis_info_t *sainfo)
 {
+    GList *list;
+    const seq_analysis_item_t *prev = NULL;
+
     if (!sainfo) return;
+
+    /* Most taps add their items in frame order, in which case a single
+     * pass is much cheaper than sorting the list again. */
+    for (list = g_queue_peek_head_link(sainfo->items); list; list = g_list_next(list)) {
+        const seq_analysis_item_t *sai = (const seq_analysis_item_t *)list->data;
+
+        if (prev && sequence_analysis_sort_compare(prev, sai, NULL) > 0)
+            break;
+        prev = sai;
+    }
+    if (list == NULL)
+        return;
+
     g_queue_sort(sainfo->items, sequence_analysis_sort_compare, NULL);
 }
 
@@ -383,11 +401,11 @@ static void enlarge_string(GString *gstr, uint32_t length, char pad) {
 /*   NB: it does not check that p1 and p2 fit into string                   */
 /****************************************************************************/
 
-static void overwrite (GString *gstr, char *text_to_insert, uint32_t p1, uint32_t p2) {
+static void overwrite (GString *gstr, const char *text_to_insert, uint32_t p1, uint32_t p2) {
 
     glong len, ins_len;
     size_t pos;
-    char *ins_str = NULL;
+    const char *ins_end;
 
     if (p1 == p2)
         return;
@@ -401,22 +419,25 @@ static void overwrite (GString *gstr, char *text_to_insert, uint32_t p1, uint32_
         len = p2 - p1;
     }
 
+    if (text_to_insert == NULL)
+        text_to_insert = "";
+
+    /* Insert at most len characters, without copying the text first;
+     * this runs several times for each item of the dump. */
     ins_len = g_utf8_strlen(text_to_insert, -1);
     if (len > ins_len) {
         len = ins_len;
-    } else if (len < ins_len) {
-        ins_str = g_utf8_substring(text_to_insert, 0, len);
+        ins_end = text_to_insert + strlen(text_to_insert);
+    } else {
+        ins_end = g_utf8_offset_to_pointer(text_to_insert, len);
     }
 
-    if (!ins_str) ins_str = g_strdup(text_to_insert);
-
     if (pos > gstr->len)
         pos = gstr->len;
 
     g_string_erase(gstr, pos, len);
 
-    g_string_insert(gstr, pos, ins_str);
-    g_free(ins_str);
+    g_string_insert_len(gstr, pos, text_to_insert, ins_end - text_to_insert);
 }
 
 
@@ -574,7 +595,7 @@ sequence_analysis_dump_to_file(FILE  *of, seq_analysis_info_t *sainfo, unsigned
 
         /* write the frame label */
 
-        g_string_printf(tmp_str, "%s", empty_line->str);
+        g_string_assign(tmp_str, empty_line->str);
         overwrite(tmp_str, sai->frame_label,
             start_position,
             end_position
@@ -587,7 +608,7 @@ sequence_analysis_dump_to_file(FILE  *of, seq_analysis_info_t *sainfo, unsigned
         /* write the arrow and frame label*/
         fprintf(of, "%s", empty_header);
 
-        g_string_printf(tmp_str, "%s", empty_line->str);
+        g_string_assign(tmp_str, empty_line->str);
 
         g_string_truncate(tmp_str2, 0);
 
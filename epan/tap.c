@@ -24,11 +24,12 @@
 #include <glib.h>
 
 #include <epan/packet_info.h>
+#include <epan/epan_dissect.h>
 #include <epan/dfilter/dfilter.h>
 #include <epan/tap.h>
+#include <epan/wmem_scopes.h>
 #include <wsutil/wslog.h>
 
-static bool tapping_is_active=false;
 static dfilter_t *main_filter;
 
 typedef struct _tap_dissector_t {
@@ -75,9 +76,23 @@ typedef struct _tap_packet_t {
 
 #define TAP_PACKET_IS_ERROR_PACKET	0x00000001	/* packet being queued is an error packet */
 
-#define TAP_PACKET_QUEUE_LEN 5000
-static tap_packet_t tap_packet_array[TAP_PACKET_QUEUE_LEN];
-static unsigned tap_packet_index;
+/*
+ * The queue of tapped packets belongs to the packet being dissected; it is
+ * hung off the packet_info of the epan_dissect_t being run with taps and
+ * allocated from that packet's pinfo->pool, so it goes away together with
+ * the rest of the per-packet state and dissection stays reentrant.
+ *
+ * It starts small and doubles whenever it fills up, so a packet carrying
+ * lots of tappable PDUs (many DIAMETER messages in SCTP chunks, say) no
+ * longer loses data once a fixed limit is reached.
+ */
+#define TAP_PACKET_QUEUE_INITIAL_LEN 32
+
+typedef struct _tap_packet_queue {
+	tap_packet_t *packets;
+	unsigned len;
+	unsigned size;
+} tap_packet_queue_t;
 
 typedef struct _tap_listener_t {
 	struct _tap_listener_t *next;
@@ -96,6 +111,16 @@ typedef struct _tap_listener_t {
 
 static tap_listener_t *tap_listener_queue;
 
+/*
+ * Index from tap id to the listeners attached to that tap, in the same
+ * order as tap_listener_queue, so that pushing a queued packet only visits
+ * the listeners that are interested in it.  Element 0 is unused as tap ids
+ * start at 1.  It is rebuilt lazily whenever the set of listeners changes.
+ */
+static GPtrArray **tap_listener_index;
+static unsigned tap_listener_index_len;
+static bool tap_listener_index_dirty = true;
+
 static GSList *tap_plugins;
 
 #ifdef HAVE_PLUGINS
@@ -151,7 +176,7 @@ register_all_tap_listeners(tap_reg_t const *tap_reg_listeners)
 void
 tap_init(void)
 {
-	tap_packet_index=0;
+	tap_listener_index_dirty = true;
 }
 
 /* **********************************************************************
@@ -229,28 +254,27 @@ register_tap(const char *name)
 void
 tap_queue_packet(int tap_id, packet_info *pinfo, const void *tap_specific_data)
 {
+	tap_packet_queue_t *queue = pinfo->tap_queue;
 	tap_packet_t *tpt;
 
-	if(!tapping_is_active){
+	if(!queue){
 		return;
 	}
-	/*
-	 * XXX - should we allocate this with an ep_allocator,
-	 * rather than having a fixed maximum number of entries?
-	 */
-	if(tap_packet_index >= TAP_PACKET_QUEUE_LEN){
-		ws_warning("Too many taps queued");
-		return;
+
+	if(queue->len == queue->size){
+		queue->size = queue->size ? queue->size * 2 : TAP_PACKET_QUEUE_INITIAL_LEN;
+		queue->packets = (tap_packet_t *)wmem_realloc(pinfo->pool, queue->packets,
+		    queue->size * sizeof(tap_packet_t));
 	}
 
-	tpt=&tap_packet_array[tap_packet_index];
+	tpt=&queue->packets[queue->len];
 	tpt->tap_id=tap_id;
 	tpt->flags = 0;
 	if (pinfo->flags.in_error_pkt)
 		tpt->flags |= TAP_PACKET_IS_ERROR_PACKET;
 	tpt->pinfo=pinfo;
 	tpt->tap_specific_data=tap_specific_data;
-	tap_packet_index++;
+	queue->len++;
 }
 
 
@@ -261,6 +285,46 @@ tap_queue_packet(int tap_id, packet_info *pinfo, const void *tap_specific_data)
  * Functions used by file.c to drive the tap subsystem
  * ********************************************************************** */
 
+static void
+tap_listener_index_free(void)
+{
+	unsigned i;
+
+	for(i=0;i<tap_listener_index_len;i++){
+		if(tap_listener_index[i]){
+			g_ptr_array_free(tap_listener_index[i], true);
+		}
+	}
+	g_free(tap_listener_index);
+	tap_listener_index=NULL;
+	tap_listener_index_len=0;
+}
+
+static void
+tap_listener_index_build(void)
+{
+	tap_listener_t *tl;
+	unsigned tap_id;
+
+	tap_listener_index_free();
+
+	for(tl=tap_listener_queue;tl;tl=tl->next){
+		tap_id = (unsigned)tl->tap_id;
+		if(tap_id >= tap_listener_index_len){
+			tap_listener_index = g_renew(GPtrArray *, tap_listener_index, tap_id + 1);
+			memset(&tap_listener_index[tap_listener_index_len], 0,
+			    (tap_id + 1 - tap_listener_index_len) * sizeof(GPtrArray *));
+			tap_listener_index_len = tap_id + 1;
+		}
+		if(!tap_listener_index[tap_id]){
+			tap_listener_index[tap_id] = g_ptr_array_new();
+		}
+		g_ptr_array_add(tap_listener_index[tap_id], tl);
+	}
+
+	tap_listener_index_dirty = false;
+}
+
 void tap_build_interesting (epan_dissect_t *edt)
 {
 	tap_listener_t *tl;
@@ -293,21 +357,24 @@ void tap_build_interesting (epan_dissect_t *edt)
 	}
 }
 
-/* This function is used to delete/initialize the tap queue and prime an
-   epan_dissect_t with all the filters for tap listeners.
-   To free the tap queue, we just prepend the used queue to the free queue.
+/* This function is used to create the tap queue of an epan_dissect_t and
+   prime it with all the filters for tap listeners.
+   The queue lives in the packet's pinfo->pool, so it is freed along with it.
 */
 void
 tap_queue_init(epan_dissect_t *edt)
 {
 	/* nothing to do, just return */
 	if(!tap_listener_queue){
+		edt->pi.tap_queue=NULL;
 		return;
 	}
 
-	tapping_is_active=true;
+	if(tap_listener_index_dirty){
+		tap_listener_index_build();
+	}
 
-	tap_packet_index=0;
+	edt->pi.tap_queue=wmem_new0(edt->pi.pool, tap_packet_queue_t);
 
 	tap_build_interesting (edt);
 }
@@ -318,94 +385,108 @@ tap_queue_init(epan_dissect_t *edt)
 void
 tap_push_tapped_queue(epan_dissect_t *edt)
 {
+	tap_packet_queue_t *queue = edt->pi.tap_queue;
 	tap_packet_t *tp;
 	tap_listener_t *tl;
-	unsigned i;
+	GPtrArray *listeners;
+	unsigned i, j;
 
 	/* nothing to do, just return */
-	if(!tapping_is_active){
+	if(!queue){
 		return;
 	}
 
-	tapping_is_active=false;
+	edt->pi.tap_queue=NULL;
 
 	/* nothing to do, just return */
-	if(!tap_packet_index){
+	if(!queue->len){
 		return;
 	}
 
-	/* loop over all tap listeners and call the listener callback
-	   for all packets that match the filter. */
-	for(i=0;i<tap_packet_index;i++){
-		for(tl=tap_listener_queue;tl;tl=tl->next){
-			tp=&tap_packet_array[i];
+	/* A listener may have come or gone while the packet was dissected. */
+	if(tap_listener_index_dirty){
+		tap_listener_index_build();
+	}
+
+	/* loop over all queued packets and call the callback of every
+	   listener attached to that tap for the ones that match the filter. */
+	for(i=0;i<queue->len;i++){
+		tp=&queue->packets[i];
+		if((unsigned)tp->tap_id >= tap_listener_index_len){
+			continue;
+		}
+		listeners=tap_listener_index[tp->tap_id];
+		if(!listeners){
+			continue;
+		}
+		for(j=0;j<listeners->len;j++){
+			tl=(tap_listener_t *)g_ptr_array_index(listeners, j);
 			/* Don't tap the packet if it's an "error packet"
 			 * unless the listener has requested that we do so.
 			 */
-			if (!(tp->flags & TAP_PACKET_IS_ERROR_PACKET) || (tl->flags & TL_REQUIRES_ERROR_PACKETS))
+			if ((tp->flags & TAP_PACKET_IS_ERROR_PACKET) && !(tl->flags & TL_REQUIRES_ERROR_PACKETS))
 			{
-				if(tp->tap_id==tl->tap_id){
-					if(!tl->packet){
-						/* There isn't a per-packet
-						 * routine for this tap.
-						 */
+				continue;
+			}
+			if(!tl->packet){
+				/* There isn't a per-packet
+				 * routine for this tap.
+				 */
+				continue;
+			}
+			if(tl->failed){
+				/* A previous call failed,
+				 * meaning "stop running this
+				 * tap", so don't call the
+				 * packet routine.
+				 */
+				continue;
+			}
+
+			/* If we have a filter, see if the
+			 * packet passes.
+			 */
+			unsigned flags = tl->flags;
+			if((tl->flags & TL_LIMIT_TO_DISPLAY_FILTER) && main_filter) {
+
+				if (!dfilter_apply_edt(main_filter, edt)){
+					/* The packet didn't
+					 * pass the filter. */
+					if (tl->flags & TL_IGNORE_DISPLAY_FILTER)
+						flags |= TL_DISPLAY_FILTER_IGNORED;
+					else
 						continue;
-					}
-					if(tl->failed){
-						/* A previous call failed,
-						 * meaning "stop running this
-						 * tap", so don't call the
-						 * packet routine.
-						 */
+				}
+			}
+			if(tl->code){
+				if (!dfilter_apply_edt(tl->code, edt)){
+					/* The packet didn't
+					 * pass the filter. */
+					if (tl->flags & TL_IGNORE_DISPLAY_FILTER)
+						flags |= TL_DISPLAY_FILTER_IGNORED;
+					else
 						continue;
-					}
-
-					/* If we have a filter, see if the
-					 * packet passes.
-					 */
-					unsigned flags = tl->flags;
-					if((tl->flags & TL_LIMIT_TO_DISPLAY_FILTER) && main_filter) {
-
-						if (!dfilter_apply_edt(main_filter, edt)){
-							/* The packet didn't
-							 * pass the filter. */
-							if (tl->flags & TL_IGNORE_DISPLAY_FILTER)
-								flags |= TL_DISPLAY_FILTER_IGNORED;
-							else
-								continue;
-						}
-					}
-					if(tl->code){
-						if (!dfilter_apply_edt(tl->code, edt)){
-							/* The packet didn't
-							 * pass the filter. */
-							if (tl->flags & TL_IGNORE_DISPLAY_FILTER)
-								flags |= TL_DISPLAY_FILTER_IGNORED;
-							else
-								continue;
-						}
-					}
-
-					/* So call the per-packet routine. */
-					tap_packet_status status;
-
-					status = tl->packet(tl->tapdata, tp->pinfo, edt, tp->tap_specific_data, flags);
-
-					switch (status) {
-
-					case TAP_PACKET_DONT_REDRAW:
-						break;
-
-					case TAP_PACKET_REDRAW:
-						tl->needs_redraw=true;
-						break;
-
-					case TAP_PACKET_FAILED:
-						tl->failed=true;
-						break;
-					}
 				}
 			}
+
+			/* So call the per-packet routine. */
+			tap_packet_status status;
+
+			status = tl->packet(tl->tapdata, tp->pinfo, edt, tp->tap_specific_data, flags);
+
+			switch (status) {
+
+			case TAP_PACKET_DONT_REDRAW:
+				break;
+
+			case TAP_PACKET_REDRAW:
+				tl->needs_redraw=true;
+				break;
+
+			case TAP_PACKET_FAILED:
+				tl->failed=true;
+				break;
+			}
 		}
 	}
 }
@@ -426,24 +507,20 @@ tap_push_tapped_queue(epan_dissect_t *edt)
  * the tap listener.
  */
 const void *
-fetch_tapped_data(int tap_id, int idx)
+fetch_tapped_data(packet_info *pinfo, int tap_id, int idx)
 {
+	tap_packet_queue_t *queue = pinfo->tap_queue;
 	tap_packet_t *tp;
 	unsigned i;
 
 	/* nothing to do, just return */
-	if(!tapping_is_active){
-		return NULL;
-	}
-
-	/* nothing to do, just return */
-	if(!tap_packet_index){
+	if(!queue){
 		return NULL;
 	}
 
 	/* loop over all tapped packets and return the one with index idx */
-	for(i=0;i<tap_packet_index;i++){
-		tp=&tap_packet_array[i];
+	for(i=0;i<queue->len;i++){
+		tp=&queue->packets[i];
 		if(tp->tap_id==tap_id){
 			if(!idx--){
 				return tp->tap_specific_data;
@@ -603,6 +680,7 @@ register_tap_listener(const char *tapname, void *tapdata, const char *fstring,
 	tl->next=tap_listener_queue;
 
 	tap_listener_queue=tl;
+	tap_listener_index_dirty=true;
 
 	return NULL;
 }
@@ -746,6 +824,7 @@ remove_tap_listener(void *tapdata)
 			return;
 		}
 	}
+	tap_listener_index_dirty=true;
 	free_tap_listener(tl);
 }
 
@@ -798,6 +877,10 @@ have_tap_listener(int tap_id)
 {
 	tap_listener_t *tap_queue = tap_listener_queue;
 
+	if(!tap_listener_index_dirty){
+		return (unsigned)tap_id < tap_listener_index_len && tap_listener_index[tap_id] != NULL;
+	}
+
 	while(tap_queue) {
 		if(tap_queue->tap_id == tap_id)
 			return true;
@@ -866,6 +949,8 @@ void tap_cleanup(void)
 		free_tap_listener(elem_lq);
 	}
 	tap_listener_queue = NULL;
+	tap_listener_index_free();
+	tap_listener_index_dirty = true;
 
 	while(head_dl){
 		elem_dl = head_dl;
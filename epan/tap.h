@@ -143,9 +143,10 @@ WS_DLL_PUBLIC void tap_queue_packet(int tap_id, packet_info *pinfo, const void *
 /** Functions used by file.c to drive the tap subsystem */
 WS_DLL_PUBLIC void tap_build_interesting(epan_dissect_t *edt);
 
-/** This function is used to delete/initialize the tap queue and prime an
- *  epan_dissect_t with all the filters for tap listeners.
- *  To free the tap queue, we just prepend the used queue to the free queue.
+/** This function is used to create the tap queue of an epan_dissect_t and
+ *  prime it with all the filters for tap listeners.
+ *  The queue is allocated from the packet's pinfo->pool, so it is freed
+ *  along with the rest of the per-packet data.
  */
 extern void tap_queue_init(epan_dissect_t *edt);
 
@@ -307,7 +308,7 @@ WS_DLL_PUBLIC unsigned union_of_tap_listener_flags(void);
  * use "filters" and should specify the "filter" as NULL when registering
  * the tap listener.
  */
-WS_DLL_PUBLIC const void *fetch_tapped_data(int tap_id, int idx);
+WS_DLL_PUBLIC const void *fetch_tapped_data(packet_info *pinfo, int tap_id, int idx);
 
 /** Clean internal structures
  */
@@ -9,7 +9,14 @@
 #include "config.h"
 
 #include "strutil.h"
+#include "frame_data.h"
+#include "tvbuff.h"
+#include "in_cksum.h"
+#include "packet_info.h"
+#include "proto_data.h"
+#include "wmem_scopes.h"
 #include <wsutil/utf8_entities.h>
+#include <wsutil/time_util.h>
 
 /*
  * FIXME: LABEL_LENGTH includes the nul byte terminator.
@@ -74,6 +81,178 @@ void test_label_escape_control(void)
     g_assert_cmpuint(pos, ==, strlen(dst));
 }
 
+static void proto_data_pinfo_init(packet_info *pinfo, frame_data *fd)
+{
+    memset(pinfo, 0, sizeof(*pinfo));
+    memset(fd, 0, sizeof(*fd));
+    pinfo->pool = wmem_allocator_new(WMEM_ALLOCATOR_SIMPLE);
+    pinfo->fd = fd;
+}
+
+static void proto_data_pinfo_cleanup(packet_info *pinfo, frame_data *fd)
+{
+    frame_data_destroy(fd);
+    p_free_proto_data_list(pinfo->proto_data);
+    wmem_destroy_allocator(pinfo->pool);
+}
+
+void test_proto_data(void)
+{
+    packet_info pinfo;
+    frame_data fd;
+    int data[4];
+    uint32_t key;
+
+    proto_data_pinfo_init(&pinfo, &fd);
+
+    g_assert_null(p_get_proto_data(wmem_file_scope(), &pinfo, 1, 0));
+
+    /* Added out of order, so the entries have to be moved around. */
+    for (key = 10; key > 0; key--) {
+        p_add_proto_data(wmem_file_scope(), &pinfo, 2, key, GUINT_TO_POINTER(key));
+        p_add_proto_data(wmem_file_scope(), &pinfo, 1, key, GUINT_TO_POINTER(key + 100));
+    }
+    for (key = 1; key <= 10; key++) {
+        g_assert_true(p_get_proto_data(wmem_file_scope(), &pinfo, 2, key) == GUINT_TO_POINTER(key));
+        g_assert_true(p_get_proto_data(wmem_file_scope(), &pinfo, 1, key) == GUINT_TO_POINTER(key + 100));
+    }
+    g_assert_null(p_get_proto_data(wmem_file_scope(), &pinfo, 2, 11));
+    g_assert_null(p_get_proto_data(wmem_file_scope(), &pinfo, 3, 1));
+
+    /* The scopes are separate. */
+    g_assert_null(p_get_proto_data(pinfo.pool, &pinfo, 1, 1));
+    p_add_proto_data(pinfo.pool, &pinfo, 1, 1, &data[0]);
+    g_assert_true(p_get_proto_data(pinfo.pool, &pinfo, 1, 1) == &data[0]);
+    g_assert_true(p_get_proto_data(wmem_file_scope(), &pinfo, 1, 1) == GUINT_TO_POINTER(101));
+
+    /* The most recently added entry is found first. */
+    p_add_proto_data(wmem_file_scope(), &pinfo, 1, 5, &data[1]);
+    g_assert_true(p_get_proto_data(wmem_file_scope(), &pinfo, 1, 5) == &data[1]);
+    p_set_proto_data(wmem_file_scope(), &pinfo, 1, 5, &data[2]);
+    g_assert_true(p_get_proto_data(wmem_file_scope(), &pinfo, 1, 5) == &data[2]);
+    p_remove_proto_data(wmem_file_scope(), &pinfo, 1, 5);
+    g_assert_true(p_get_proto_data(wmem_file_scope(), &pinfo, 1, 5) == GUINT_TO_POINTER(105));
+    p_remove_proto_data(wmem_file_scope(), &pinfo, 1, 5);
+    g_assert_null(p_get_proto_data(wmem_file_scope(), &pinfo, 1, 5));
+    g_assert_true(p_get_proto_data(wmem_file_scope(), &pinfo, 1, 4) == GUINT_TO_POINTER(104));
+    g_assert_true(p_get_proto_data(wmem_file_scope(), &pinfo, 1, 6) == GUINT_TO_POINTER(106));
+
+    /* Setting an entry that doesn't exist adds it. */
+    p_set_proto_data(wmem_file_scope(), &pinfo, 3, 0, &data[3]);
+    g_assert_true(p_get_proto_data(wmem_file_scope(), &pinfo, 3, 0) == &data[3]);
+
+    /* Removing an entry that doesn't exist does nothing. */
+    p_remove_proto_data(wmem_file_scope(), &pinfo, 4, 0);
+
+    proto_data_pinfo_cleanup(&pinfo, &fd);
+}
+
+/* 16 bits at a time one's complement sum, to check in_cksum() against */
+static uint16_t in_cksum_reference(const uint8_t *ptr, int len)
+{
+    uint32_t sum = 0;
+    int i;
+
+    for (i = 0; i + 1 < len; i += 2)
+        sum += (ptr[i] << 8) | ptr[i + 1];
+    if (len & 1)
+        sum += ptr[len - 1] << 8;
+    while (sum >> 16)
+        sum = (sum & 0xffff) + (sum >> 16);
+    return g_htons(~sum & 0xffff);
+}
+
+void test_in_cksum(void)
+{
+    /* An IPv4 header with a valid checksum sums to zero. */
+    static const uint8_t ip_header[] = {
+        0x45, 0x00, 0x00, 0x73, 0x00, 0x00, 0x40, 0x00,
+        0x40, 0x11, 0xb8, 0x61, 0xc0, 0xa8, 0x00, 0x01,
+        0xc0, 0xa8, 0x00, 0xc7
+    };
+    uint8_t buf[2048 + 8];
+    vec_t vec[3];
+    int offset, len, split;
+
+    g_assert_cmpuint(ip_checksum(ip_header, sizeof ip_header), ==, 0);
+
+    for (unsigned i = 0; i < sizeof buf; i++)
+        buf[i] = (uint8_t)(i * 167 + 13);
+
+    /* Cover every alignment and tail length of the 8 byte loop. */
+    for (offset = 0; offset < 8; offset++) {
+        for (len = 0; len <= 2048; len += (len < 64) ? 1 : 97) {
+            g_assert_cmpuint(ip_checksum(buf + offset, len), ==,
+                             in_cksum_reference(buf + offset, len));
+
+            /* Odd length pieces are continued in the next one. */
+            split = len / 3;
+            SET_CKSUM_VEC_PTR(vec[0], buf + offset, split);
+            SET_CKSUM_VEC_PTR(vec[1], buf + offset + split, 1);
+            SET_CKSUM_VEC_PTR(vec[2], buf + offset + split + 1, len - split - 1 > 0 ? len - split - 1 : 0);
+            if (len > 0) {
+                g_assert_cmpuint(in_cksum(vec, 3), ==,
+                                 in_cksum_reference(buf + offset, len));
+            }
+        }
+    }
+}
+
+#define RESOURCE_USAGE_START get_resource_usage(&start_utime, &start_stime)
+
+#define RESOURCE_USAGE_END \
+    get_resource_usage(&end_utime, &end_stime); \
+    utime_ms = (end_utime - start_utime) * 1000.0; \
+    stime_ms = (end_stime - start_stime) * 1000.0
+
+/* NOTE: You have to run "test_epan -m perf" to run the performance tests. */
+void test_proto_data_perf(void)
+{
+#define LOOP_COUNT (1 * 1000 * 1000)
+/* Roughly what a TCP/TLS/HTTP2 frame carries on the second pass */
+#define PERF_PROTOS 8
+#define PERF_KEYS 4
+    packet_info pinfo;
+    frame_data fd;
+    int proto;
+    uint32_t key;
+    int i;
+    void *found = NULL;
+    double start_utime, start_stime, end_utime, end_stime, utime_ms, stime_ms;
+
+    proto_data_pinfo_init(&pinfo, &fd);
+
+    RESOURCE_USAGE_START;
+    for (i = 0; i < LOOP_COUNT / (PERF_PROTOS * PERF_KEYS); i++) {
+        for (proto = 1; proto <= PERF_PROTOS; proto++) {
+            for (key = 0; key < PERF_KEYS; key++) {
+                p_add_proto_data(wmem_file_scope(), &pinfo, proto, key, GUINT_TO_POINTER(key + 1));
+            }
+        }
+        frame_data_destroy(&fd);
+    }
+    RESOURCE_USAGE_END;
+    g_test_minimized_result(utime_ms + stime_ms,
+        "p_add_proto_data(): u %.3f ms s %.3f ms", utime_ms, stime_ms);
+
+    for (proto = 1; proto <= PERF_PROTOS; proto++) {
+        for (key = 0; key < PERF_KEYS; key++) {
+            p_add_proto_data(wmem_file_scope(), &pinfo, proto, key, GUINT_TO_POINTER(key + 1));
+        }
+    }
+
+    RESOURCE_USAGE_START;
+    for (i = 0; i < LOOP_COUNT; i++) {
+        found = p_get_proto_data(wmem_file_scope(), &pinfo, (i % PERF_PROTOS) + 1, i % PERF_KEYS);
+    }
+    RESOURCE_USAGE_END;
+    g_assert_nonnull(found);
+    g_test_minimized_result(utime_ms + stime_ms,
+        "p_get_proto_data(): u %.3f ms s %.3f ms", utime_ms, stime_ms);
+
+    proto_data_pinfo_cleanup(&pinfo, &fd);
+}
+
 int main(int argc, char **argv)
 {
     int ret;
@@ -83,14 +262,23 @@ int main(int argc, char **argv)
 
     ws_log_init(NULL);
 
+    wmem_init_scopes();
+
     g_test_init(&argc, &argv, NULL);
 
     g_test_add_func("/label/strcat", test_label_strcat);
     g_test_add_func("/label/escape_whitespace", test_label_strcat_escape_whitespace);
     g_test_add_func("/label/escape_control", test_label_escape_control);
+    g_test_add_func("/in_cksum/sum", test_in_cksum);
+    g_test_add_func("/proto_data/lookup", test_proto_data);
+    if (g_test_perf()) {
+        g_test_add_func("/proto_data/perf", test_proto_data_perf);
+    }
 
     ret = g_test_run();
 
+    wmem_cleanup_scopes();
+
     return ret;
 }
 
@@ -158,10 +158,93 @@ static expert_field ei_lua_proto_interface_error;
 
 static int ett_wslua_traceback;
 
+/*
+ * The Tvb and Pinfo objects handed to the Lua dissectors are shared by all
+ * the Lua dissectors (and heuristic dissectors) called for a packet, rather
+ * than allocating a new pair for every call. They are looked up by the
+ * wrapped pointer and are only valid for the generation they were created
+ * in; lua_pinfo_end() expires them and starts a new generation.
+ */
+typedef struct {
+    const void *ws_obj;         /* the wrapped tvbuff_t or packet_info */
+    int ref;                    /* registry reference to the userdata */
+    unsigned generation;
+} wslua_cached_wrapper_t;
+
+static unsigned lua_packet_generation = 1;
+static wslua_cached_wrapper_t lua_cached_tvb = { NULL, LUA_NOREF, 0 };
+static wslua_cached_wrapper_t lua_cached_pinfo = { NULL, LUA_NOREF, 0 };
+/* The pool lua_pinfo_end() is currently registered with */
+static wmem_allocator_t *lua_pinfo_end_pool;
+
+static void
+cached_wrapper_clear(lua_State *LS, wslua_cached_wrapper_t *cached)
+{
+    if (LS && cached->ref != LUA_NOREF) {
+        luaL_unref(LS, LUA_REGISTRYINDEX, cached->ref);
+    }
+    cached->ws_obj = NULL;
+    cached->ref = LUA_NOREF;
+}
+
+/* Pushes the Tvb wrapping ws_tvb, reusing the one pushed earlier for the same packet. */
+static void
+push_cached_Tvb(lua_State *LS, tvbuff_t *ws_tvb)
+{
+    if (lua_cached_tvb.ref != LUA_NOREF && lua_cached_tvb.ws_obj == ws_tvb &&
+            lua_cached_tvb.generation == lua_packet_generation) {
+        lua_rawgeti(LS, LUA_REGISTRYINDEX, lua_cached_tvb.ref);
+        return;
+    }
+    cached_wrapper_clear(LS, &lua_cached_tvb);
+    push_Tvb(LS, ws_tvb);
+    lua_pushvalue(LS, -1);
+    lua_cached_tvb.ref = luaL_ref(LS, LUA_REGISTRYINDEX);
+    lua_cached_tvb.ws_obj = ws_tvb;
+    lua_cached_tvb.generation = lua_packet_generation;
+}
+
+/* Pushes the Pinfo wrapping ws_pinfo, reusing the one pushed earlier for the same packet. */
+static void
+push_cached_Pinfo(lua_State *LS, packet_info *ws_pinfo)
+{
+    if (lua_cached_pinfo.ref != LUA_NOREF && lua_cached_pinfo.ws_obj == ws_pinfo &&
+            lua_cached_pinfo.generation == lua_packet_generation) {
+        lua_rawgeti(LS, LUA_REGISTRYINDEX, lua_cached_pinfo.ref);
+        return;
+    }
+    cached_wrapper_clear(LS, &lua_cached_pinfo);
+    push_Pinfo(LS, ws_pinfo);
+    lua_pushvalue(LS, -1);
+    lua_cached_pinfo.ref = luaL_ref(LS, LUA_REGISTRYINDEX);
+    lua_cached_pinfo.ws_obj = ws_pinfo;
+    lua_cached_pinfo.generation = lua_packet_generation;
+}
+
+/* Forgets the cached wrappers without touching the registry, for when the Lua state goes away. */
+static void
+cached_wrappers_reset(void)
+{
+    lua_cached_tvb.ws_obj = NULL;
+    lua_cached_tvb.ref = LUA_NOREF;
+    lua_cached_pinfo.ws_obj = NULL;
+    lua_cached_pinfo.ref = LUA_NOREF;
+    lua_packet_generation++;
+}
+
+bool wslua_is_lua_protocol(const char *proto_filter_name) {
+    return L && proto_filter_name && wslua_is_proto_available(L, proto_filter_name);
+}
+
 static bool
 lua_pinfo_end(wmem_allocator_t *allocator _U_, wmem_cb_event_t event _U_,
         void *user_data _U_)
 {
+    cached_wrapper_clear(L, &lua_cached_tvb);
+    cached_wrapper_clear(L, &lua_cached_pinfo);
+    lua_packet_generation++;
+    lua_pinfo_end_pool = NULL;
+
     clear_outstanding_Tvb();
     clear_outstanding_TvbRange();
     clear_outstanding_Pinfo();
@@ -313,9 +396,9 @@ int dissect_lua(tvbuff_t* tvb, packet_info* pinfo, proto_tree* tree, void* data
     if (lua_isfunction(L,2)) {
 
         // After call, stack: [ error_handler_func, dissector, tvb ]
-        push_Tvb(L,tvb);
+        push_cached_Tvb(L,tvb);
         // After call, stack: [ error_handler_func, dissector, tvb, pinfo ]
-        push_Pinfo(L,pinfo);
+        push_cached_Pinfo(L,pinfo);
         // After call, stack: [ error_handler_func, dissector, tvb, pinfo, TreeItem ]
         lua_tree = push_TreeItem(L, tree, proto_tree_add_item(tree, hf_wslua_fake, tvb, 0, 0, ENC_NA));
         proto_item_set_hidden(lua_tree->item);
@@ -337,7 +420,10 @@ int dissect_lua(tvbuff_t* tvb, packet_info* pinfo, proto_tree* tree, void* data
                     "Lua Error: did not find the %s dissector in the dissectors table", pinfo->current_proto);
     }
 
-    wmem_register_callback(pinfo->pool, lua_pinfo_end, NULL);
+    if (lua_pinfo_end_pool != pinfo->pool) {
+        wmem_register_callback(pinfo->pool, lua_pinfo_end, NULL);
+        lua_pinfo_end_pool = pinfo->pool;
+    }
 
     lua_pinfo = saved_lua_pinfo;
     lua_tree = saved_lua_tree;
@@ -414,8 +500,8 @@ bool heur_dissect_lua(tvbuff_t* tvb, packet_info* pinfo, proto_tree* tree, void*
         return false;
     }
 
-    push_Tvb(L,tvb);
-    push_Pinfo(L,pinfo);
+    push_cached_Tvb(L,tvb);
+    push_cached_Pinfo(L,pinfo);
     lua_tree = push_TreeItem(L, tree, proto_tree_add_item(tree, hf_wslua_fake, tvb, 0, 0, ENC_NA));
     proto_item_set_hidden(lua_tree->item);
 
@@ -435,7 +521,10 @@ bool heur_dissect_lua(tvbuff_t* tvb, packet_info* pinfo, proto_tree* tree, void*
         lua_pop(L, 1);
     }
 
-    wmem_register_callback(pinfo->pool, lua_pinfo_end, NULL);
+    if (lua_pinfo_end_pool != pinfo->pool) {
+        wmem_register_callback(pinfo->pool, lua_pinfo_end, NULL);
+        lua_pinfo_end_pool = pinfo->pool;
+    }
 
     lua_pinfo = saved_lua_pinfo;
     lua_tree = saved_lua_tree;
@@ -1602,6 +1691,7 @@ void wslua_init(register_cb cb, void *client_data) {
     }
 
     if (!L) {
+        cached_wrappers_reset();
         L = lua_newstate(wslua_allocf, NULL);
     }
 
@@ -1875,6 +1965,7 @@ void wslua_cleanup(void) {
         lua_close(L);
         L = NULL;
     }
+    cached_wrappers_reset();
     init_routine_initialized = false;
 }
 
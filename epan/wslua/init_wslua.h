@@ -10,6 +10,8 @@
 #ifndef __INIT_WSLUA_H__
 #define __INIT_WSLUA_H__
 
+#include <stdbool.h>
+
 #include "ws_symbol_export.h"
 
 #ifdef __cplusplus
@@ -26,6 +28,13 @@ WS_DLL_PUBLIC void wslua_plugins_get_descriptions(wslua_plugin_description_callb
 WS_DLL_PUBLIC void wslua_plugins_dump_all(void);
 WS_DLL_PUBLIC const char *wslua_plugin_type_name(void);
 
+/** Whether a protocol was created by a Lua script, so that e.g. the dissector
+ *  profile of the Lua dissectors can be shown on its own.
+ *
+ * @param proto_filter_name The filter name of the protocol
+ */
+WS_DLL_PUBLIC bool wslua_is_lua_protocol(const char *proto_filter_name);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
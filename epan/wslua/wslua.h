@@ -862,6 +862,7 @@ extern tap_extractor_t wslua_get_tap_extractor(const char* name);
 extern int wslua_set_tap_enums(lua_State* L);
 
 extern ProtoField wslua_is_field_available(lua_State* L, const char* field_abbr);
+extern bool wslua_is_proto_available(lua_State* L, const char* proto_filter_name);
 
 extern char* wslua_get_actual_filename(const char* fname);
 
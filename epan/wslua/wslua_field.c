@@ -716,6 +716,156 @@ WSLUA_METAMETHOD Field__call (lua_State* L) {
     WSLUA_RETURN(items_found); /* All the values of this field */
 }
 
+/* Pushes the value of a field as a plain Lua value, without a FieldInfo or
+ * any other userdata wrapper. */
+static void push_field_value_plain(lua_State* L, field_info* fi) {
+    switch(fi->hfinfo->type) {
+        case FT_BOOLEAN:
+                lua_pushboolean(L,(int)fvalue_get_uinteger64(fi->value));
+                return;
+        case FT_CHAR:
+        case FT_UINT8:
+        case FT_UINT16:
+        case FT_UINT24:
+        case FT_UINT32:
+        case FT_FRAMENUM:
+                lua_pushinteger(L,(lua_Integer)(fvalue_get_uinteger(fi->value)));
+                return;
+        case FT_INT8:
+        case FT_INT16:
+        case FT_INT24:
+        case FT_INT32:
+                lua_pushinteger(L,(lua_Integer)(fvalue_get_sinteger(fi->value)));
+                return;
+        case FT_INT40:
+        case FT_INT48:
+        case FT_INT56:
+        case FT_INT64:
+#if LUA_VERSION_NUM >= 503
+                lua_pushinteger(L,(lua_Integer)(fvalue_get_sinteger64(fi->value)));
+#else
+                lua_pushnumber(L,(lua_Number)(fvalue_get_sinteger64(fi->value)));
+#endif
+                return;
+        case FT_UINT40:
+        case FT_UINT48:
+        case FT_UINT56:
+        case FT_UINT64:
+                /* Values above 2^63 wrap around to negative integers on Lua 5.3 and later. */
+#if LUA_VERSION_NUM >= 503
+                lua_pushinteger(L,(lua_Integer)(fvalue_get_uinteger64(fi->value)));
+#else
+                lua_pushnumber(L,(lua_Number)(fvalue_get_uinteger64(fi->value)));
+#endif
+                return;
+        case FT_FLOAT:
+        case FT_DOUBLE:
+                lua_pushnumber(L,(lua_Number)(fvalue_get_floating(fi->value)));
+                return;
+        case FT_ABSOLUTE_TIME:
+        case FT_RELATIVE_TIME:
+                lua_pushnumber(L,(lua_Number)nstime_to_sec(fvalue_get_time(fi->value)));
+                return;
+        case FT_BYTES:
+        case FT_UINT_BYTES:
+        case FT_REL_OID:
+        case FT_SYSTEM_ID:
+        case FT_OID:
+                lua_pushlstring(L,(const char*)fvalue_get_bytes_data(fi->value),
+                                fvalue_length2(fi->value));
+                return;
+        case FT_NONE:
+                if (fi->length > 0 && fi->rep) {
+                    lua_pushstring(L,fi->rep->representation);
+                } else {
+                    lua_pushnil(L);
+                }
+                return;
+        case FT_PROTOCOL:
+                /* The value is the protocol's tvb; don't copy it just to name the protocol */
+                lua_pushstring(L,fi->hfinfo->abbrev);
+                return;
+        default: {
+                /* Strings, addresses, GUIDs, etc. */
+                char* repr = fvalue_to_string_repr(NULL, fi->value, FTREPR_DISPLAY, fi->hfinfo->display);
+                if (repr) {
+                    lua_pushstring(L,repr);
+                    wmem_free(NULL,repr);
+                } else {
+                    lua_pushnil(L);
+                }
+                return;
+            }
+    }
+}
+
+WSLUA_CONSTRUCTOR Field_values(lua_State* L) {
+    /*
+       Obtain the first value of each of the given fields as plain Lua values, in one call.
+
+       Unlike calling the `Field` extractors, this doesn't create a `FieldInfo` object per value,
+       which matters for listeners and post-dissectors processing large captures:
+
+       [source,lua]
+       ----
+       local f_src, f_srcport = Field.new("ip.src"), Field.new("tcp.srcport")
+       function tap.packet(pinfo, tvb)
+           local src, srcport = Field.values(f_src, f_srcport)
+       end
+       ----
+
+       Integer fields are returned as integers (64-bit ones as integers on Lua 5.3 and later),
+       floating-point fields as numbers, times as numbers of seconds, booleans as booleans,
+       byte fields as strings of the raw bytes and protocols as their filter name. Any other
+       field (strings, addresses, etc.) is returned as its display string. A field that isn't
+       present in the packet gives `nil`.
+
+       @since 4.5.0
+       */
+#define WSLUA_ARG_Field_values_FIELD 1 /* The field extractors, as several arguments. */
+    int nargs = lua_gettop(L);
+    int i;
+
+    if (nargs < 1) {
+        WSLUA_ARG_ERROR(Field_values,FIELD,"at least one Field is required");
+        return 0;
+    }
+
+    if (! lua_pinfo ) {
+        WSLUA_ERROR(Field_values,"Fields cannot be used outside dissectors or taps");
+        return 0;
+    }
+
+    luaL_checkstack(L, nargs, "too many fields");
+
+    for (i = 1; i <= nargs; i++) {
+        Field f = checkField(L,i);
+        header_field_info* in = f->hfi;
+        field_info* fi = NULL;
+
+        if (! in) {
+            luaL_error(L,"invalid field");
+            return 0;
+        }
+
+        /* The first value of the field or of a field with the same name */
+        for (; in && !fi; in = (in->same_name_prev_id != -1) ? proto_registrar_get_nth(in->same_name_prev_id) : NULL) {
+            GPtrArray* found = proto_get_finfo_ptr_array(lua_tree->tree, in->id);
+            if (found && found->len > 0) {
+                fi = (field_info*)g_ptr_array_index(found,0);
+            }
+        }
+
+        if (fi) {
+            push_field_value_plain(L, fi);
+        } else {
+            lua_pushnil(L);
+        }
+    }
+
+    WSLUA_RETURN(nargs); /* The first value of each field, or `nil` where it is absent. */
+}
+
 WSLUA_METAMETHOD Field__tostring(lua_State* L) {
     /* Obtain a string with the field filter name. */
     Field f = checkField(L,1);
@@ -755,6 +905,7 @@ WSLUA_ATTRIBUTES Field_attributes[] = {
 WSLUA_METHODS Field_methods[] = {
     WSLUA_CLASS_FNREG(Field,new),
     WSLUA_CLASS_FNREG(Field,list),
+    WSLUA_CLASS_FNREG(Field,values),
     { NULL, NULL }
 };
 
@@ -746,6 +746,20 @@ ProtoField wslua_is_field_available(lua_State* L, const char* field_abbr) {
     return NULL;
 }
 
+/**
+ * Query whether the protocol with this filter name was created by a Proto in lua.
+ */
+bool wslua_is_proto_available(lua_State* L, const char* proto_filter_name) {
+    bool found;
+
+    lua_rawgeti(L, LUA_REGISTRYINDEX, protocols_table_ref);
+    lua_getfield(L, -1, proto_filter_name);
+    found = !lua_isnil(L, -1);
+    lua_pop(L, 2); /* value and protocols_table_ref */
+
+    return found;
+}
+
 int wslua_deregister_heur_dissectors(lua_State* L) {
     /* for each registered heur dissector do... */
     lua_rawgeti(L, LUA_REGISTRYINDEX, lua_heur_dissectors_table_ref);
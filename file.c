@@ -231,7 +231,8 @@ ws_epan_new(capture_file *cf)
         cap_file_provider_get_frame_ts,
         cap_file_provider_get_interface_name,
         cap_file_provider_get_interface_description,
-        cap_file_provider_get_modified_block
+        cap_file_provider_get_modified_block,
+        cap_file_provider_add_dependent_frame
     };
 
     return epan_new(&cf->provider, &funcs);
@@ -1222,12 +1223,12 @@ add_packet_to_packet_list(frame_data *fdata, capture_file *cf,
     if (fdata->passed_dfilter && dfcode != NULL) {
         fdata->passed_dfilter = dfilter_apply_edt(dfcode, edt) ? 1 : 0;
 
-        if (fdata->passed_dfilter && edt->pi.fd->dependent_frames) {
+        if (fdata->passed_dfilter && edt->pi.fd->has_dependent_frames) {
             /* This frame passed the display filter but it may depend on other
              * (potentially not displayed) frames.  Find those frames and mark them
              * as depended upon.
              */
-            g_hash_table_foreach(edt->pi.fd->dependent_frames, find_and_mark_frame_depended_upon, cf->provider.frames);
+            g_hash_table_foreach(frame_data_sequence_get_dependent_frames(cf->provider.frames, edt->pi.fd), find_and_mark_frame_depended_upon, cf->provider.frames);
         }
     }
 
@@ -5063,6 +5064,11 @@ cf_get_packet_block(capture_file *cf, const frame_data *fd)
         block = wtap_block_ref(rec.block);
 
         wtap_rec_cleanup(&rec);
+
+        /* Records without options might not have a block at all;
+         * give the caller one it can add options to. */
+        if (block == NULL)
+            block = wtap_block_create(WTAP_BLOCK_PACKET);
         return block;
     }
 }
@@ -113,3 +113,12 @@ cap_file_provider_set_modified_block(struct packet_provider_data *prov, frame_da
 
   fd->has_modified_block = 1;
 }
+
+void
+cap_file_provider_add_dependent_frame(struct packet_provider_data *prov, frame_data *fd, uint32_t frame_num)
+{
+  /* If we're not keeping the frames, no one can look up the frames they
+     depend on. */
+  if (prov->frames)
+    frame_data_sequence_add_dependent_frame(prov->frames, fd, frame_num);
+}
@@ -1606,7 +1606,7 @@ proto_register_falcoplugin(void)
     fd_follow_tap = register_tap("fd_follow");
 
     register_follow_stream(proto_syscalls[SSC_FD], "fd_follow", fd_follow_conv_filter, fd_follow_index_filter, fd_follow_address_filter,
-                           fd_port_to_display, fd_tap_listener, get_fd_stream_count, NULL);
+                           fd_port_to_display, fd_tap_listener, get_fd_stream_count, NULL, NULL);
 
     // Preferences
     module_t *falco_events_module = prefs_register_protocol(proto_falco_events, NULL);
@@ -48,6 +48,7 @@
 #include "ui/failure_message.h"
 #include <wiretap/wtap.h>
 #include <epan/epan_dissect.h>
+#include <epan/follow.h>
 #include <epan/tap.h>
 #include <epan/uat-int.h>
 #include <epan/secrets.h>
@@ -209,6 +210,10 @@ main(int argc, char *argv[])
 
     codecs_init();
 
+    /* Record the frames of each TCP and UDP stream, so that following
+     * a stream only dissects its frames again. */
+    follow_set_stream_index_enabled(true);
+
     /* Load libwireshark settings from the current profile. */
     prefs_p = epan_load_settings();
 
@@ -249,7 +254,8 @@ sharkd_epan_new(capture_file *cf)
         cap_file_provider_get_frame_ts,
         cap_file_provider_get_interface_name,
         cap_file_provider_get_interface_description,
-        cap_file_provider_get_modified_block
+        cap_file_provider_get_modified_block,
+        cap_file_provider_add_dependent_frame
     };
 
     return epan_new(&cf->provider, &funcs);
@@ -307,14 +313,14 @@ process_packet(capture_file *cf, epan_dissect_t *edt, int64_t offset,
         cf->provider.prev_cap = cf->provider.prev_dis = frame_data_sequence_add(cf->provider.frames, &fdlocal);
 
         /* If we're not doing dissection then there won't be any dependent frames.
-         * More importantly, edt.pi.fd.dependent_frames won't be initialized because
+         * More importantly, the dependent frames won't be initialized because
          * epan hasn't been initialized.
          * if we *are* doing dissection, then mark the dependent frames, but only
          * if a display filter was given and it matches this packet.
          */
         if (edt && cf->dfcode) {
-            if (dfilter_apply_edt(cf->dfcode, edt) && edt->pi.fd->dependent_frames) {
-                g_hash_table_foreach(edt->pi.fd->dependent_frames, find_and_mark_frame_depended_upon, cf->provider.frames);
+            if (dfilter_apply_edt(cf->dfcode, edt) && edt->pi.fd->has_dependent_frames) {
+                g_hash_table_foreach(frame_data_sequence_get_dependent_frames(cf->provider.frames, edt->pi.fd), find_and_mark_frame_depended_upon, cf->provider.frames);
             }
         }
 
@@ -547,7 +553,16 @@ sharkd_dissect_request(uint32_t framenum, uint32_t frame_ref_num,
 int
 sharkd_retap(void)
 {
-    uint32_t         framenum;
+    return sharkd_retap_frames(NULL, 0);
+}
+
+/* Like sharkd_retap(), but only taps the given frames (in ascending order)
+ * if frames is not NULL. */
+int
+sharkd_retap_frames(const uint32_t *frames, unsigned num_frames)
+{
+    uint32_t         framenum, prev_framenum = 0;
+    unsigned         i, count;
     frame_data      *fdata;
     wtap_rec         rec;
     int err;
@@ -580,7 +595,11 @@ sharkd_retap(void)
 
     reset_tap_listeners();
 
-    for (framenum = 1; framenum <= cfile.count; framenum++) {
+    count = frames ? num_frames : cfile.count;
+    for (i = 0; i < count; i++) {
+        framenum = frames ? frames[i] : i + 1;
+        if (framenum == 0 || framenum > cfile.count)
+            continue;
         fdata = sharkd_get_frame(framenum);
 
         if (!wtap_seek_read(cfile.provider.wth, fdata->file_off, &rec, &err, &err_info))
@@ -588,7 +607,8 @@ sharkd_retap(void)
 
         fdata->ref_time = false;
         fdata->frame_ref_num = (framenum != 1) ? 1 : 0;
-        fdata->prev_dis_num = framenum - 1;
+        fdata->prev_dis_num = prev_framenum;
+        prev_framenum = framenum;
         epan_dissect_run_with_taps(&edt, cfile.cd_t, &rec, fdata, cinfo);
         wtap_rec_reset(&rec);
         epan_dissect_reset(&edt);
@@ -716,6 +736,11 @@ sharkd_get_packet_block(const frame_data *fd)
         block = wtap_block_ref(rec.block);
 
         wtap_rec_cleanup(&rec);
+
+        /* Records without options might not have a block at all;
+         * give the caller one it can add options to. */
+        if (block == NULL)
+            block = wtap_block_create(WTAP_BLOCK_PACKET);
         return block;
     }
 }
@@ -35,6 +35,7 @@ cf_status_t sharkd_cf_open(const char *fname, unsigned int type, bool is_tempfil
 int sharkd_load_cap_file(void);
 int sharkd_load_cap_file_with_limits(int max_packet_count, int64_t max_byte_count);
 int sharkd_retap(void);
+int sharkd_retap_frames(const uint32_t *frames, unsigned num_frames);
 int sharkd_filter(const char *dftext, uint8_t **result);
 frame_data *sharkd_get_frame(uint32_t framenum);
 enum dissect_request_status {
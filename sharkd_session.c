@@ -40,6 +40,7 @@
 #include <ui/ssl_key_export.h>
 
 #include <ui/io_graph_item.h>
+#include <ui/expert_info_index.h>
 #include <epan/stats_tree_priv.h>
 #include <epan/stat_tap_ui.h>
 #include <epan/conversation_table.h>
@@ -375,6 +376,7 @@ json_prep(char* buf, const jsmntok_t* tokens, int count)
         {"method",     "bye",            1, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_OPTIONAL},
         {"method",     "check",          1, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_OPTIONAL},
         {"method",     "complete",       1, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_OPTIONAL},
+        {"method",     "dissector_profile", 1, JSMN_STRING,    SHARKD_JSON_STRING,   SHARKD_OPTIONAL},
         {"method",     "download",       1, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_OPTIONAL},
         {"method",     "dumpconf",       1, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_OPTIONAL},
         {"method",     "follow",         1, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_OPTIONAL},
@@ -396,10 +398,14 @@ json_prep(char* buf, const jsmntok_t* tokens, int count)
         {"check",      "filter",         2, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_OPTIONAL},
         {"complete",   "field",          2, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_OPTIONAL},
         {"complete",   "pref",           2, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_OPTIONAL},
+        {"dissector_profile", "enable",  2, JSMN_PRIMITIVE,    SHARKD_JSON_BOOLEAN,  SHARKD_OPTIONAL},
+        {"dissector_profile", "memory",  2, JSMN_PRIMITIVE,    SHARKD_JSON_BOOLEAN,  SHARKD_OPTIONAL},
+        {"dissector_profile", "reset",   2, JSMN_PRIMITIVE,    SHARKD_JSON_BOOLEAN,  SHARKD_OPTIONAL},
         {"download",   "token",          2, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_OPTIONAL},
         {"dumpconf",   "pref",           2, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_OPTIONAL},
         {"follow",     "follow",         2, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_MANDATORY},
         {"follow",     "filter",         2, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_MANDATORY},
+        {"follow",     "stream",         2, JSMN_PRIMITIVE,    SHARKD_JSON_UINTEGER, SHARKD_OPTIONAL},
         {"follow",     "sub_stream",     2, JSMN_PRIMITIVE,    SHARKD_JSON_UINTEGER, SHARKD_OPTIONAL},
         {"field",      "name",           2, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_MANDATORY},
         {"frame",      "frame",          2, JSMN_PRIMITIVE,    SHARKD_JSON_UINTEGER, SHARKD_MANDATORY},
@@ -1379,6 +1385,19 @@ sharkd_session_process_load(const char *buf, const jsmntok_t *tokens, int count)
 
 }
 
+static void
+sharkd_session_process_status_memory_cb(const char *name, const wmem_accounting_stats_t *stats, void *user_data _U_)
+{
+    sharkd_json_object_open(NULL);
+    if (name)
+        sharkd_json_value_string("name", name);
+    else
+        sharkd_json_value_anyf("name", "null");
+    sharkd_json_value_anyf("allocations", "%" PRIu64, stats->allocations);
+    sharkd_json_value_anyf("bytes", "%" PRIu64, stats->bytes);
+    sharkd_json_object_close();
+}
+
 /**
  * sharkd_session_process_status()
  *
@@ -1395,6 +1414,11 @@ sharkd_session_process_load(const char *buf, const jsmntok_t *tokens, int count)
  *                      'format'   - column format (%x or %Cus:<expr>:<occurrence> if COL_CUSTOM)
  *                      'visible'  - true if column is visible
  *                      'display'  - column display format; 'U', 'R' or 'D'
+ *   (o) memory      - if enabled with the dissector_profile request, the file scope
+ *                     memory allocated per protocol, array of object with attributes:
+ *                      'name'        - protocol filter name, or null if allocated outside dissectors
+ *                      'allocations' - number of allocations and reallocations
+ *                      'bytes'       - bytes requested by them
  */
 static void
 sharkd_session_process_status(void)
@@ -1448,6 +1472,88 @@ sharkd_session_process_status(void)
         sharkd_json_array_close();
     }
 
+    if (dissector_memory_accounting_is_enabled())
+    {
+        sharkd_json_array_open("memory");
+        dissector_memory_accounting_foreach(sharkd_session_process_status_memory_cb, NULL);
+        sharkd_json_array_close();
+    }
+
+    sharkd_json_result_epilogue();
+}
+
+static void
+sharkd_session_process_dissector_profile_cb(const dissector_profile_entry_t *entry, void *user_data _U_)
+{
+    sharkd_json_object_open(NULL);
+    sharkd_json_value_string("name", entry->name);
+    sharkd_json_value_anyf("calls", "%" PRIu64, entry->calls);
+    sharkd_json_value_anyf("inclusive_ns", "%" PRIu64, entry->inclusive_ns);
+    sharkd_json_value_anyf("exclusive_ns", "%" PRIu64, entry->exclusive_ns);
+    if (entry->heur_attempts)
+    {
+        sharkd_json_value_anyf("heur_attempts", "%" PRIu64, entry->heur_attempts);
+        sharkd_json_value_anyf("heur_accepts", "%" PRIu64, entry->heur_accepts);
+    }
+    sharkd_json_object_close();
+}
+
+/* Whether this session has dissector profiling enabled */
+static bool sharkd_dissector_profiling;
+
+/**
+ * sharkd_session_process_dissector_profile()
+ *
+ * Process dissector_profile request. Profiling applies to every dissection
+ * done afterwards, e.g. by the load, frames, frame or tap requests.
+ *
+ * Input:
+ *   (o) reset  - true to discard the profile collected so far
+ *   (o) enable - true to start profiling, false to stop it
+ *   (o) memory - true to start counting the file scope memory allocated by
+ *                each protocol, false to stop it; the counts are reported
+ *                by the status request
+ *
+ * Output object with attributes:
+ *   (m) enabled   - true if profiling is on
+ *   (m) memory    - true if memory is being counted
+ *   (m) protocols - array of object with attributes:
+ *                  'name' - protocol filter name
+ *                  'calls' - number of dissector calls
+ *                  'inclusive_ns' - time spent in its dissectors, including the ones they called
+ *                  'exclusive_ns' - time spent in its dissectors only
+ *                  'heur_attempts' - (o) number of heuristic dissector calls
+ *                  'heur_accepts' - (o) number of heuristic dissector calls that accepted the data
+ */
+static void
+sharkd_session_process_dissector_profile(const char *buf, const jsmntok_t *tokens, int count)
+{
+    const char *tok_reset = json_find_attr(buf, tokens, count, "reset");
+    const char *tok_enable = json_find_attr(buf, tokens, count, "enable");
+    const char *tok_memory = json_find_attr(buf, tokens, count, "memory");
+
+    if (tok_reset && !strcmp(tok_reset, "true"))
+        dissector_profile_reset();
+    if (tok_enable)
+    {
+        bool enable = !strcmp(tok_enable, "true");
+
+        /* Profiling is enabled per user; only count this session once. */
+        if (enable != sharkd_dissector_profiling)
+        {
+            dissector_profile_enable(enable);
+            sharkd_dissector_profiling = enable;
+        }
+    }
+    if (tok_memory)
+        dissector_memory_accounting_enable(!strcmp(tok_memory, "true"));
+
+    sharkd_json_result_prologue(rpcid);
+    sharkd_json_value_anyf("enabled", dissector_profile_is_enabled() ? "true" : "false");
+    sharkd_json_value_anyf("memory", dissector_memory_accounting_is_enabled() ? "true" : "false");
+    sharkd_json_array_open("protocols");
+    dissector_profile_foreach(sharkd_session_process_dissector_profile_cb, NULL);
+    sharkd_json_array_close();
     sharkd_json_result_epilogue();
 }
 
@@ -2076,6 +2182,103 @@ sharkd_session_free_tap_expert_cb(void *tapdata)
     g_free(etd);
 }
 
+static bool
+sharkd_session_expert_frame_cb(uint32_t frame_num, void *user_data _U_)
+{
+    json_dumper_value_anyf(&dumper, "%u", frame_num);
+    return true;
+}
+
+/**
+ * sharkd_session_process_tap_expert_aggregate_cb()
+ *
+ * Output aggregated expert tap:
+ *
+ *   (m) tap         - tap name
+ *   (m) type:expert-aggregate - tap output type
+ *   (m) details     - array of object with attributes, one per distinct expert information:
+ *                  (m) c - number of occurrences
+ *                  (m) f - array of frame numbers, one per occurrence
+ *                  (o) s - severity
+ *                  (o) g - group
+ *                  (m) m - expert message
+ *                  (o) p - protocol
+ *                  (o) e - expert info filter name
+ */
+static void
+sharkd_session_process_tap_expert_aggregate_cb(void *tapdata)
+{
+    expert_info_index_t *index = (expert_info_index_t *) tapdata;
+    unsigned num_entries = expert_info_index_num_entries(index);
+
+    json_dumper_begin_object(&dumper);
+
+    sharkd_json_value_string("tap", "expert:aggregate");
+    sharkd_json_value_string("type", "expert-aggregate");
+
+    sharkd_json_array_open("details");
+    for (unsigned i = 0; i < num_entries; i++)
+    {
+        const expert_index_entry_t *entry = expert_info_index_get_entry(index, i);
+        const char *tmp;
+
+        json_dumper_begin_object(&dumper);
+
+        sharkd_json_value_anyf("c", "%u", entry->count);
+
+        sharkd_json_array_open("f");
+        expert_info_index_foreach_frame(entry, sharkd_session_expert_frame_cb, NULL);
+        sharkd_json_array_close();
+
+        tmp = try_val_to_str(entry->severity, expert_severity_vals);
+        if (tmp)
+            sharkd_json_value_string("s", tmp);
+
+        tmp = try_val_to_str(entry->group, expert_group_vals);
+        if (tmp)
+            sharkd_json_value_string("g", tmp);
+
+        sharkd_json_value_string("m", entry->summary);
+
+        if (entry->protocol)
+            sharkd_json_value_string("p", entry->protocol);
+
+        if (entry->hf_index > 0)
+            sharkd_json_value_string("e", proto_registrar_get_abbrev(entry->hf_index));
+
+        json_dumper_end_object(&dumper);
+    }
+    sharkd_json_array_close();
+
+    json_dumper_end_object(&dumper);
+}
+
+static tap_packet_status
+sharkd_session_packet_tap_expert_aggregate_cb(void *tapdata, packet_info *pinfo _U_, epan_dissect_t *edt _U_, const void *pointer, tap_flags_t flags _U_)
+{
+    expert_info_index_t *index = (expert_info_index_t *) tapdata;
+    const expert_info_t *ei    = (const expert_info_t *) pointer;
+
+    if (ei == NULL)
+        return TAP_PACKET_DONT_REDRAW;
+
+    expert_info_index_add(index, ei);
+
+    return TAP_PACKET_REDRAW;
+}
+
+static void
+sharkd_session_reset_tap_expert_aggregate_cb(void *tapdata)
+{
+    expert_info_index_reset((expert_info_index_t *) tapdata);
+}
+
+static void
+sharkd_session_free_tap_expert_aggregate_cb(void *tapdata)
+{
+    expert_info_index_free((expert_info_index_t *) tapdata);
+}
+
 /**
  * sharkd_session_process_tap_flow_cb()
  *
@@ -3590,6 +3793,7 @@ sharkd_session_eo_register_tap_listener(register_eo_t *eo, const char *tap_type,
  *                  for type:rtp-analyse see sharkd_session_process_tap_rtp_analyse_cb()
  *                  for type:eo see sharkd_session_process_tap_eo_cb()
  *                  for type:expert see sharkd_session_process_tap_expert_cb()
+ *                  for type:expert-aggregate see sharkd_session_process_tap_expert_aggregate_cb()
  *                  for type:rtd see sharkd_session_process_tap_rtd_cb()
  *                  for type:srt see sharkd_session_process_tap_srt_cb()
  *                  for type:flow see sharkd_session_process_tap_flow_cb()
@@ -3658,6 +3862,15 @@ sharkd_session_process_tap(char *buf, const jsmntok_t *tokens, int count)
             tap_data = expert_tap;
             tap_free = sharkd_session_free_tap_expert_cb;
         }
+        else if (!strcmp(tok_tap, "expert:aggregate"))
+        {
+            expert_info_index_t *expert_index = expert_info_index_new();
+
+            tap_error = register_tap_listener("expert", expert_index, tap_filter, 0, sharkd_session_reset_tap_expert_aggregate_cb, sharkd_session_packet_tap_expert_aggregate_cb, sharkd_session_process_tap_expert_aggregate_cb, NULL);
+
+            tap_data = expert_index;
+            tap_free = sharkd_session_free_tap_expert_aggregate_cb;
+        }
         else if (!strncmp(tok_tap, "seqa:", 5))
         {
             seq_analysis_info_t *graph_analysis;
@@ -4091,7 +4304,8 @@ sharkd_session_process_tap(char *buf, const jsmntok_t *tokens, int count)
  * Input:
  *   (m) follow     - follow protocol request (e.g. HTTP)
  *   (m) filter     - filter request (e.g. tcp.stream == 1)
- *   (m) stream     - stream index number
+ *   (o) stream     - stream index number; if given, only the frames of this
+ *                    stream are dissected (when the follower indexes its streams)
  *   (o) sub_stream - follow sub-stream index number (e.g. for HTTP/2 and QUIC streams)
  *
  * Output object with attributes:
@@ -4113,6 +4327,7 @@ sharkd_session_process_follow(char *buf, const jsmntok_t *tokens, int count)
 {
     const char *tok_follow = json_find_attr(buf, tokens, count, "follow");
     const char *tok_filter = json_find_attr(buf, tokens, count, "filter");
+    const char *tok_stream = json_find_attr(buf, tokens, count, "stream");
     const char *tok_sub_stream = json_find_attr(buf, tokens, count, "sub_stream");
 
     register_follow_t *follower;
@@ -4155,7 +4370,19 @@ sharkd_session_process_follow(char *buf, const jsmntok_t *tokens, int count)
         return;
     }
 
-    sharkd_retap();
+    /* The filter is still applied, but with a stream index only the frames
+     * of the stream need to be dissected. */
+    follow_stream_frames_func stream_frames = get_follow_stream_frames_func(follower);
+    const uint32_t *frames = NULL;
+    unsigned num_frames = 0;
+    uint32_t stream;
+    if (tok_stream && stream_frames && ws_strtou32(tok_stream, NULL, &stream))
+        frames = stream_frames(stream, &num_frames);
+
+    if (frames)
+        sharkd_retap_frames(frames, num_frames);
+    else
+        sharkd_retap();
 
     sharkd_json_result_prologue(rpcid);
 
@@ -6127,6 +6354,8 @@ sharkd_session_process(char *buf, const jsmntok_t *tokens, int count)
             sharkd_session_process_dumpconf(buf, tokens, count);
         else if (!strcmp(tok_method, "download"))
             sharkd_session_process_download(buf, tokens, count);
+        else if (!strcmp(tok_method, "dissector_profile"))
+            sharkd_session_process_dissector_profile(buf, tokens, count);
         else if (!strcmp(tok_method, "bye"))
         {
             sharkd_json_simple_ok(rpcid);
@@ -182,6 +182,7 @@ def features(cmd_tshark, make_env):
         have_x64='Compiler info: 64-bit' in tshark_v,
         have_lua='+Lua' in tshark_v,
         have_lua_unicode='(with UfW patches)' in tshark_v,
+        have_maxminddb='+MaxMind' in tshark_v,
         have_nghttp2='+nghttp2' in tshark_v,
         have_nghttp3='+nghttp3' in tshark_v,
         have_kerberos='+Kerberos' in tshark_v,
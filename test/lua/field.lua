@@ -9,8 +9,8 @@ local OTHER = "other"
 local n_frames = 1
 testlib.init({
     [FRAME] = n_frames,
-    [PER_FRAME] = n_frames*43,
-    [OTHER] = 16,
+    [PER_FRAME] = n_frames*50,
+    [OTHER] = 17,
 })
 
 ------------- helper funcs ------------
@@ -62,6 +62,7 @@ local f_udp_srcport = Field.new("udp.srcport")
 local f_udp_dstport = Field.new("udp.dstport")
 local f_dhcp_hw    = Field.new("dhcp.hw.mac_addr")
 local f_dhcp_opt   = Field.new("dhcp.option.type")
+local f_tcp_srcport = Field.new("tcp.srcport")
 
 testlib.test(OTHER,"Field__tostring-1", tostring(f_frame_proto) == "frame.protocols")
 
@@ -79,6 +80,7 @@ testlib.test(OTHER,"Field.type-5", f_dhcp_opt.type == ftypes.UINT8)
 
 -- make sure can't create a FieldInfo outside tap
 testlib.test(OTHER,"Field__call-1",not pcall(makeFieldInfo,f_eth_src))
+testlib.test(OTHER,"Field.values-1",not pcall(Field.values,f_eth_src))
 
 local tap = Listener.new()
 
@@ -157,6 +159,18 @@ function tap.packet(pinfo,tvb)
     testlib.test(PER_FRAME,"FieldInfo.len-1", fi_eth_src.len == 6)
     testlib.test(PER_FRAME,"FieldInfo.len-2",not pcall(setFieldInfo,fi_eth_src,"len",6))
 
+    testlib.testing(FRAME,"Field.values")
+
+    local v_udp_srcport, v_eth_src, v_frame_proto, v_tcp_srcport =
+        Field.values(f_udp_srcport, f_eth_src, f_frame_proto, f_tcp_srcport)
+    testlib.test(PER_FRAME,"Field.values-2", math.type == nil or math.type(v_udp_srcport) == "integer")
+    testlib.test(PER_FRAME,"Field.values-3", v_udp_srcport == finfo_udp_srcport.value)
+    testlib.test(PER_FRAME,"Field.values-4", v_eth_src == tostring(fi_eth_src))
+    testlib.test(PER_FRAME,"Field.values-5", v_frame_proto == f_frame_proto().value)
+    testlib.test(PER_FRAME,"Field.values-6", v_tcp_srcport == nil)
+    testlib.test(PER_FRAME,"Field.values-7", select('#', Field.values(f_tcp_srcport, f_udp_dstport)) == 2)
+    testlib.test(PER_FRAME,"Field.values-8",not pcall(Field.values))
+
     testlib.pass(FRAME)
 end
 
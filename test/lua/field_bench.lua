@@ -0,0 +1,84 @@
+----------------------------------------
+-- Compares the cost of reading several field values per packet through the
+-- Field extractors (one FieldInfo per value) with Field.values() (plain
+-- values, one call).
+-- Use with dns_port.pcap (or any UDP capture) in the test/captures directory.
+-- The first script argument is the number of times each packet's fields are
+-- read with each API (default 1000).
+
+local testlib = require("testlib")
+
+local FRAME = "frame"
+local OTHER = "other"
+
+-- The number of frames depends on the capture; only check the results.
+testlib.init({
+    [FRAME] = 0,
+    [OTHER] = 1,
+})
+
+local arg = {...}
+local iterations = tonumber(arg[1]) or 1000
+
+local fields = {
+    Field.new("frame.number"),
+    Field.new("frame.len"),
+    Field.new("ip.src"),
+    Field.new("ip.dst"),
+    Field.new("udp.srcport"),
+    Field.new("udp.dstport"),
+}
+local f1, f2, f3, f4, f5, f6 = table.unpack and table.unpack(fields) or unpack(fields)
+
+local per_field_time = 0
+local batch_time = 0
+local mismatches = 0
+
+local function plain(fi)
+    if fi == nil then
+        return nil
+    end
+    local value = fi.value
+    if type(value) == "number" or type(value) == "string" then
+        return value
+    end
+    return tostring(fi)
+end
+
+local tap = Listener.new("frame")
+
+function tap.packet(pinfo, tvb)
+    testlib.countPacket(FRAME)
+
+    local start = os.clock()
+    local a, b, c, d, e, f
+    for _ = 1, iterations do
+        a, b, c, d, e, f = f1(), f2(), f3(), f4(), f5(), f6()
+    end
+    per_field_time = per_field_time + (os.clock() - start)
+
+    start = os.clock()
+    local va, vb, vc, vd, ve, vf
+    for _ = 1, iterations do
+        va, vb, vc, vd, ve, vf = Field.values(f1, f2, f3, f4, f5, f6)
+    end
+    batch_time = batch_time + (os.clock() - start)
+
+    if plain(a) ~= va or plain(b) ~= vb or plain(c) ~= vc or
+       plain(d) ~= vd or plain(e) ~= ve or plain(f) ~= vf then
+        mismatches = mismatches + 1
+    end
+end
+
+function tap.draw()
+    local packets = testlib.getPktCount(FRAME)
+    print(string.format("%d packets, %d iterations per packet", packets, iterations))
+    print(string.format("Field extractors: %.3f s", per_field_time))
+    print(string.format("Field.values:     %.3f s", batch_time))
+    if batch_time > 0 then
+        print(string.format("Speedup:          %.2fx", per_field_time / batch_time))
+    end
+
+    testlib.test(OTHER, "Field.values-matches", mismatches == 0)
+    testlib.getResults()
+end
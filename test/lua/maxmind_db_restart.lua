@@ -0,0 +1,31 @@
+-- Replace a MaxMind database while dissecting, by turning geolocation off,
+-- swapping the file and turning it on again. Lookups after the swap must
+-- use the new file, not results cached from the old one.
+-- use with dhcp.pcap in test/captures directory
+--
+-- Args: the frame number to swap after, the path of the configured
+-- database, and the path of the database to replace it with.
+
+local args = { ... }
+local swap_after = tonumber(args[1])
+local db_path = args[2]
+local new_db_path = args[3]
+
+local restart = Proto("maxmind_db_restart", "MaxMind DB restart test")
+
+function restart.dissector(tvb, pinfo, tree)
+    if pinfo.visited or pinfo.number ~= swap_after then
+        return
+    end
+
+    set_preference("nameres.maxmind_geoip", false)
+    apply_preferences()
+
+    assert(os.remove(db_path))
+    assert(os.rename(new_db_path, db_path))
+
+    set_preference("nameres.maxmind_geoip", true)
+    apply_preferences()
+end
+
+register_postdissector(restart)
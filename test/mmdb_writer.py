@@ -0,0 +1,129 @@
+#
+# Wireshark tests
+#
+# SPDX-License-Identifier: GPL-2.0-or-later
+#
+'''Write small MaxMind DB (.mmdb) files for tests.
+
+See https://maxmind.github.io/MaxMind-DB/ for the format. Networks are
+stored in an IPv6 tree, with IPv4 networks in ::/96 as MaxMind does.
+'''
+
+import ipaddress
+import struct
+
+_TYPE_POINTER = 1
+_TYPE_STRING = 2
+_TYPE_DOUBLE = 3
+_TYPE_UINT16 = 5
+_TYPE_UINT32 = 6
+_TYPE_MAP = 7
+_TYPE_UINT64 = 9
+_TYPE_ARRAY = 11
+
+_METADATA_MARKER = b'\xab\xcd\xefMaxMind.com'
+
+
+def _ctrl(type_, size):
+    if type_ <= 7:
+        first, extended = type_ << 5, b''
+    else:
+        first, extended = 0, bytes([type_ - 7])
+    if size < 29:
+        first |= size
+        size_bytes = b''
+    elif size < 285:
+        first |= 29
+        size_bytes = bytes([size - 29])
+    elif size < 65821:
+        first |= 30
+        size_bytes = struct.pack('>H', size - 285)
+    else:
+        first |= 31
+        size_bytes = struct.pack('>I', size - 65821)[1:]
+    return bytes([first]) + extended + size_bytes
+
+
+def _uint(type_, value):
+    value_bytes = value.to_bytes(8, 'big').lstrip(b'\0')
+    return _ctrl(type_, len(value_bytes)) + value_bytes
+
+
+def encode(value):
+    '''Encode a str, int (as uint32), float (as double), list or dict.'''
+    if isinstance(value, str):
+        value_bytes = value.encode('utf-8')
+        return _ctrl(_TYPE_STRING, len(value_bytes)) + value_bytes
+    if isinstance(value, bool):
+        raise TypeError('booleans are not supported')
+    if isinstance(value, int):
+        return _uint(_TYPE_UINT32, value)
+    if isinstance(value, float):
+        return _ctrl(_TYPE_DOUBLE, 8) + struct.pack('>d', value)
+    if isinstance(value, list):
+        return _ctrl(_TYPE_ARRAY, len(value)) + b''.join(encode(v) for v in value)
+    if isinstance(value, dict):
+        return _ctrl(_TYPE_MAP, len(value)) + b''.join(encode(k) + encode(v) for k, v in value.items())
+    raise TypeError('unsupported type {}'.format(type(value)))
+
+
+def write_mmdb(path, database_type, networks, record_size=24):
+    '''Write a database. networks is a list of (network, record) pairs,
+    where network is a string such as "192.168.0.0/24" and record is
+    a dict. Networks must not overlap.'''
+    data = b''
+    tree = [[None, None]]
+    for network, record in networks:
+        net = ipaddress.ip_network(network)
+        if net.version == 4:
+            bits = int(net.network_address)
+            prefix_len = net.prefixlen + 96
+        else:
+            bits = int(net.network_address)
+            prefix_len = net.prefixlen
+        node = 0
+        for i in range(prefix_len):
+            bit = (bits >> (127 - i)) & 1
+            if i == prefix_len - 1:
+                tree[node][bit] = ('data', len(data))
+            else:
+                if tree[node][bit] is None:
+                    tree.append([None, None])
+                    tree[node][bit] = ('node', len(tree) - 1)
+                node = tree[node][bit][1]
+        data += encode(record)
+
+    node_count = len(tree)
+
+    def record_value(child):
+        if child is None:
+            return node_count
+        if child[0] == 'node':
+            return child[1]
+        return node_count + 16 + child[1]
+
+    tree_bytes = b''
+    for left, right in tree:
+        left, right = record_value(left), record_value(right)
+        if record_size == 24:
+            tree_bytes += left.to_bytes(3, 'big') + right.to_bytes(3, 'big')
+        elif record_size == 28:
+            tree_bytes += ((left & 0xffffff).to_bytes(3, 'big')
+                           + bytes([((left >> 24) << 4) | (right >> 24)])
+                           + (right & 0xffffff).to_bytes(3, 'big'))
+        else:
+            tree_bytes += left.to_bytes(4, 'big') + right.to_bytes(4, 'big')
+
+    metadata = (_ctrl(_TYPE_MAP, 9)
+        + encode('node_count') + _uint(_TYPE_UINT32, node_count)
+        + encode('record_size') + _uint(_TYPE_UINT16, record_size)
+        + encode('ip_version') + _uint(_TYPE_UINT16, 6)
+        + encode('database_type') + encode(database_type)
+        + encode('languages') + encode(['en'])
+        + encode('description') + encode({'en': database_type})
+        + encode('binary_format_major_version') + _uint(_TYPE_UINT16, 2)
+        + encode('binary_format_minor_version') + _uint(_TYPE_UINT16, 0)
+        + encode('build_epoch') + _uint(_TYPE_UINT64, 1700000000))
+
+    with open(path, 'wb') as f:
+        f.write(tree_bytes + b'\0' * 16 + data + _METADATA_MARKER + metadata)
@@ -315,6 +315,34 @@ class TestTsharkZExpert:
         assert not grep_output(proc.stdout, 'Chats')
 
 
+class TestTsharkZDissectorProfile:
+    def test_tshark_z_dissector_profile(self, cmd_tshark, capture_file, test_env):
+        proc = subprocesstest.run((cmd_tshark, '-q', '-z', 'dissector_profile',
+            '-r', capture_file('http.pcap')), capture_output=True, env=test_env)
+        assert grep_output(proc.stdout, 'Dissector Profile')
+        rows = {}
+        for line in proc.stdout.splitlines():
+            fields = line.split()
+            if len(fields) == 7 and fields[1].isdigit():
+                rows[fields[0]] = fields
+        # One packet, dissected once.
+        assert rows['frame'][1] == '1'
+        assert 'http' in rows
+
+    def test_tshark_z_dissector_profile_bad(self, cmd_tshark, capture_file, test_env):
+        proc = subprocesstest.run((cmd_tshark, '-q', '-z', 'dissector_profile,tcp',
+            '-r', capture_file('http.pcap')), capture_output=True, env=test_env)
+        assert proc.returncode != 0
+
+
+class TestTsharkZMemory:
+    def test_tshark_z_memory_proto(self, cmd_tshark, capture_file, test_env):
+        proc = subprocesstest.run((cmd_tshark, '-q', '-z', 'memory,proto',
+            '-r', capture_file('http.pcap')), capture_output=True, env=test_env)
+        assert grep_output(proc.stdout, 'File Scope Memory by Protocol')
+        assert grep_output(proc.stdout, r'^tcp\s+[1-9]')
+
+
 class TestTsharkExtcap:
     # dumpcap dependency has been added to run this test only with capture support
     def test_tshark_extcap_interfaces(self, cmd_tshark, cmd_dumpcap, test_env, home_path):
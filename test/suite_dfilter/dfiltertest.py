@@ -6,6 +6,7 @@ import subprocesstest
 from subprocesstest import count_output, grep_output
 import pytest
 import logging
+import re
 
 
 @pytest.fixture
@@ -98,6 +99,61 @@ def checkDFilterCount(dfilter_cmd, dfilter_env):
         assert count_output(proc.stdout) == expected_count
     return checkDFilterCount_real
 
+@pytest.fixture
+def checkDFilterPrefilter(dfilter_cmd, dfilter_env):
+    def checkDFilterPrefilter_real(dfilter, expected_count, rejects=True, disabled_protos=()):
+        """Run a display filter with and without --prefilter and expect the same output.
+
+        The packet details include frame.time_relative and frame.time_delta,
+        which depend on the packets the prefilter skipped. If rejects is
+        true, the prefilter must have skipped at least one packet.
+        Packets on TCP and UDP ports with an enabled dissector are never
+        skipped, so tests that expect rejects can disable those protocols.
+        """
+        outputs = []
+        base_args = ["-V"]
+        for proto in disabled_protos:
+            base_args += ["--disable-protocol", proto]
+        for extra_args in ([], ["--prefilter"]):
+            proc = subprocesstest.check_run(dfilter_cmd(dfilter) + base_args + extra_args,
+                                            capture_output=True,
+                                            universal_newlines=True,
+                                            env=dfilter_env)
+            if proc.stderr:
+                logging.debug(proc.stderr)
+            outputs.append(proc.stdout)
+        assert outputs[0] == outputs[1]
+        assert len(re.findall(r'^Frame \d+:', outputs[0], re.MULTILINE)) == expected_count
+        skipped = re.search(r'^(\d+) packets? skipped by --prefilter$', proc.stderr, re.MULTILINE)
+        assert skipped
+        if rejects:
+            assert int(skipped.group(1)) > 0
+        else:
+            assert int(skipped.group(1)) == 0
+    return checkDFilterPrefilter_real
+
+@pytest.fixture
+def checkDFilterDepthLimit(cmd_tshark, dfilter_cmd, dfilter_env, result_file):
+    def checkDFilterDepthLimit_real(dfilter, expected_count):
+        """Write the packets matching a display filter with and without --depth-limit and expect the same packets."""
+        frames = []
+        for extra_args in ([], ["--depth-limit"]):
+            out_file = result_file("depth-limit{}.pcapng".format(len(frames)))
+            proc = subprocesstest.check_run(dfilter_cmd(dfilter) + ["-w", out_file] + extra_args,
+                                            capture_output=True,
+                                            universal_newlines=True,
+                                            env=dfilter_env)
+            if extra_args:
+                assert "skipped by --depth-limit" in proc.stderr
+            proc = subprocesstest.check_run((cmd_tshark, "-r", out_file, "-T", "fields", "-e", "frame.time_epoch"),
+                                            capture_output=True,
+                                            universal_newlines=True,
+                                            env=dfilter_env)
+            frames.append(proc.stdout.split())
+        assert frames[0] == frames[1]
+        assert len(frames[0]) == expected_count
+    return checkDFilterDepthLimit_real
+
 @pytest.fixture
 def checkDFilterCountWithSelectedFrame(dfilter_cmd, dfilter_env):
     def checkDFilterCount_real(dfilter, expected_count, selected_frame, prefs=None):
@@ -0,0 +1,55 @@
+# SPDX-License-Identifier: GPL-2.0-or-later
+
+import pytest
+from suite_dfilter.dfiltertest import *
+
+
+class TestDfilterDepthLimit:
+    trace_file = "dhcp.pcap"
+
+    def test_network_1(self, checkDFilterDepthLimit):
+        dfilter = "ip.src == 192.168.0.1"
+        checkDFilterDepthLimit(dfilter, 2)
+
+    def test_transport_1(self, checkDFilterDepthLimit):
+        dfilter = "udp && ip.src == 192.168.0.1"
+        checkDFilterDepthLimit(dfilter, 2)
+
+class TestDfilterDepthLimitTcp:
+    trace_file = "http.pcap"
+
+    def test_ports_1(self, checkDFilterDepthLimit):
+        # TCP is referenced, so the HTTP it calls is still dissected.
+        dfilter = "tcp.port in {80, 3267}"
+        checkDFilterDepthLimit(dfilter, 1)
+
+class TestDfilterDepthLimitTcpPdus:
+    # Two HTTP requests over three segments; the second one starts in
+    # the segment that completes the first.
+    trace_file = "http-pipelined-segments.pcap"
+
+    def test_reassembly_1(self, checkDFilterDepthLimit):
+        # TCP calls HTTP again for the second request after HTTP has
+        # been added to the layers; it must not be skipped.
+        dfilter = "tcp.reassembled.length"
+        checkDFilterDepthLimit(dfilter, 2)
+
+class TestDfilterDepthLimitTunnel:
+    trace_file = "ipoipoip.pcap"
+
+    def test_inner_1(self, checkDFilterDepthLimit):
+        # Referenced protocols are always dissected, however deep.
+        dfilter = "ip.dst == 9.9.9.9"
+        checkDFilterDepthLimit(dfilter, 1)
+
+class TestDfilterDepthLimitTrailer:
+    trace_file = "protohier-without-comments.pcapng"
+
+    def test_padding_1(self, checkDFilterDepthLimit):
+        # Ethertype adds Ethernet's padding once IP has set its length.
+        dfilter = "eth.padding"
+        checkDFilterDepthLimit(dfilter, 9)
+
+    def test_trailer_1(self, checkDFilterDepthLimit):
+        dfilter = "eth.padding || eth.trailer"
+        checkDFilterDepthLimit(dfilter, 9)
@@ -0,0 +1,102 @@
+# SPDX-License-Identifier: GPL-2.0-or-later
+
+import pytest
+from suite_dfilter.dfiltertest import *
+
+
+class TestDfilterPrefilterIpv4:
+    # Packets on a port with a dissector can't be rejected, so the tests
+    # that expect rejects disable it.
+    trace_file = "dhcp.pcap"
+
+    def test_eq_1(self, checkDFilterPrefilter):
+        dfilter = "ip.src == 192.168.0.1"
+        checkDFilterPrefilter(dfilter, 2, disabled_protos=("dhcp",))
+
+    def test_eq_2(self, checkDFilterPrefilter):
+        dfilter = "ip.addr == 10.0.0.1"
+        checkDFilterPrefilter(dfilter, 0, disabled_protos=("dhcp",))
+
+    def test_ne_1(self, checkDFilterPrefilter):
+        dfilter = "ip.dst != 255.255.255.255"
+        checkDFilterPrefilter(dfilter, 2, disabled_protos=("dhcp",))
+
+    def test_subnet_1(self, checkDFilterPrefilter):
+        dfilter = "ip.addr == 192.168.0.0/16 && udp.srcport == 67"
+        checkDFilterPrefilter(dfilter, 2, disabled_protos=("dhcp",))
+
+    def test_subnet_2(self, checkDFilterPrefilter):
+        dfilter = "ip.src == 10.0.0.0/8 || udp.dstport > 67"
+        checkDFilterPrefilter(dfilter, 2, disabled_protos=("dhcp",))
+
+    def test_not_1(self, checkDFilterPrefilter):
+        dfilter = "!(ip.src == 192.168.0.1) && eth.type == 0x0800"
+        checkDFilterPrefilter(dfilter, 2, disabled_protos=("dhcp",))
+
+    def test_absent_1(self, checkDFilterPrefilter):
+        dfilter = "tcp.port == 67 || ipv6"
+        checkDFilterPrefilter(dfilter, 0, disabled_protos=("dhcp",))
+
+class TestDfilterPrefilterPorts:
+    trace_file = "http.pcap"
+
+    def test_membership_1(self, checkDFilterPrefilter):
+        dfilter = "tcp.port in {80, 3267}"
+        checkDFilterPrefilter(dfilter, 1, rejects=False)
+
+    def test_membership_2(self, checkDFilterPrefilter):
+        dfilter = "tcp.port in {81..3266}"
+        checkDFilterPrefilter(dfilter, 0, disabled_protos=("http",))
+
+    def test_and_1(self, checkDFilterPrefilter):
+        dfilter = "tcp.port == 80 && !udp"
+        checkDFilterPrefilter(dfilter, 1, rejects=False)
+
+    def test_unknown_1(self, checkDFilterPrefilter):
+        # The prefilter can't decide http, but it can reject on udp.port.
+        dfilter = "udp.port == 80 && http"
+        checkDFilterPrefilter(dfilter, 0, disabled_protos=("http",))
+
+class TestDfilterPrefilterIpv6:
+    trace_file = "ipv6.pcap"
+
+    def test_eq_1(self, checkDFilterPrefilter):
+        dfilter = "ipv6.dst == ff05::9999"
+        checkDFilterPrefilter(dfilter, 1, rejects=False)
+
+    def test_ne_1(self, checkDFilterPrefilter):
+        # The hop-by-hop options header keeps the prefilter from
+        # knowing every ipv6.dst.
+        dfilter = "ipv6.dst != ff05::9999"
+        checkDFilterPrefilter(dfilter, 0, rejects=False)
+
+class TestDfilterPrefilterTunnel:
+    trace_file = "ipoipoip.pcap"
+
+    def test_inner_1(self, checkDFilterPrefilter):
+        # The inner headers are only seen by the dissectors.
+        dfilter = "ip.dst == 9.9.9.9"
+        checkDFilterPrefilter(dfilter, 1, rejects=False)
+
+    def test_all_1(self, checkDFilterPrefilter):
+        dfilter = "all ip.addr != 9.9.9.9"
+        checkDFilterPrefilter(dfilter, 1, rejects=False)
+
+    def test_xor_1(self, checkDFilterPrefilter):
+        dfilter = "ip.src == 7.7.7.7 xor ip.dst == 7.7.7.7"
+        checkDFilterPrefilter(dfilter, 1)
+
+class TestDfilterPrefilterUdpTunnel:
+    # An IPv4 packet inside VXLAN-GPE on UDP port 4790, and a UDP packet
+    # between ports without a dissector.
+    trace_file = "vxlan-gpe-ipv4.pcap"
+
+    def test_inner_1(self, checkDFilterPrefilter):
+        # Only the second packet can be rejected.
+        dfilter = "ip.dst == 9.9.9.9"
+        checkDFilterPrefilter(dfilter, 1)
+
+    def test_disabled_1(self, checkDFilterPrefilter):
+        # With VXLAN disabled, the first packet is complete too.
+        dfilter = "ip.dst == 9.9.9.9"
+        checkDFilterPrefilter(dfilter, 0, disabled_protos=("vxlan",))
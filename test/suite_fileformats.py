@@ -106,6 +106,21 @@ class TestFileFormatsPcapng:
             encoding='utf-8', env=test_env)
         assert capture_stdout == fileformats_baseline_str
 
+    def test_pcapng_add_comment(self, cmd_editcap, cmd_tshark, capture_file, result_file, test_env):
+        '''Add a comment to a packet that has no options'''
+        outfile = result_file('dhcp-comment.pcapng')
+        subprocess.run((cmd_editcap,
+                '-a', '2:Added comment',
+                capture_file('dhcp.pcapng'), outfile
+            ), check=True, env=test_env)
+        capture_stdout = subprocess.check_output((cmd_tshark,
+                '-r', outfile,
+                '-Tfields',
+                '-e', 'frame.number', '-e', 'frame.comment',
+                ),
+            encoding='utf-8', env=test_env)
+        assert capture_stdout.splitlines() == ['1\t', '2\tAdded comment', '3\t', '4\t']
+
 @pytest.fixture
 def check_pcapng_dsb_fields(request, cmd_tshark):
     '''Factory that checks whether the DSB within the capture file matches.'''
@@ -11,6 +11,8 @@
 import os.path
 import shutil
 import subprocess
+import types
+from mmdb_writer import write_mmdb
 from subprocesstest import grep_output
 import pytest
 
@@ -104,3 +106,108 @@ class TestNameResolution:
                 ), encoding='utf-8', env=base_env)
         assert '174.137.42.65\twww.wireshark.org' not in stdout
         assert 'fe80::6233:4bff:fe13:c558\tCrunch.local' in stdout
+
+
+# Source address fields and the mmdbresolve keys they come from.
+geoip_src_fields = {
+    'ip.geoip.src_country_iso': 'country.iso_code',
+    'ip.geoip.src_country': 'country.names.en',
+    'ip.geoip.src_city': 'city.names.en',
+    'ip.geoip.src_asnum': 'autonomous_system_number',
+    'ip.geoip.src_org': 'autonomous_system_organization',
+    'ip.geoip.src_lat': 'location.latitude',
+    'ip.geoip.src_lon': 'location.longitude',
+}
+
+def city_record(city):
+    return {
+        'country': {'iso_code': 'DE', 'names': {'en': 'Germany'}},
+        'city': {'names': {'en': city}},
+        'location': {'latitude': 52.5, 'longitude': 13.4, 'accuracy_radius': 100},
+    }
+
+@pytest.fixture
+def maxmind_dbs(features, conf_path):
+    '''A city database and an ASN database in two configured directories.'''
+    if not features.have_maxminddb:
+        pytest.skip('Test requires MaxMind DB support.')
+    city_dir = os.path.join(conf_path, 'geoip_city')
+    asn_dir = os.path.join(conf_path, 'geoip_asn')
+    os.makedirs(city_dir)
+    os.makedirs(asn_dir)
+    city_db = os.path.join(city_dir, 'city.mmdb')
+    asn_db = os.path.join(asn_dir, 'asn.mmdb')
+    write_mmdb(city_db, 'GeoLite2-City', [('192.168.0.0/24', city_record('Berlin'))])
+    # Overlaps the city database. Values from the later database win.
+    write_mmdb(asn_db, 'GeoLite2-ASN', [('192.168.0.0/16', {
+        'autonomous_system_number': 64512,
+        'autonomous_system_organization': 'Example Org',
+        'country': {'names': {'en': 'Deutschland'}},
+    })], record_size=28)
+    with open(os.path.join(conf_path, 'maxmind_db_paths'), 'w') as f:
+        for db_dir in (city_dir, asn_dir):
+            # uat.c replaces backslashes...
+            f.write('"{}"\n'.format(db_dir.replace('\\', '\\x5c').replace('"', '\\x22')))
+    # Replacement for the city database, outside the directories we scan.
+    new_city_db = os.path.join(conf_path, 'new_city.mmdb')
+    write_mmdb(new_city_db, 'GeoLite2-City', [('192.168.0.0/24', city_record('Hamburg'))], record_size=32)
+    return types.SimpleNamespace(city_db=city_db, asn_db=asn_db, new_city_db=new_city_db)
+
+
+class TestMaxMindDb:
+
+    def test_geoip_fields(self, cmd_tshark, program, capture_file, maxmind_dbs, base_env):
+        '''In-process lookups match mmdbresolve when several databases are configured.'''
+        tshark_cmd = [cmd_tshark,
+            '-r', capture_file('dhcp.pcap'),
+            '-o', 'nameres.maxmind_geoip:TRUE',
+            '-Y', 'frame.number == 2',
+            '-T', 'fields',
+            '-E', 'separator=|',
+        ]
+        for field in geoip_src_fields:
+            tshark_cmd += ['-e', field]
+        stdout = subprocess.check_output(tshark_cmd, encoding='utf-8', env=base_env)
+        tshark_values = dict(zip(geoip_src_fields, stdout.rstrip('\r\n').split('|')))
+        assert tshark_values == {
+            'ip.geoip.src_country_iso': 'DE',
+            'ip.geoip.src_country': 'Deutschland',
+            'ip.geoip.src_city': 'Berlin',
+            'ip.geoip.src_asnum': '64512',
+            'ip.geoip.src_org': 'Example Org',
+            'ip.geoip.src_lat': '52.5',
+            'ip.geoip.src_lon': '13.4',
+        }
+
+        # mmdbresolve prints the values from each database in turn.
+        stdout = subprocess.check_output((program('mmdbresolve'),
+                '-f', maxmind_dbs.city_db,
+                '-f', maxmind_dbs.asn_db,
+            ), input='192.168.0.1\n', encoding='utf-8', env=base_env)
+        mmdbr_values = {}
+        for line in stdout.splitlines():
+            key, sep, value = line.partition(': ')
+            if sep and not key.startswith(('db.', 'mmdbresolve.')):
+                mmdbr_values[key] = value
+        for field, key in geoip_src_fields.items():
+            if field in ('ip.geoip.src_lat', 'ip.geoip.src_lon'):
+                assert float(tshark_values[field]) == pytest.approx(float(mmdbr_values[key]))
+            else:
+                assert tshark_values[field] == mmdbr_values[key]
+
+    def test_geoip_restart(self, cmd_tshark, features, dirs, capture_file, maxmind_dbs, base_env):
+        '''Restarting lookups forgets the results of the old databases.'''
+        if not features.have_lua:
+            pytest.skip('Test requires Lua scripting support.')
+        stdout = subprocess.check_output((cmd_tshark,
+                '-r', capture_file('dhcp.pcap'),
+                '-o', 'nameres.maxmind_geoip:TRUE',
+                '-X', 'lua_script:' + os.path.join(dirs.lua_dir, 'maxmind_db_restart.lua'),
+                '-X', 'lua_script1:2',
+                '-X', 'lua_script1:' + maxmind_dbs.city_db,
+                '-X', 'lua_script1:' + maxmind_dbs.new_city_db,
+                '-T', 'fields',
+                '-e', 'frame.number',
+                '-e', 'ip.geoip.src_city',
+            ), encoding='utf-8', env=base_env)
+        assert stdout.splitlines() == ['1\t', '2\tBerlin', '3\t', '4\tHamburg']
@@ -1243,6 +1243,71 @@ class TestSharkd:
             }}
         ))
 
+    def test_sharkd_req_tap_expert_aggregate(self, run_sharkd_session, capture_file):
+        outputs = run_sharkd_session([json.dumps(x) for x in (
+            {"jsonrpc":"2.0", "id":1, "method":"load",
+             "params":{"file": capture_file('http-ooo.pcap')}
+             },
+            {"jsonrpc":"2.0", "id":2, "method":"tap", "params":{"tap0": "expert", "tap1": "expert:aggregate"}},
+        )])
+        assert outputs[0] == {"jsonrpc":"2.0","id":1,"result":{"status":"OK"}}
+        expert, aggregate = outputs[1]["result"]["taps"]
+        assert expert["type"] == "expert"
+        assert aggregate["type"] == "expert-aggregate"
+        assert len(expert["details"]) > 0
+
+        # Every occurrence reported by the plain tap is in exactly one
+        # aggregated entry, and no entry is repeated.
+        def key(item):
+            return (item.get("s"), item.get("g"), item.get("p"), item["m"])
+        occurrences = sorted((key(item), item["f"]) for item in expert["details"])
+        aggregated = sorted((key(item), f) for item in aggregate["details"] for f in item["f"])
+        assert occurrences == aggregated
+        for item in aggregate["details"]:
+            assert item["c"] == len(item["f"])
+            assert item["f"] == sorted(item["f"])
+        assert len(aggregate["details"]) <= len(expert["details"])
+
+    def test_sharkd_req_dissector_profile(self, run_sharkd_session, capture_file):
+        outputs = run_sharkd_session([json.dumps(x) for x in (
+            {"jsonrpc":"2.0", "id":1, "method":"dissector_profile", "params":{"enable": True}},
+            {"jsonrpc":"2.0", "id":2, "method":"load",
+             "params":{"file": capture_file('dhcp.pcap')}
+             },
+            {"jsonrpc":"2.0", "id":3, "method":"dissector_profile", "params":{"enable": False}},
+            {"jsonrpc":"2.0", "id":4, "method":"dissector_profile", "params":{"reset": True}},
+        )])
+        assert outputs[0] == {"jsonrpc":"2.0","id":1,"result":{"enabled":True,"memory":False,"protocols":[]}}
+        assert outputs[1] == {"jsonrpc":"2.0","id":2,"result":{"status":"OK"}}
+        result = outputs[2]["result"]
+        assert result["enabled"] == False
+        protocols = {p["name"]: p for p in result["protocols"]}
+        # dhcp.pcap has four packets, each dissected once when loading.
+        assert protocols["frame"]["calls"] == 4
+        assert protocols["dhcp"]["calls"] == 4
+        for p in result["protocols"]:
+            assert p["exclusive_ns"] <= p["inclusive_ns"]
+        assert outputs[3] == {"jsonrpc":"2.0","id":4,"result":{"enabled":False,"memory":False,"protocols":[]}}
+
+    def test_sharkd_req_status_memory(self, run_sharkd_session, capture_file):
+        outputs = run_sharkd_session([json.dumps(x) for x in (
+            {"jsonrpc":"2.0", "id":1, "method":"dissector_profile", "params":{"memory": True}},
+            {"jsonrpc":"2.0", "id":2, "method":"load",
+             "params":{"file": capture_file('http.pcap')}
+             },
+            {"jsonrpc":"2.0", "id":3, "method":"status"},
+            {"jsonrpc":"2.0", "id":4, "method":"dissector_profile", "params":{"memory": False}},
+            {"jsonrpc":"2.0", "id":5, "method":"status"},
+        )])
+        assert outputs[0]["result"]["memory"] == True
+        assert outputs[1] == {"jsonrpc":"2.0","id":2,"result":{"status":"OK"}}
+        memory = {m["name"]: m for m in outputs[2]["result"]["memory"]}
+        # TCP keeps conversation and analysis state for the whole file.
+        assert memory["tcp"]["allocations"] > 0
+        assert memory["tcp"]["bytes"] > 0
+        assert outputs[3]["result"]["memory"] == False
+        assert "memory" not in outputs[4]["result"]
+
     def test_sharkd_req_follow_bad(self, check_sharkd_session, capture_file):
         # Unrecognized taps currently produce no output (not even err).
         check_sharkd_session((
@@ -1336,6 +1401,35 @@ class TestSharkd:
              },
         ))
 
+    def test_sharkd_req_follow_http2_stream(self, check_sharkd_session, capture_file, features):
+        # Same as test_sharkd_req_follow_http2, but only the frames of the
+        # indexed TCP stream are dissected.
+        if not features.have_nghttp2:
+            pytest.skip('Requires nghttp2.')
+        if not features.have_brotli:
+            pytest.skip('Requires brotli.')
+
+        check_sharkd_session((
+            {"jsonrpc":"2.0", "id":1, "method":"load",
+             "params":{"file": capture_file('quic-with-secrets.pcapng')}
+             },
+            {"jsonrpc":"2.0", "id":2, "method":"follow",
+             "params":{"follow": "HTTP2", "filter": "tcp.stream eq 0 and http2.streamid eq 1", "stream": 0, "sub_stream": 1}
+             },
+        ), (
+            {"jsonrpc":"2.0","id":1,"result":{"status":"OK"}},
+            {"jsonrpc":"2.0","id":2,
+             "result":{
+                 "shost": "2606:4700:10::6816:826", "sport": "443", "sbytes": 656,
+                 "chost": "2001:db8:1::1", "cport": "57098", "cbytes": 109643,
+                 "payloads": [
+                     {"n": 12, "d": MatchRegExp(r'^.*VuLVVTLGVuO3E9MC45Cgo.*$')},
+                     {"n": 19, "s": 1, "d": MatchRegExp(r'^.*7IG1hPTg2NDAwCgo.*$')},
+                     {"n": 44, "s": 1, "d": MatchRegExp(r'^.*Pgo8L2h0bWw.*$')},
+                 ]}
+             },
+        ))
+
     def test_sharkd_req_iograph_bad(self, check_sharkd_session, capture_file):
         check_sharkd_session((
             {"jsonrpc":"2.0", "id":1, "method":"load",
@@ -1521,6 +1615,25 @@ class TestSharkd:
             {"jsonrpc":"2.0","id":4,"result":{"comment":["foo\nbar"],"fol": MatchAny(list), "followers": MatchAny(list)}},
         ))
 
+    def test_sharkd_req_setcomment_pcapng(self, check_sharkd_session, capture_file):
+        # The Enhanced Packet Blocks in dhcp.pcapng have no options.
+        check_sharkd_session((
+            {"jsonrpc":"2.0", "id":1, "method":"load",
+            "params":{"file": capture_file('dhcp.pcapng')}
+            },
+            {"jsonrpc":"2.0", "id":2, "method":"setcomment",
+            "params":{"frame": 2, "comment": "foo"}
+            },
+            {"jsonrpc":"2.0", "id":3, "method":"frame",
+            "params":{"frame": 2}
+            },
+
+        ), (
+            {"jsonrpc":"2.0","id":1,"result":{"status":"OK"}},
+            {"jsonrpc":"2.0","id":2,"result":{"status":"OK"}},
+            {"jsonrpc":"2.0","id":3,"result":{"comment":["foo"],"fol": MatchAny(list), "followers": MatchAny(list)}},
+        ))
+
     def test_sharkd_req_setconf_bad(self, check_sharkd_session):
         check_sharkd_session((
             {"jsonrpc":"2.0", "id":1, "method":"setconf",
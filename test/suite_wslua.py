@@ -142,6 +142,38 @@ class TestWslua:
         '''wslua conversation dissector functions, mode 3'''
         check_lua_script_verify('dissector.lua', dns_port_pcap, conv_regmode=3)
 
+    def test_wslua_dissector_timing(self, check_lua_script):
+        '''-z lua,dissectors'''
+        tshark_proc = check_lua_script('dissector.lua', dns_port_pcap, False,
+            '-q', '-z', 'lua,dissectors')
+        assert 'Lua Dissector Timing' in tshark_proc.stdout
+        rows = {}
+        for line in tshark_proc.stdout.splitlines():
+            fields = line.split()
+            if len(fields) == 5 and fields[1].isdigit():
+                rows[fields[0]] = fields
+        # Only the protocol created by the script is shown, not the
+        # built-in ones it is called from.
+        assert list(rows) == ['mydns']
+        assert int(rows['mydns'][1]) > 0
+        assert float(rows['mydns'][4]) <= float(rows['mydns'][2]) * 1000
+
+    def test_wslua_dissector_timing_with_profile(self, check_lua_script):
+        '''-z lua,dissectors together with -z dissector_profile'''
+        tshark_proc = check_lua_script('dissector.lua', dns_port_pcap, False,
+            '-q', '-z', 'lua,dissectors', '-z', 'dissector_profile')
+        # Both taps share the profile; neither may reset or stop it
+        # for the other.
+        lua_calls = profile_calls = None
+        for line in tshark_proc.stdout.splitlines():
+            fields = line.split()
+            if len(fields) == 5 and fields[0] == 'mydns':
+                lua_calls = int(fields[1])
+            elif len(fields) == 7 and fields[0] == 'mydns':
+                profile_calls = int(fields[1])
+        assert lua_calls is not None and lua_calls > 0
+        assert profile_calls == lua_calls
+
     def test_wslua_dissector_fpm(self, check_lua_script):
         '''wslua dissector functions, fpm'''
         tshark_fpm_tcp_proc = check_lua_script('dissectFPM.lua', segmented_fpm_pcap, False,
@@ -170,6 +202,11 @@ class TestWslua:
         '''wslua fields'''
         check_lua_script('field.lua', dhcp_pcap, True, '-q', '-c1')
 
+    def test_wslua_field_bench(self, check_lua_script):
+        '''wslua Field.values compared with the Field extractors'''
+        check_lua_script('field_bench.lua', dns_port_pcap, True, '-q',
+            '-X', 'lua_script1:100')
+
     # reader, writer, and acme_reader were all under wslua_step_file_test
     # in the Bash version.
     def test_wslua_file_reader(self, check_lua_script, cmd_tshark, capture_file, test_env):
@@ -0,0 +1,121 @@
+#!/usr/bin/env python3
+#
+# Wireshark - Network traffic analyzer
+# By Gerald Combs <gerald@wireshark.org>
+# Copyright 1998 Gerald Combs
+#
+# SPDX-License-Identifier: GPL-2.0-or-later
+'''Time reading a large pcapng file with wiretap.
+
+Writes a pcapng file with the given number of small UDP packets in
+Enhanced Packet Blocks, optionally giving every Nth packet a flags
+option, and times how long capinfos takes to count its packets. This
+mostly measures the per-record cost of the pcapng reader.
+
+Example:
+    tools/bench-pcapng-read.py --capinfos build/run/capinfos
+    tools/bench-pcapng-read.py --packets 1000000 --options-every 10
+'''
+
+import argparse
+import os
+import shutil
+import struct
+import subprocess
+import sys
+import tempfile
+import time
+
+
+def ip_checksum(header):
+    total = sum(struct.unpack('!10H', header))
+    while total > 0xffff:
+        total = (total & 0xffff) + (total >> 16)
+    return ~total & 0xffff
+
+
+def udp_frame():
+    payload = b'benchmark payload'
+    udp = struct.pack('!HHHH', 5000, 5001, 8 + len(payload), 0) + payload
+    ip = struct.pack('!BBHHHBBH4s4s', 0x45, 0, 20 + len(udp), 0, 0, 64, 17, 0,
+                     bytes((192, 0, 2, 1)), bytes((192, 0, 2, 2)))
+    ip = ip[:10] + struct.pack('!H', ip_checksum(ip)) + ip[12:]
+    eth = bytes.fromhex('020000000002' '020000000001' '0800')
+    return eth + ip + udp
+
+
+def write_pcapng(path, packets, options_every):
+    frame = udp_frame()
+    padded = frame + b'\0' * (-len(frame) % 4)
+    flags_option = struct.pack('<HHI', 2, 4, 1) + struct.pack('<HH', 0, 0)
+    epb_len = 28 + len(padded) + 4
+    epb_opt_len = epb_len + len(flags_option)
+
+    with open(path, 'wb') as f:
+        # Section header block, then one Ethernet interface with
+        # microsecond time stamps.
+        f.write(struct.pack('<IIIHHqI', 0x0a0d0d0a, 28, 0x1a2b3c4d, 1, 0, -1, 28))
+        f.write(struct.pack('<IIHHII', 0x00000001, 20, 1, 0, 0, 20))
+
+        chunk = []
+        for n in range(packets):
+            ts = 1_700_000_000_000_000 + n
+            with_options = options_every > 0 and n % options_every == 0
+            block_len = epb_opt_len if with_options else epb_len
+            chunk.append(struct.pack('<IIIIIII', 0x00000006, block_len, 0,
+                                     ts >> 32, ts & 0xffffffff, len(frame), len(frame)))
+            chunk.append(padded)
+            if with_options:
+                chunk.append(flags_option)
+            chunk.append(struct.pack('<I', block_len))
+            if len(chunk) >= 40000:
+                f.write(b''.join(chunk))
+                chunk = []
+        f.write(b''.join(chunk))
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Time reading a large pcapng file.')
+    parser.add_argument('--packets', type=int, default=10_000_000,
+                        help='number of packets to write (default 10000000)')
+    parser.add_argument('--options-every', type=int, default=0, metavar='N',
+                        help='give every Nth packet a flags option (default none)')
+    parser.add_argument('--runs', type=int, default=3,
+                        help='number of timed runs (default 3)')
+    parser.add_argument('--capinfos', default=shutil.which('capinfos') or 'capinfos',
+                        help='capinfos executable to run')
+    parser.add_argument('--file', help='write the capture here and keep it')
+    args = parser.parse_args()
+    if args.packets < 1 or args.runs < 1:
+        parser.error('--packets and --runs must be at least 1')
+
+    if args.file:
+        path = args.file
+    else:
+        fd, path = tempfile.mkstemp(suffix='.pcapng')
+        os.close(fd)
+
+    try:
+        start = time.perf_counter()
+        write_pcapng(path, args.packets, args.options_every)
+        print(f'Wrote {args.packets} packets ({os.path.getsize(path)} bytes) '
+              f'in {time.perf_counter() - start:.1f} s')
+
+        best = None
+        for run in range(args.runs):
+            start = time.perf_counter()
+            subprocess.run((args.capinfos, '-c', '-M', path), check=True,
+                           stdout=subprocess.DEVNULL)
+            elapsed = time.perf_counter() - start
+            best = elapsed if best is None else min(best, elapsed)
+            print(f'Run {run + 1}: {elapsed:.3f} s')
+        print(f'Best: {best:.3f} s, {best / args.packets * 1e9:.0f} ns/packet')
+    finally:
+        if not args.file:
+            os.unlink(path)
+
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -142,6 +142,8 @@
 #define LONGOPT_PRINT_TIMERS            LONGOPT_BASE_APPLICATION+9
 #define LONGOPT_GLOBAL_PROFILE          LONGOPT_BASE_APPLICATION+10
 #define LONGOPT_COMPRESS                LONGOPT_BASE_APPLICATION+11
+#define LONGOPT_PREFILTER               LONGOPT_BASE_APPLICATION+12
+#define LONGOPT_DEPTH_LIMIT             LONGOPT_BASE_APPLICATION+13
 
 capture_file cfile;
 
@@ -264,6 +266,11 @@ static bool write_finale(void);
 static GHashTable *output_only_tables;
 
 static bool opt_print_timers;
+static bool opt_prefilter;
+static bool use_prefilter;     /* true if we skip dissecting packets the display filter's prefilter rejects */
+static uint64_t prefilter_rejected; /* number of packets the prefilter kept us from dissecting */
+static bool opt_depth_limit;
+static depth_limit_t *depth_limit; /* dissectors the display filter doesn't need are skipped, or NULL */
 struct elapsed_pass_s {
     int64_t dissect;
     int64_t dfilter_read;
@@ -488,6 +495,12 @@ print_usage(FILE *output)
     fprintf(output, "  -Y <display filter>, --display-filter <display filter>\n");
     fprintf(output, "                           packet displaY filter in Wireshark display filter\n");
     fprintf(output, "                           syntax\n");
+    fprintf(output, "  --prefilter              don't dissect packets that the display filter rejects\n");
+    fprintf(output, "                           from their address and port fields alone; see the\n");
+    fprintf(output, "                           man page for caveats\n");
+    fprintf(output, "  --depth-limit            don't call dissectors for protocols above those the\n");
+    fprintf(output, "                           display filter references; see the man page for\n");
+    fprintf(output, "                           caveats\n");
     fprintf(output, "  -n                       disable all name resolutions (def: \"mNd\" enabled, or\n");
     fprintf(output, "                           as set in preferences)\n");
     // Note: the order of the flags here matches the options in the settings dialog e.g. "dsN" only have an effect if "n" is set
@@ -989,6 +1002,31 @@ must_do_dissection(dfilter_t *rfcode, dfilter_t *dfcode,
         tap_listeners_require_dissection();
 }
 
+static bool
+can_use_prefilter(dfilter_t *dfcode, char *volatile pdu_export_arg)
+{
+    /* Packets rejected by the prefilter aren't dissected at all, so we
+       can only skip them if nothing but the display filter would have
+       looked at them: there's a single pass, and no taps or PDU export
+       want to see every packet. */
+    return opt_prefilter && dfilter_has_prefilter(dfcode) &&
+        !perform_two_pass_analysis && !pdu_export_arg &&
+        !tap_listeners_require_dissection();
+}
+
+static depth_limit_t *
+create_depth_limit(dfilter_t *dfcode, char *volatile pdu_export_arg)
+{
+    /* Skipped dissectors don't fill in the columns or the protocol
+       tree, so we can only skip them if nothing but the display filter
+       looks at the dissection. */
+    if (!opt_depth_limit || !dfcode || print_packet_info ||
+        perform_two_pass_analysis || pdu_export_arg ||
+        tap_listeners_require_dissection())
+        return NULL;
+    return depth_limit_new(dfcode);
+}
+
 #ifdef HAVE_LIBPCAP
 /*
  * Check whether a purported *shark packet-matching expression (display
@@ -1061,6 +1099,8 @@ main(int argc, char *argv[])
         {"print-timers", ws_no_argument, NULL, LONGOPT_PRINT_TIMERS},
         {"global-profile", ws_no_argument, NULL, LONGOPT_GLOBAL_PROFILE},
         {"compress", ws_required_argument, NULL, LONGOPT_COMPRESS},
+        {"prefilter", ws_no_argument, NULL, LONGOPT_PREFILTER},
+        {"depth-limit", ws_no_argument, NULL, LONGOPT_DEPTH_LIMIT},
         {0, 0, 0, 0}
     };
     bool                 arg_error = false;
@@ -1928,6 +1968,12 @@ main(int argc, char *argv[])
             case LONGOPT_PRINT_TIMERS:
                 opt_print_timers = true;
                 break;
+            case LONGOPT_PREFILTER:
+                opt_prefilter = true;
+                break;
+            case LONGOPT_DEPTH_LIMIT:
+                opt_depth_limit = true;
+                break;
             case LONGOPT_GLOBAL_PROFILE:
                 /* already processed; just ignore it now */
                 break;
@@ -2606,6 +2652,10 @@ main(int argc, char *argv[])
            starting the statistics taps. */
         do_dissection = must_do_dissection(rfcode, dfcode, pdu_export_arg);
         ws_debug("tshark: do_dissection = %s", do_dissection ? "TRUE" : "FALSE");
+        use_prefilter = can_use_prefilter(dfcode, pdu_export_arg);
+        ws_debug("tshark: use_prefilter = %s", use_prefilter ? "TRUE" : "FALSE");
+        depth_limit = create_depth_limit(dfcode, pdu_export_arg);
+        ws_debug("tshark: depth_limit = %s", depth_limit ? "TRUE" : "FALSE");
 
         /* Process the packets in the file */
         ws_debug("tshark: invoking process_cap_file() to process the packets");
@@ -2796,6 +2846,10 @@ main(int argc, char *argv[])
            starting the statistics taps. */
         do_dissection = must_do_dissection(rfcode, dfcode, pdu_export_arg);
         ws_debug("tshark: do_dissection = %s", do_dissection ? "TRUE" : "FALSE");
+        use_prefilter = can_use_prefilter(dfcode, pdu_export_arg);
+        ws_debug("tshark: use_prefilter = %s", use_prefilter ? "TRUE" : "FALSE");
+        depth_limit = create_depth_limit(dfcode, pdu_export_arg);
+        ws_debug("tshark: depth_limit = %s", depth_limit ? "TRUE" : "FALSE");
 
         /* We're doing live capture; if the capture child is writing to a pipe,
            we can't do dissection, because that would mean two readers for
@@ -2903,6 +2957,17 @@ main(int argc, char *argv[])
         }
     }
 
+    if (use_prefilter && !really_quiet) {
+        fprintf(stderr, "%" PRIu64 " packet%s skipped by --prefilter\n",
+                prefilter_rejected, plurality(prefilter_rejected, "", "s"));
+    }
+
+    if (depth_limit && !really_quiet) {
+        uint64_t skipped = depth_limit_get_skipped(depth_limit);
+        fprintf(stderr, "%" PRIu64 " dissector call%s skipped by --depth-limit\n",
+                skipped, plurality(skipped, "", "s"));
+    }
+
     /* Memory cleanup */
     reset_tap_listeners();
     funnel_dump_all_text_windows();
@@ -2927,6 +2992,7 @@ clean_exit:
     col_cleanup(&cfile.cinfo);
     wtap_cleanup();
     free_progdirs();
+    depth_limit_free(depth_limit);
     dfilter_free(dfcode);
     g_free(dfilter);
     return exit_status;
@@ -2943,6 +3009,7 @@ tshark_epan_new(capture_file *cf)
         cap_file_provider_get_interface_name,
         cap_file_provider_get_interface_description,
         NULL,
+        cap_file_provider_add_dependent_frame,
     };
 
     return epan_new(&cf->provider, &funcs);
@@ -3466,6 +3533,8 @@ process_packet_first_pass(capture_file *cf, epan_dissect_t *edt,
         /* If we're applying a filter that needs the columns, construct them. */
         if (dfilter_requires_columns(cf->rfcode) || dfilter_requires_columns(cf->dfcode)) {
             cinfo = &cf->cinfo;
+            /* Only the columns used by the filters have to be formatted. */
+            cinfo->only_referenced = true;
         }
 
         elapsed_start = g_get_monotonic_time();
@@ -3485,15 +3554,15 @@ process_packet_first_pass(capture_file *cf, epan_dissect_t *edt,
         cf->provider.prev_cap = cf->provider.prev_dis = frame_data_sequence_add(cf->provider.frames, &fdlocal);
 
         /* If we're not doing dissection then there won't be any dependent frames.
-         * More importantly, edt.pi.fd.dependent_frames won't be initialized because
+         * More importantly, the dependent frames won't be initialized because
          * epan hasn't been initialized.
          * if we *are* doing dissection, then mark the dependent frames, but only
          * if a display filter was given and it matches this packet.
          */
         if (edt && cf->dfcode) {
             elapsed_start = g_get_monotonic_time();
-            if (dfilter_apply_edt(cf->dfcode, edt) && edt->pi.fd->dependent_frames) {
-                g_hash_table_foreach(edt->pi.fd->dependent_frames, find_and_mark_frame_depended_upon, cf->provider.frames);
+            if (dfilter_apply_edt(cf->dfcode, edt) && edt->pi.fd->has_dependent_frames) {
+                g_hash_table_foreach(frame_data_sequence_get_dependent_frames(cf->provider.frames, edt->pi.fd), find_and_mark_frame_depended_upon, cf->provider.frames);
             }
 
             if (selected_frame_number != 0 && selected_frame_number == cf->count + 1) {
@@ -3699,9 +3768,12 @@ process_packet_second_pass(capture_file *cf, epan_dissect_t *edt,
            or
            3) there is a column mapped to an individual field
            */
-        if ((tap_listeners_require_columns()) || (print_packet_info && print_summary) || output_fields_has_cols(output_fields) || dfilter_requires_columns(cf->dfcode))
+        if ((tap_listeners_require_columns()) || (print_packet_info && print_summary) || output_fields_has_cols(output_fields) || dfilter_requires_columns(cf->dfcode)) {
             cinfo = &cf->cinfo;
-        else
+            /* If only filters or output fields look at the columns, don't
+               bother formatting the ones they don't reference. */
+            cinfo->only_referenced = !tap_listeners_require_columns() && !(print_packet_info && print_summary);
+        } else
             cinfo = NULL;
 
         frame_data_set_before_dissect(fdata, &cf->elapsed_time,
@@ -4355,6 +4427,26 @@ process_packet_single_pass(capture_file *cf, epan_dissect_t *edt, int64_t offset
 
     frame_data_init(&fdata, cf->count, rec, offset, cum_bytes);
 
+    /* If the display filter can tell from the raw bytes alone that
+       this packet won't match, don't bother dissecting it. */
+    if (edt && use_prefilter && rec->rec_type == REC_TYPE_PACKET &&
+            dfilter_prefilter_rejects(cf->dfcode, rec->rec_header.packet_header.pkt_encap,
+                ws_buffer_start_ptr(&rec->data), rec->rec_header.packet_header.caplen)) {
+        /* The reference and elapsed time still have to advance as if
+           the frame had been dissected, or frame.time_relative and
+           frame.time_delta of later frames would be wrong. */
+        frame_data_set_before_dissect(&fdata, &cf->elapsed_time,
+                &cf->provider.ref, cf->provider.prev_dis);
+        if (cf->provider.ref == &fdata) {
+            ref_frame = fdata;
+            cf->provider.ref = &ref_frame;
+        }
+        prefilter_rejected++;
+        prev_cap_frame = fdata;
+        cf->provider.prev_cap = &prev_cap_frame;
+        return false;
+    }
+
     /* If we're going to print packet information, or we're going to
        run a read filter, or we're going to process taps, set up to
        do a dissection and do so.  (This is the one and only pass
@@ -4366,6 +4458,9 @@ process_packet_single_pass(capture_file *cf, epan_dissect_t *edt, int64_t offset
         if (cf->dfcode)
             epan_dissect_prime_with_dfilter(edt, cf->dfcode);
 
+        if (depth_limit)
+            epan_dissect_set_depth_limit(edt, depth_limit);
+
         col_custom_prime_edt(edt, &cf->cinfo);
 
         output_fields_prime_edt(edt, output_fields);
@@ -4384,9 +4479,12 @@ process_packet_single_pass(capture_file *cf, epan_dissect_t *edt, int64_t offset
            mode, we print the protocol tree, not the protocol summary.
            or
            3) there is a column mapped as an individual field */
-        if ((tap_listeners_require_columns()) || (print_packet_info && print_summary) || output_fields_has_cols(output_fields) || dfilter_requires_columns(cf->dfcode))
+        if ((tap_listeners_require_columns()) || (print_packet_info && print_summary) || output_fields_has_cols(output_fields) || dfilter_requires_columns(cf->dfcode)) {
             cinfo = &cf->cinfo;
-        else
+            /* If only filters or output fields look at the columns, don't
+               bother formatting the ones they don't reference. */
+            cinfo->only_referenced = !tap_listeners_require_columns() && !(print_packet_info && print_summary);
+        } else
             cinfo = NULL;
 
         frame_data_set_before_dissect(&fdata, &cf->elapsed_time,
@@ -181,6 +181,11 @@ capture_start(capture_options *capture_opts, GPtrArray *capture_comments,
         cap_data->counts.total = 0;
 
         cap_data->ui.counts = &cap_data->counts;
+        cap_data->ui.read_load = 0;
+        cap_data->ui.max_read_load = 0;
+        cap_data->ui.pending = 0;
+        cap_data->ui.read_time = 0;
+        cap_data->ui.interval_start = 0;
 
         capture_info_ui_create(&cap_data->ui, cap_session);
     }
@@ -539,11 +544,47 @@ capture_info_new_packets(int to_read, wtap *wth, info_data_t* cap_info)
     capture_info_ui_update(&cap_info->ui);
 }
 
+/* Interval over which the read load is measured */
+#define CAPTURE_READ_LOAD_INTERVAL G_USEC_PER_SEC
+
+void
+capture_info_update_read_load(capture_info *cinfo)
+{
+    int64_t now = g_get_monotonic_time();
+    int64_t elapsed;
+
+    if (cinfo->interval_start == 0) {
+        return;
+    }
+
+    elapsed = now - cinfo->interval_start;
+    if (elapsed >= CAPTURE_READ_LOAD_INTERVAL) {
+        cinfo->read_load = (unsigned)MIN(cinfo->read_time * 100 / elapsed, 100);
+        cinfo->max_read_load = MAX(cinfo->max_read_load, cinfo->read_load);
+        cinfo->read_time = 0;
+        cinfo->interval_start = now;
+    }
+}
+
+/* Count the time from read_start until now as spent reading new packets */
+static void
+capture_info_add_read_time(capture_info *cinfo, int64_t read_start, uint32_t pending)
+{
+    cinfo->pending = pending;
+    if (cinfo->interval_start == 0) {
+        cinfo->interval_start = read_start;
+    }
+    cinfo->read_time += g_get_monotonic_time() - read_start;
+
+    capture_info_update_read_load(cinfo);
+}
+
 /* capture child tells us we have new packets to read */
 static void
 capture_input_new_packets(capture_session *cap_session, int to_read)
 {
     capture_options *capture_opts = cap_session->capture_opts;
+    int64_t read_start = g_get_monotonic_time();
     int  err;
 
     ws_assert(capture_opts->save_file);
@@ -593,8 +634,11 @@ capture_input_new_packets(capture_session *cap_session, int to_read)
         capture_callback_invoke(capture_cb_capture_fixed_continue, cap_session);
     }
 
-    if(cap_session->wtap)
+    if(cap_session->wtap) {
+        capture_info_add_read_time(&cap_session->cap_data_info->ui, read_start,
+                                   cap_session->count_pending);
         capture_info_new_packets(to_read, cap_session->wtap, cap_session->cap_data_info);
+    }
 }
 
 
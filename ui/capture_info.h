@@ -35,6 +35,14 @@ typedef struct _capture_info {
     /* capture info */
     packet_counts   *counts;        /**< protocol specific counters */
     int             new_packets;    /**< packets since last update */
+
+    /* backpressure; if we can't keep up, the capture child blocks
+       telling us about new packets */
+    unsigned        read_load;      /**< percentage of the last interval spent reading new packets */
+    unsigned        max_read_load;  /**< highest read_load of the capture */
+    uint32_t        pending;        /**< packets captured but not read yet */
+    int64_t         read_time;      /**< microseconds spent reading in this interval */
+    int64_t         interval_start; /**< monotonic time this interval started, or 0 */
 } capture_info;
 
 typedef struct _info_data {
@@ -54,6 +62,12 @@ capture_info    *cinfo);
 extern void capture_info_ui_destroy(
 capture_info    *cinfo);
 
+/** Start a new read load interval if the current one is over. Called
+ *  when packets are read, and periodically by the dialog so that the
+ *  load drops to 0% while no packets arrive. */
+extern void capture_info_update_read_load(
+capture_info    *cinfo);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
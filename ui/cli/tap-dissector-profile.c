@@ -0,0 +1,140 @@
+/* tap-dissector-profile.c
+ * Report the time spent in each protocol's dissectors
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <epan/packet.h>
+#include <epan/tap.h>
+#include <epan/stat_tap_ui.h>
+#include <wsutil/cmdarg_err.h>
+
+void register_tap_listener_dissector_profile(void);
+
+static void
+dissector_profile_collect(const dissector_profile_entry_t *entry, void *user_data)
+{
+    g_ptr_array_add((GPtrArray *)user_data, (void *)entry);
+}
+
+static int
+dissector_profile_compare(const void *a, const void *b)
+{
+    const dissector_profile_entry_t *entry_a = *(const dissector_profile_entry_t * const *)a;
+    const dissector_profile_entry_t *entry_b = *(const dissector_profile_entry_t * const *)b;
+
+    /* Most exclusive time first */
+    if (entry_a->exclusive_ns != entry_b->exclusive_ns)
+        return entry_a->exclusive_ns < entry_b->exclusive_ns ? 1 : -1;
+    return strcmp(entry_a->name, entry_b->name);
+}
+
+static void
+dissector_profile_draw(void *tapdata _U_)
+{
+    GPtrArray *entries = g_ptr_array_new();
+    uint64_t total_ns = 0;
+
+    dissector_profile_foreach(dissector_profile_collect, entries);
+    g_ptr_array_sort(entries, dissector_profile_compare);
+    for (unsigned i = 0; i < entries->len; i++) {
+        total_ns += ((dissector_profile_entry_t *)g_ptr_array_index(entries, i))->exclusive_ns;
+    }
+
+    printf("\n");
+    printf("=========================================================================================\n");
+    printf("Dissector Profile\n");
+    printf("Times are in milliseconds, sorted by exclusive time\n\n");
+    printf("%-24s %12s %12s %12s %7s %12s %12s\n",
+           "Protocol", "Calls", "Inclusive", "Exclusive", "Excl %", "Heur tries", "Heur hits");
+    for (unsigned i = 0; i < entries->len; i++) {
+        const dissector_profile_entry_t *entry = g_ptr_array_index(entries, i);
+
+        printf("%-24s %12" PRIu64 " %12.3f %12.3f %6.2f%% %12" PRIu64 " %12" PRIu64 "\n",
+               entry->name, entry->calls,
+               entry->inclusive_ns / 1e6, entry->exclusive_ns / 1e6,
+               total_ns ? 100.0 * entry->exclusive_ns / total_ns : 0.0,
+               entry->heur_attempts, entry->heur_accepts);
+    }
+    printf("=========================================================================================\n");
+
+    g_ptr_array_free(entries, true);
+}
+
+static void
+dissector_profile_finish(void *tapdata _U_)
+{
+    dissector_profile_enable(false);
+    if (!dissector_profile_is_enabled()) {
+        dissector_profile_reset();
+    }
+}
+
+static bool
+dissector_profile_init(const char *opt_arg, void *userdata _U_)
+{
+    GString *error_string;
+
+    if (strcmp(opt_arg, "dissector_profile") != 0) {
+        cmdarg_err("invalid \"-z dissector_profile\" argument");
+        return false;
+    }
+
+    /* The frame tap is only used to get the draw callback; the profile
+       is collected in packet.c, for every packet that's dissected. */
+    error_string = register_tap_listener("frame", NULL, NULL, TL_REQUIRES_NOTHING,
+                                         NULL,
+                                         NULL,
+                                         dissector_profile_draw,
+                                         dissector_profile_finish);
+    if (error_string) {
+        cmdarg_err("Couldn't register dissector_profile tap: %s",
+                   error_string->str);
+        g_string_free(error_string, TRUE);
+        return false;
+    }
+
+    /* "-z lua,dissectors" may share the profile with us. */
+    if (!dissector_profile_is_enabled()) {
+        dissector_profile_reset();
+    }
+    dissector_profile_enable(true);
+    return true;
+}
+
+static stat_tap_ui dissector_profile_ui = {
+    REGISTER_STAT_GROUP_GENERIC,
+    NULL,
+    "dissector_profile",
+    dissector_profile_init,
+    0,
+    NULL
+};
+
+void
+register_tap_listener_dissector_profile(void)
+{
+    register_stat_tap_ui(&dissector_profile_ui, NULL);
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
@@ -22,6 +22,8 @@
 #include <wsutil/ws_assert.h>
 #include <wsutil/cmdarg_err.h>
 
+#include "ui/expert_info_index.h"
+
 void register_tap_listener_expert_info(void);
 
 /* Tap data */
@@ -34,20 +36,10 @@ typedef enum severity_level_t {
     max_level
 } severity_level_t;
 
-typedef struct expert_entry
-{
-    uint32_t     group;
-    int          frequency;
-    const char *protocol;
-    char        *summary;
-} expert_entry;
-
-
 /* Overall struct for storing all data seen */
 typedef struct expert_tapdata_t {
     severity_level_t lowest_report_level; /* the lowest level that will be displayed */
-    GArray       *ei_array[max_level]; /* expert info items */
-    GStringChunk *text;         /* for efficient storage of summary strings */
+    expert_info_index_t *index;         /* aggregated expert info items */
 } expert_tapdata_t;
 
 
@@ -55,16 +47,28 @@ typedef struct expert_tapdata_t {
 static void
 expert_stat_reset(void *tapdata)
 {
-    int               n;
     expert_tapdata_t *etd = (expert_tapdata_t *)tapdata;
 
-    /* Free & reallocate chunk of strings */
-    g_string_chunk_free(etd->text);
-    etd->text = g_string_chunk_new(100);
+    expert_info_index_reset(etd->index);
+}
 
-    /* Empty each of the arrays */
-    for (n=0; n < max_level; n++) {
-        g_array_set_size(etd->ei_array[n], 0);
+static severity_level_t
+expert_severity_level(int severity)
+{
+    switch (severity) {
+        case PI_COMMENT:
+            return comment_level;
+        case PI_CHAT:
+            return chat_level;
+        case PI_NOTE:
+            return note_level;
+        case PI_WARN:
+            return warn_level;
+        case PI_ERROR:
+            return error_level;
+        default:
+            ws_assert_not_reached();
+            return max_level;
     }
 }
 
@@ -76,29 +80,10 @@ expert_stat_packet(void *tapdata, packet_info *pinfo _U_, epan_dissect_t *edt _U
     const expert_info_t *ei   = (const expert_info_t *)pointer;
     expert_tapdata_t    *data = (expert_tapdata_t *)tapdata;
     severity_level_t     severity_level;
-    expert_entry         tmp_entry;
-    expert_entry        *entry;
-    unsigned             n;
 
-    switch (ei->severity) {
-        case PI_COMMENT:
-            severity_level = comment_level;
-            break;
-        case PI_CHAT:
-            severity_level = chat_level;
-            break;
-        case PI_NOTE:
-            severity_level = note_level;
-            break;
-        case PI_WARN:
-            severity_level = warn_level;
-            break;
-        case PI_ERROR:
-            severity_level = error_level;
-            break;
-        default:
-            ws_assert_not_reached();
-            return TAP_PACKET_DONT_REDRAW;
+    severity_level = expert_severity_level(ei->severity);
+    if (severity_level == max_level) {
+        return TAP_PACKET_DONT_REDRAW;
     }
 
     /* Don't store details at a lesser severity than we are interested in */
@@ -106,64 +91,52 @@ expert_stat_packet(void *tapdata, packet_info *pinfo _U_, epan_dissect_t *edt _U
         return TAP_PACKET_REDRAW; /* XXX - TAP_PACKET_DONT_REDRAW? */
     }
 
-    /* If a duplicate just bump up frequency.
-       TODO: could make more efficient by avoiding linear search...*/
-    for (n=0; n < data->ei_array[severity_level]->len; n++) {
-        entry = &g_array_index(data->ei_array[severity_level], expert_entry, n);
-        if ((strcmp(ei->protocol, entry->protocol) == 0) &&
-            (strcmp(ei->summary, entry->summary) == 0)) {
-            entry->frequency++;
-            return TAP_PACKET_REDRAW;
-        }
-    }
-
-    /* Else Add new item to end of list for severity level */
-    entry = &tmp_entry;
-    /* Copy/Store protocol and summary strings efficiently using GStringChunk */
-    entry->protocol = g_string_chunk_insert_const(data->text, ei->protocol);
-    entry->summary = g_string_chunk_insert_const(data->text, ei->summary);
-    entry->group = ei->group;
-    entry->frequency = 1;
-    /* Store a copy of the expert entry */
-    g_array_append_val(data->ei_array[severity_level], tmp_entry);
+    /* Duplicates just bump up the count of the existing entry */
+    expert_info_index_add(data->index, ei);
 
     return TAP_PACKET_REDRAW;
 }
 
 /* Output for all of the items of one severity */
-static void draw_items_for_severity(GArray *items, const char *label)
+static void draw_items_for_severity(const expert_info_index_t *index, severity_level_t level, const char *label)
 {
     unsigned      n;
-    expert_entry *ei;
-    int           total = 0;
+    unsigned      num_entries = expert_info_index_num_entries(index);
+    const expert_index_entry_t *ei;
+    unsigned      total = 0;
     char         *tmp_str;
 
-    /* Don't print title if no items */
-    if (items->len == 0) {
-        return;
+    /* Add frequencies together to get total */
+    for (n=0; n < num_entries; n++) {
+        ei = expert_info_index_get_entry(index, n);
+        if (expert_severity_level(ei->severity) == level) {
+            total += ei->count;
+        }
     }
 
-    /* Add frequencies together to get total */
-    for (n=0; n < items->len; n++) {
-        ei = &g_array_index(items, expert_entry, n);
-        total += ei->frequency;
+    /* Don't print title if no items */
+    if (total == 0) {
+        return;
     }
 
     /* Title */
-    printf("\n%s (%d)\n", label, total);
+    printf("\n%s (%u)\n", label, total);
     printf("=============\n");
 
     /* Column headings */
     printf("   Frequency      Group           Protocol  Summary\n");
 
     /* Items */
-    for (n=0; n < items->len; n++) {
-        ei = &g_array_index(items, expert_entry, n);
+    for (n=0; n < num_entries; n++) {
+        ei = expert_info_index_get_entry(index, n);
+        if (expert_severity_level(ei->severity) != level) {
+            continue;
+        }
         tmp_str = val_to_str_wmem(NULL, ei->group, expert_group_vals, "Unknown (%d)");
-        printf("%12d %10s %18s  %s\n",
-              ei->frequency,
+        printf("%12u %10s %18s  %s\n",
+              ei->count,
               tmp_str,
-              ei->protocol, ei->summary);
+              ei->protocol ? ei->protocol : "", ei->summary ? ei->summary : "");
         wmem_free(NULL, tmp_str);
     }
 }
@@ -175,20 +148,17 @@ expert_stat_draw(void *phs _U_)
     /* Look up the statistics struct */
     expert_tapdata_t *hs = (expert_tapdata_t *)phs;
 
-    draw_items_for_severity(hs->ei_array[error_level], "Errors");
-    draw_items_for_severity(hs->ei_array[warn_level],  "Warns");
-    draw_items_for_severity(hs->ei_array[note_level],  "Notes");
-    draw_items_for_severity(hs->ei_array[chat_level],  "Chats");
-    draw_items_for_severity(hs->ei_array[comment_level],  "Comments");
+    draw_items_for_severity(hs->index, error_level, "Errors");
+    draw_items_for_severity(hs->index, warn_level,  "Warns");
+    draw_items_for_severity(hs->index, note_level,  "Notes");
+    draw_items_for_severity(hs->index, chat_level,  "Chats");
+    draw_items_for_severity(hs->index, comment_level,  "Comments");
 }
 
 static void
 expert_tapdata_free(expert_tapdata_t* hs)
 {
-    for (int n = 0; n < max_level; n++) {
-        g_array_free(hs->ei_array[n], true);
-    }
-    g_string_chunk_free(hs->text);
+    expert_info_index_free(hs->index);
     g_free(hs);
 }
 
@@ -199,7 +169,6 @@ static bool expert_stat_init(const char *opt_arg, void *userdata _U_)
     const char       *filter = NULL;
     GString          *error_string;
     expert_tapdata_t *hs;
-    int               n;
     severity_level_t lowest_report_level = comment_level;
 
 
@@ -245,13 +214,7 @@ static bool expert_stat_init(const char *opt_arg, void *userdata _U_)
     hs = g_new0(expert_tapdata_t, 1);
     hs->lowest_report_level = lowest_report_level;
 
-    /* Allocate chunk of strings */
-    hs->text = g_string_chunk_new(100);
-
-    /* Allocate GArray for each severity level */
-    for (n=0; n < max_level; n++) {
-        hs->ei_array[n] = g_array_sized_new(false, false, sizeof(expert_entry), 1000);
-    }
+    hs->index = expert_info_index_new();
 
     /**********************************************/
     /* Register the tap listener                  */
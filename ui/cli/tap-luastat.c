@@ -0,0 +1,148 @@
+/* tap-luastat.c
+ * Time spent in the Lua dissectors
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <epan/packet.h>
+#include <epan/tap.h>
+#include <epan/stat_tap_ui.h>
+#include <wsutil/cmdarg_err.h>
+
+#ifdef HAVE_LUA
+#include <epan/wslua/init_wslua.h>
+#endif
+
+void register_tap_listener_luastat(void);
+
+#ifdef HAVE_LUA
+
+/* The dissector profile (see dissector_profile_enable()) times every
+ * dissector; this only shows the protocols created by Lua scripts. */
+static void
+luastat_collect(const dissector_profile_entry_t *entry, void *user_data)
+{
+    if (wslua_is_lua_protocol(entry->name)) {
+        g_ptr_array_add((GPtrArray *)user_data, (void *)entry);
+    }
+}
+
+/* Most expensive dissector first */
+static int
+luastat_compare(const void *a, const void *b)
+{
+    const dissector_profile_entry_t *entry_a = *(const dissector_profile_entry_t * const *)a;
+    const dissector_profile_entry_t *entry_b = *(const dissector_profile_entry_t * const *)b;
+
+    if (entry_a->inclusive_ns != entry_b->inclusive_ns) {
+        return entry_a->inclusive_ns < entry_b->inclusive_ns ? 1 : -1;
+    }
+    return strcmp(entry_a->name, entry_b->name);
+}
+
+static void
+luastat_draw(void *tapdata _U_)
+{
+    GPtrArray *entries = g_ptr_array_new();
+
+    dissector_profile_foreach(luastat_collect, entries);
+    g_ptr_array_sort(entries, luastat_compare);
+
+    printf("\n");
+    printf("===================================================================\n");
+    printf("Lua Dissector Timing\n");
+    printf("%-24s %12s %14s %12s %12s\n", "Dissector", "Calls", "Total (ms)", "Avg (us)", "Max (us)");
+    for (unsigned i = 0; i < entries->len; i++) {
+        const dissector_profile_entry_t *entry = g_ptr_array_index(entries, i);
+
+        printf("%-24s %12" PRIu64 " %14.3f %12.3f %12.3f\n",
+               entry->name, entry->calls,
+               entry->inclusive_ns / 1e6,
+               entry->calls ? entry->inclusive_ns / 1e3 / entry->calls : 0.0,
+               entry->max_ns / 1e3);
+    }
+    printf("===================================================================\n");
+
+    g_ptr_array_free(entries, true);
+}
+
+static void
+luastat_finish(void *tapdata _U_)
+{
+    dissector_profile_enable(false);
+    if (!dissector_profile_is_enabled()) {
+        dissector_profile_reset();
+    }
+}
+
+/* Distinguishes our listener from the one of "-z dissector_profile". */
+static int luastat_tapdata;
+
+static bool
+luastat_init(const char *opt_arg _U_, void *userdata _U_)
+{
+    GString *error_string;
+
+    /* The frame tap is only used to get the draw callback; the profile
+       is collected in packet.c, for every packet that's dissected. */
+    error_string = register_tap_listener("frame", &luastat_tapdata, NULL,
+                                         TL_REQUIRES_NOTHING,
+                                         NULL,
+                                         NULL,
+                                         luastat_draw,
+                                         luastat_finish);
+    if (error_string) {
+        cmdarg_err("Couldn't register lua,dissectors tap: %s", error_string->str);
+        g_string_free(error_string, TRUE);
+        return false;
+    }
+
+    /* "-z dissector_profile" may share the profile with us. */
+    if (!dissector_profile_is_enabled()) {
+        dissector_profile_reset();
+    }
+    dissector_profile_enable(true);
+    return true;
+}
+
+static stat_tap_ui luastat_ui = {
+    REGISTER_STAT_GROUP_GENERIC,
+    NULL,
+    "lua,dissectors",
+    luastat_init,
+    0,
+    NULL
+};
+
+#endif /* HAVE_LUA */
+
+/* Register this tap listener (need void on own so line register function found) */
+void
+register_tap_listener_luastat(void)
+{
+#ifdef HAVE_LUA
+    register_stat_tap_ui(&luastat_ui, NULL);
+#endif
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
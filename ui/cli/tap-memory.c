@@ -0,0 +1,142 @@
+/* tap-memory.c
+ * Report the file scope memory allocated by each protocol
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <epan/packet.h>
+#include <epan/tap.h>
+#include <epan/stat_tap_ui.h>
+#include <wsutil/cmdarg_err.h>
+#include <wsutil/str_util.h>
+
+void register_tap_listener_memory(void);
+
+typedef struct {
+    const char *name;
+    wmem_accounting_stats_t stats;
+} memory_row_t;
+
+static void
+memory_collect(const char *name, const wmem_accounting_stats_t *stats, void *user_data)
+{
+    memory_row_t row;
+
+    row.name = name ? name : "(other)";
+    row.stats = *stats;
+    g_array_append_val((GArray *)user_data, row);
+}
+
+static int
+memory_compare(const void *a, const void *b)
+{
+    const memory_row_t *row_a = (const memory_row_t *)a;
+    const memory_row_t *row_b = (const memory_row_t *)b;
+
+    /* Most bytes first */
+    if (row_a->stats.bytes != row_b->stats.bytes)
+        return row_a->stats.bytes < row_b->stats.bytes ? 1 : -1;
+    return strcmp(row_a->name, row_b->name);
+}
+
+static void
+memory_draw(void *tapdata _U_)
+{
+    GArray *rows = g_array_new(false, false, sizeof(memory_row_t));
+    uint64_t total = 0;
+
+    dissector_memory_accounting_foreach(memory_collect, rows);
+    g_array_sort(rows, memory_compare);
+    for (unsigned i = 0; i < rows->len; i++) {
+        total += g_array_index(rows, memory_row_t, i).stats.bytes;
+    }
+
+    printf("\n");
+    printf("===================================================================\n");
+    printf("File Scope Memory by Protocol\n");
+    printf("Bytes requested from wmem_file_scope(), including reallocations\n\n");
+    printf("%-24s %14s %14s %8s %10s\n", "Protocol", "Allocations", "Bytes", "Bytes %", "Size");
+    for (unsigned i = 0; i < rows->len; i++) {
+        const memory_row_t *row = &g_array_index(rows, memory_row_t, i);
+        char *size_str = format_size(row->stats.bytes, FORMAT_SIZE_UNIT_BYTES, FORMAT_SIZE_PREFIX_IEC);
+
+        printf("%-24s %14" PRIu64 " %14" PRIu64 " %7.2f%% %10s\n",
+               row->name, row->stats.allocations, row->stats.bytes,
+               total ? 100.0 * row->stats.bytes / total : 0.0, size_str);
+        g_free(size_str);
+    }
+    printf("===================================================================\n");
+
+    g_array_free(rows, true);
+}
+
+static void
+memory_finish(void *tapdata _U_)
+{
+    dissector_memory_accounting_enable(false);
+}
+
+static bool
+memory_init(const char *opt_arg, void *userdata _U_)
+{
+    GString *error_string;
+
+    if (strcmp(opt_arg, "memory,proto") != 0) {
+        cmdarg_err("invalid \"-z memory,proto\" argument");
+        return false;
+    }
+
+    /* The frame tap is only used to get the draw callback; the
+       allocations are counted by wmem. */
+    error_string = register_tap_listener("frame", NULL, NULL, TL_REQUIRES_NOTHING,
+                                         NULL,
+                                         NULL,
+                                         memory_draw,
+                                         memory_finish);
+    if (error_string) {
+        cmdarg_err("Couldn't register memory,proto tap: %s",
+                   error_string->str);
+        g_string_free(error_string, TRUE);
+        return false;
+    }
+
+    dissector_memory_accounting_enable(true);
+    return true;
+}
+
+static stat_tap_ui memory_ui = {
+    REGISTER_STAT_GROUP_GENERIC,
+    NULL,
+    "memory,proto",
+    memory_init,
+    0,
+    NULL
+};
+
+void
+register_tap_listener_memory(void)
+{
+    register_stat_tap_ui(&memory_ui, NULL);
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
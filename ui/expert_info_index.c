@@ -0,0 +1,208 @@
+/* expert_info_index.c
+ * Aggregated expert information
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#include <glib.h>
+
+#include "ui/expert_info_index.h"
+
+struct _expert_info_index_t {
+    GPtrArray    *entries;      /* expert_index_entry_t, in the order first seen */
+    GHashTable   *lookup;       /* expert_index_entry_t -> itself */
+    GStringChunk *text;         /* interned protocol and summary strings */
+    uint64_t      occurrences;
+};
+
+/*
+ * Since the strings are interned, entries can be compared and hashed
+ * by the string pointers.
+ */
+static unsigned
+expert_index_entry_hash(const void *key)
+{
+    const expert_index_entry_t *entry = (const expert_index_entry_t *)key;
+    unsigned hash;
+
+    hash = (unsigned)entry->hf_index;
+    hash = hash * 31 + (unsigned)entry->severity;
+    hash = hash * 31 + (unsigned)entry->group;
+    hash = hash * 31 + GPOINTER_TO_UINT(entry->protocol);
+    hash = hash * 31 + GPOINTER_TO_UINT(entry->summary);
+    return hash;
+}
+
+static gboolean
+expert_index_entry_equal(const void *a, const void *b)
+{
+    const expert_index_entry_t *entry_a = (const expert_index_entry_t *)a;
+    const expert_index_entry_t *entry_b = (const expert_index_entry_t *)b;
+
+    return entry_a->hf_index == entry_b->hf_index &&
+           entry_a->severity == entry_b->severity &&
+           entry_a->group == entry_b->group &&
+           entry_a->protocol == entry_b->protocol &&
+           entry_a->summary == entry_b->summary;
+}
+
+static void
+expert_index_entry_free(void *data)
+{
+    expert_index_entry_t *entry = (expert_index_entry_t *)data;
+
+    g_byte_array_free(entry->frames, true);
+    g_free(entry);
+}
+
+expert_info_index_t *
+expert_info_index_new(void)
+{
+    expert_info_index_t *index = g_new0(expert_info_index_t, 1);
+
+    index->entries = g_ptr_array_new_with_free_func(expert_index_entry_free);
+    index->lookup = g_hash_table_new(expert_index_entry_hash, expert_index_entry_equal);
+    index->text = g_string_chunk_new(1024);
+    return index;
+}
+
+void
+expert_info_index_reset(expert_info_index_t *index)
+{
+    g_hash_table_remove_all(index->lookup);
+    g_ptr_array_set_size(index->entries, 0);
+    g_string_chunk_clear(index->text);
+    index->occurrences = 0;
+}
+
+void
+expert_info_index_free(expert_info_index_t *index)
+{
+    if (!index)
+        return;
+
+    g_hash_table_destroy(index->lookup);
+    g_ptr_array_free(index->entries, true);
+    g_string_chunk_free(index->text);
+    g_free(index);
+}
+
+/*
+ * Frame numbers are stored as the zigzag encoded difference from the
+ * previous frame number of the entry, in little-endian base 128. Taps
+ * see the frames in increasing order, so the difference is usually a
+ * small positive number (zero for repeats within a frame), but a
+ * decreasing sequence is representable too.
+ */
+static void
+expert_index_append_frame(expert_index_entry_t *entry, uint32_t frame_num)
+{
+    int64_t  delta = (int64_t)frame_num - (int64_t)(entry->count ? entry->last_frame : 0);
+    uint64_t value = ((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63);
+    uint8_t  buf[10];
+    unsigned len = 0;
+
+    do {
+        buf[len] = value & 0x7f;
+        value >>= 7;
+        if (value)
+            buf[len] |= 0x80;
+        len++;
+    } while (value);
+
+    g_byte_array_append(entry->frames, buf, len);
+}
+
+const expert_index_entry_t *
+expert_info_index_add(expert_info_index_t *index, const expert_info_t *ei)
+{
+    expert_index_entry_t key;
+    expert_index_entry_t *entry;
+
+    key.hf_index = ei->hf_index;
+    key.severity = ei->severity;
+    key.group = ei->group;
+    key.protocol = ei->protocol ? g_string_chunk_insert_const(index->text, ei->protocol) : NULL;
+    key.summary = ei->summary ? g_string_chunk_insert_const(index->text, ei->summary) : NULL;
+
+    entry = (expert_index_entry_t *)g_hash_table_lookup(index->lookup, &key);
+    if (!entry) {
+        entry = g_new(expert_index_entry_t, 1);
+        *entry = key;
+        entry->count = 0;
+        entry->first_frame = ei->packet_num;
+        entry->last_frame = ei->packet_num;
+        entry->frames = g_byte_array_new();
+        g_ptr_array_add(index->entries, entry);
+        g_hash_table_add(index->lookup, entry);
+    }
+
+    expert_index_append_frame(entry, ei->packet_num);
+    entry->last_frame = ei->packet_num;
+    entry->count++;
+    index->occurrences++;
+
+    return entry;
+}
+
+unsigned
+expert_info_index_num_entries(const expert_info_index_t *index)
+{
+    return index->entries->len;
+}
+
+uint64_t
+expert_info_index_num_occurrences(const expert_info_index_t *index)
+{
+    return index->occurrences;
+}
+
+const expert_index_entry_t *
+expert_info_index_get_entry(const expert_info_index_t *index, unsigned n)
+{
+    if (n >= index->entries->len)
+        return NULL;
+
+    return (const expert_index_entry_t *)g_ptr_array_index(index->entries, n);
+}
+
+void
+expert_info_index_foreach_frame(const expert_index_entry_t *entry, expert_index_frame_cb cb, void *user_data)
+{
+    const uint8_t *p = entry->frames->data;
+    const uint8_t *end = p + entry->frames->len;
+    int64_t frame_num = 0;
+
+    while (p < end) {
+        uint64_t value = 0;
+        unsigned shift = 0;
+
+        do {
+            value |= (uint64_t)(*p & 0x7f) << shift;
+            shift += 7;
+        } while ((*p++ & 0x80) && p < end);
+
+        frame_num += (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+        if (!cb((uint32_t)frame_num, user_data))
+            return;
+    }
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
@@ -0,0 +1,103 @@
+/** @file
+ *
+ * Aggregated expert information
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __EXPERT_INFO_INDEX_H__
+#define __EXPERT_INFO_INDEX_H__
+
+#include <epan/expert.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * Expert information aggregated on (expert field, severity, group,
+ * protocol, summary). Each distinct combination is stored once, with
+ * interned strings, an occurrence count and the list of frames it was
+ * seen in. The frame list is delta encoded as variable-length integers,
+ * which typically takes a single byte per occurrence.
+ */
+
+typedef struct _expert_index_entry_t {
+    int          hf_index;      /* hf_index of the expert item, might be -1 */
+    int          severity;
+    int          group;
+    const char  *protocol;      /* interned, owned by the index */
+    const char  *summary;       /* interned, owned by the index */
+    unsigned     count;         /* number of occurrences */
+    uint32_t     first_frame;
+    uint32_t     last_frame;
+    GByteArray  *frames;        /* encoded frame numbers; see expert_info_index_foreach_frame() */
+} expert_index_entry_t;
+
+typedef struct _expert_info_index_t expert_info_index_t;
+
+/** Callback for expert_info_index_foreach_frame().
+ *
+ * @param frame_num The frame number.
+ * @param user_data The user data passed to expert_info_index_foreach_frame().
+ * @return false to stop iterating.
+ */
+typedef bool (*expert_index_frame_cb)(uint32_t frame_num, void *user_data);
+
+/** Create an empty index. */
+expert_info_index_t *expert_info_index_new(void);
+
+/** Remove all entries from the index. */
+void expert_info_index_reset(expert_info_index_t *index);
+
+/** Free the index and all of its entries. */
+void expert_info_index_free(expert_info_index_t *index);
+
+/** Add an occurrence of expert information, typically from the "expert" tap.
+ *
+ * The strings in ei are copied as needed, so they can be packet scoped.
+ *
+ * @return The entry the occurrence was added to.
+ */
+const expert_index_entry_t *expert_info_index_add(expert_info_index_t *index, const expert_info_t *ei);
+
+/** @return The number of distinct entries. */
+unsigned expert_info_index_num_entries(const expert_info_index_t *index);
+
+/** @return The total number of occurrences of all entries. */
+uint64_t expert_info_index_num_occurrences(const expert_info_index_t *index);
+
+/** Get an entry. Entries are kept in the order they were first seen.
+ *
+ * @param index The index.
+ * @param n The entry, less than expert_info_index_num_entries().
+ */
+const expert_index_entry_t *expert_info_index_get_entry(const expert_info_index_t *index, unsigned n);
+
+/** Call a function for each frame an entry was seen in, in the order
+ * they were added. A frame appears once per occurrence.
+ */
+void expert_info_index_foreach_frame(const expert_index_entry_t *entry, expert_index_frame_cb cb, void *user_data);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __EXPERT_INFO_INDEX_H__ */
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
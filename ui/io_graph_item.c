@@ -139,6 +139,91 @@ GString *check_field_unit(const char *field_name, int *hf_index, io_graph_item_u
     return err_str;
 }
 
+void merge_io_graph_item(io_graph_item_t *dst, const io_graph_item_t *src, int hf_index)
+{
+    bool first = (dst->fields == 0);
+
+    if (src->first_frame_in_invl && !dst->first_frame_in_invl) {
+        dst->first_frame_in_invl = src->first_frame_in_invl;
+    }
+    if (src->last_frame_in_invl) {
+        dst->last_frame_in_invl = src->last_frame_in_invl;
+    }
+    dst->frames += src->frames;
+    dst->bytes += src->bytes;
+
+    if (src->fields == 0) {
+        return;
+    }
+
+    switch (hf_index >= 0 ? proto_registrar_get_ftype(hf_index) : FT_NONE) {
+    case FT_UINT8:
+    case FT_UINT16:
+    case FT_UINT24:
+    case FT_UINT32:
+    case FT_UINT40:
+    case FT_UINT48:
+    case FT_UINT56:
+    case FT_UINT64:
+        if (first || src->uint_max > dst->uint_max) {
+            dst->uint_max = src->uint_max;
+            dst->max_frame_in_invl = src->max_frame_in_invl;
+        }
+        if (first || src->uint_min < dst->uint_min) {
+            dst->uint_min = src->uint_min;
+            dst->min_frame_in_invl = src->min_frame_in_invl;
+        }
+        dst->double_tot += src->double_tot;
+        break;
+    case FT_INT8:
+    case FT_INT16:
+    case FT_INT24:
+    case FT_INT32:
+    case FT_INT40:
+    case FT_INT48:
+    case FT_INT56:
+    case FT_INT64:
+        if (first || src->int_max > dst->int_max) {
+            dst->int_max = src->int_max;
+            dst->max_frame_in_invl = src->max_frame_in_invl;
+        }
+        if (first || src->int_min < dst->int_min) {
+            dst->int_min = src->int_min;
+            dst->min_frame_in_invl = src->min_frame_in_invl;
+        }
+        dst->double_tot += src->double_tot;
+        break;
+    case FT_FLOAT:
+    case FT_DOUBLE:
+        if (first || src->double_max > dst->double_max) {
+            dst->double_max = src->double_max;
+            dst->max_frame_in_invl = src->max_frame_in_invl;
+        }
+        if (first || src->double_min < dst->double_min) {
+            dst->double_min = src->double_min;
+            dst->min_frame_in_invl = src->min_frame_in_invl;
+        }
+        dst->double_tot += src->double_tot;
+        break;
+    case FT_RELATIVE_TIME:
+        /* LOAD items only use time_tot, which is summed the same way. */
+        if (first || nstime_cmp(&src->time_max, &dst->time_max) > 0) {
+            dst->time_max = src->time_max;
+            dst->max_frame_in_invl = src->max_frame_in_invl;
+        }
+        if (first || nstime_cmp(&src->time_min, &dst->time_min) < 0) {
+            dst->time_min = src->time_min;
+            dst->min_frame_in_invl = src->min_frame_in_invl;
+        }
+        nstime_add(&dst->time_tot, &src->time_tot);
+        break;
+    default:
+        /* Only counted. */
+        break;
+    }
+    dst->fields += src->fields;
+}
+
 // Adapted from get_it_value in gtk/io_stat.c.
 double get_io_graph_item(const io_graph_item_t *items_, io_graph_item_unit_t val_units_, int idx, int hf_index_, const capture_file *cap_file, int interval_, int cur_idx_, bool asAOT)
 {
@@ -192,6 +192,19 @@ GString *check_field_unit(const char *field_name, int *hf_index, io_graph_item_u
  */
 double get_io_graph_item(const io_graph_item_t *items, io_graph_item_unit_t val_units, int idx, int hf_index, const capture_file *cap_file, int interval, int cur_idx, bool asAOT);
 
+/** Merge the values of one io_graph_item_t into another.
+ *
+ * Used to derive the items of a coarser interval from items tapped at a
+ * finer one without retapping. src must describe a later (or the same)
+ * time span than anything previously merged into dst, so that the first
+ * and last frame numbers stay in order.
+ *
+ * @param dst [in,out] Item to merge into.
+ * @param src [in] Item to merge from.
+ * @param hf_index [in] Header field index for advanced statistics.
+ */
+void merge_io_graph_item(io_graph_item_t *dst, const io_graph_item_t *src, int hf_index);
+
 /** Update the values of an io_graph_item_t.
  *
  * Frame and byte counts are always calculated. If edt is non-NULL advanced
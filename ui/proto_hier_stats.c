@@ -27,35 +27,59 @@
 
 static int pc_proto_id = -1;
 
+/* Key of ph_stats_t's node index: a protocol below a given stat node. */
+typedef struct {
+    const GNode *parent;
+    int          proto_id;
+} ph_stats_node_key_t;
+
+static unsigned
+ph_stats_node_key_hash(const void *k)
+{
+    const ph_stats_node_key_t *key = (const ph_stats_node_key_t *)k;
+
+    return GPOINTER_TO_UINT(key->parent) ^ ((unsigned)key->proto_id * 0x9e3779b1U);
+}
+
+static gboolean
+ph_stats_node_key_equal(const void *k1, const void *k2)
+{
+    const ph_stats_node_key_t *key1 = (const ph_stats_node_key_t *)k1;
+    const ph_stats_node_key_t *key2 = (const ph_stats_node_key_t *)k2;
+
+    return key1->parent == key2->parent && key1->proto_id == key2->proto_id;
+}
+
+static GNode *
+lookup_child_stat_node(ph_stats_t *ps, const GNode *parent_stat_node, int proto_id)
+{
+    ph_stats_node_key_t key;
+
+    key.parent = parent_stat_node;
+    key.proto_id = proto_id;
+    return (GNode *)g_hash_table_lookup(ps->node_index, &key);
+}
+
     static GNode*
-find_stat_node(GNode *parent_stat_node, const header_field_info *needle_hfinfo)
+find_stat_node(ph_stats_t *ps, GNode *parent_stat_node, const header_field_info *needle_hfinfo)
 {
     GNode		*needle_stat_node, *up_parent_stat_node;
-    const header_field_info	*hfinfo;
     ph_stats_node_t	*stats;
+    ph_stats_node_key_t	*key;
 
     /* Look down the tree */
-    needle_stat_node = g_node_first_child(parent_stat_node);
-
-    while (needle_stat_node) {
-        hfinfo = STAT_NODE_HFINFO(needle_stat_node);
-        if (hfinfo &&  hfinfo->id == needle_hfinfo->id) {
-            return needle_stat_node;
-        }
-        needle_stat_node = g_node_next_sibling(needle_stat_node);
+    needle_stat_node = lookup_child_stat_node(ps, parent_stat_node, needle_hfinfo->id);
+    if (needle_stat_node) {
+        return needle_stat_node;
     }
 
     /* Look up the tree */
     up_parent_stat_node = parent_stat_node;
     while (up_parent_stat_node && up_parent_stat_node->parent)
     {
-        needle_stat_node = g_node_first_child(up_parent_stat_node->parent);
-        while (needle_stat_node) {
-            hfinfo = STAT_NODE_HFINFO(needle_stat_node);
-            if (hfinfo &&  hfinfo->id == needle_hfinfo->id) {
-                return needle_stat_node;
-            }
-            needle_stat_node = g_node_next_sibling(needle_stat_node);
+        needle_stat_node = lookup_child_stat_node(ps, up_parent_stat_node->parent, needle_hfinfo->id);
+        if (needle_stat_node) {
+            return needle_stat_node;
         }
 
         up_parent_stat_node = up_parent_stat_node->parent;
@@ -75,6 +99,12 @@ find_stat_node(GNode *parent_stat_node, const header_field_info *needle_hfinfo)
 
     needle_stat_node = g_node_new(stats);
     g_node_append(parent_stat_node, needle_stat_node);
+
+    key = g_new(ph_stats_node_key_t, 1);
+    key->parent = parent_stat_node;
+    key->proto_id = needle_hfinfo->id;
+    g_hash_table_insert(ps->node_index, key, needle_stat_node);
+
     return needle_stat_node;
 }
 
@@ -102,7 +132,7 @@ process_node(proto_node *ptree_node, GNode *parent_stat_node, ph_stats_t *ps)
      */
     ws_assert(finfo);
 
-    stat_node = find_stat_node(parent_stat_node, finfo->hfinfo);
+    stat_node = find_stat_node(ps, parent_stat_node, finfo->hfinfo);
 
     stats = STAT_NODE_STATS(stat_node);
     /* Only increment the total packet count once per packet for a given
@@ -171,38 +201,63 @@ process_tree(proto_tree *protocol_tree, ph_stats_t* ps)
     process_node(ptree_node, ps->stats_tree, ps);
 }
 
+    static ph_stats_t*
+ph_stats_alloc(void)
+{
+    ph_stats_t	*ps;
+
+    pc_proto_id = proto_registrar_get_id_byname("pkt_comment");
+
+    ps = g_new(ph_stats_t, 1);
+    ps->tot_packets = 0;
+    ps->tot_bytes = 0;
+    ps->stats_tree = g_node_new(NULL);
+    ps->first_time = 0.0;
+    ps->last_time = 0.0;
+    ps->node_index = g_hash_table_new_full(ph_stats_node_key_hash,
+            ph_stats_node_key_equal, g_free, NULL);
+
+    return ps;
+}
+
     static bool
-process_record(capture_file *cf, frame_data *frame, column_info *cinfo,
+process_record(capture_file *cf, frame_data *frame, epan_dissect_t *edt,
                wtap_rec *rec, ph_stats_t* ps)
 {
-    epan_dissect_t	edt;
-    double		cur_time;
-
     /* Load the record from the capture file */
     if (!cf_read_record(cf, frame, rec))
         return false;	/* failure */
 
-    /* Dissect the record   tree  not visible */
-    epan_dissect_init(&edt, cf->epan, true, false);
-    /* Don't fake protocols. We need them for the protocol hierarchy */
-    epan_dissect_fake_protocols(&edt, false);
-    epan_dissect_run(&edt, cf->cd_t, rec, frame, cinfo);
-
-    /* Get stats from this protocol tree */
-    process_tree(edt.tree, ps);
+    /* Dissect the record   tree  not visible; we don't care about colinfo */
+    epan_dissect_run(edt, cf->cd_t, rec, frame, NULL);
 
     if (frame->has_ts) {
         /* Update times */
-        cur_time = nstime_to_sec(&frame->abs_ts);
+        double cur_time = nstime_to_sec(&frame->abs_ts);
+
+        if (ps->tot_packets == 0) {
+            ps->first_time = cur_time;
+            ps->last_time = cur_time;
+        }
         if (cur_time < ps->first_time)
             ps->first_time = cur_time;
         if (cur_time > ps->last_time)
             ps->last_time = cur_time;
     }
 
+    /* Increment this first so that the count starts at 1 when processing
+     * the tree, since we initialize the stat nodes' last_pkt to 0.
+     */
+    ps->tot_packets++;
+
+    /* Get stats from this protocol tree */
+    process_tree(edt->tree, ps);
+
+    ps->tot_bytes += frame->pkt_len;
+
     /* Free our memory. */
-    epan_dissect_cleanup(&edt);
-    wtap_rec_cleanup(rec);
+    epan_dissect_reset(edt);
+    wtap_rec_reset(rec);
 
     return true;	/* success */
 }
@@ -216,6 +271,7 @@ ph_stats_new(capture_file *cf)
     progdlg_t	*progbar = NULL;
     int		count;
     wtap_rec	rec;
+    epan_dissect_t	edt;
     float	progbar_val;
     char	status_str[100];
     int		progbar_nextstep;
@@ -231,15 +287,8 @@ ph_stats_new(capture_file *cf)
 
     cf->stop_flag = false;
 
-    pc_proto_id = proto_registrar_get_id_byname("pkt_comment");
-
     /* Initialize the data */
-    ps = g_new(ph_stats_t, 1);
-    ps->tot_packets = 0;
-    ps->tot_bytes = 0;
-    ps->stats_tree = g_node_new(NULL);
-    ps->first_time = 0.0;
-    ps->last_time = 0.0;
+    ps = ph_stats_alloc();
 
     /* Update the progress bar when it gets to this value. */
     progbar_nextstep = 0;
@@ -253,6 +302,11 @@ ph_stats_new(capture_file *cf)
 
     wtap_rec_init(&rec, 1514);
 
+    /* One dissection context for all the records, tree not visible */
+    epan_dissect_init(&edt, cf->epan, true, false);
+    /* Don't fake protocols. We need them for the protocol hierarchy */
+    epan_dissect_fake_protocols(&edt, false);
+
     for (framenum = 1; framenum <= cf->count; framenum++) {
         frame = frame_data_sequence_find(cf->provider.frames, framenum);
 
@@ -303,24 +357,8 @@ ph_stats_new(capture_file *cf)
            probably do so for other loops (see "file.c") that
            look only at those packets. */
         if (frame->passed_dfilter) {
-
-            if (frame->has_ts) {
-                if (ps->tot_packets == 0) {
-                    double cur_time = nstime_to_sec(&frame->abs_ts);
-                    ps->first_time = cur_time;
-                    ps->last_time = cur_time;
-                }
-            }
-
-            /* We throw away the statistics if we quit in the middle,
-             * so increment this first so that the count starts at 1
-             * when processing records, since we initialize the stat
-             * nodes' last_pkt to 0.
-             */
-            ps->tot_packets++;
-
-            /* we don't care about colinfo */
-            if (!process_record(cf, frame, NULL, &rec, ps)) {
+            /* We throw away the statistics if we quit in the middle. */
+            if (!process_record(cf, frame, &edt, &rec, ps)) {
                 /*
                  * Give up, and set "stop_flag" so we
                  * just abort rather than popping up
@@ -329,13 +367,12 @@ ph_stats_new(capture_file *cf)
                 cf->stop_flag = true;
                 break;
             }
-
-            ps->tot_bytes += frame->pkt_len;
         }
 
         count++;
     }
 
+    epan_dissect_cleanup(&edt);
     wtap_rec_cleanup(&rec);
 
     /* We're done calculating the statistics; destroy the progress bar
@@ -376,6 +413,9 @@ ph_stats_free(ph_stats_t *ps)
                 stat_node_free, NULL);
         g_node_destroy(ps->stats_tree);
     }
+    if (ps->node_index) {
+        g_hash_table_destroy(ps->node_index);
+    }
 
     g_free(ps);
 }
@@ -38,8 +38,12 @@ typedef struct {
     GNode	*stats_tree;
     double	first_time;	/* seconds (msec resolution) of first packet */
     double	last_time;	/* seconds (msec resolution) of last packet  */
+    GHashTable	*node_index;	/* (parent node, protocol id) -> child node; internal */
 } ph_stats_t;
 
+/** Compute the statistics of the displayed packets of a capture file,
+ *  dissecting them again.
+ */
 ph_stats_t *ph_stats_new(capture_file *cf);
 
 void ph_stats_free(ph_stats_t *ps);
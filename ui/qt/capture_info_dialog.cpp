@@ -29,6 +29,7 @@
 
 #include <QMainWindow>
 #include <QPushButton>
+#include <QTimer>
 
 // The GTK+ version of this dialog showed a list of protocols and a simple bar graph
 // (progress bars) showing their portion of the total number of packets. We show a
@@ -104,6 +105,12 @@ CaptureInfoDialog::CaptureInfoDialog(struct _capture_info *cap_info, struct _cap
     ui->treeView->setItemDelegateForColumn(1, new SparkLineDelegate(this));
 
     duration_.start();
+
+    // capture_info_ui_update is only called when packets arrive. Keep the
+    // elapsed time and read load moving while the capture is idle.
+    QTimer *load_timer = new QTimer(this);
+    connect(load_timer, &QTimer::timeout, this, &CaptureInfoDialog::updateReadLoad);
+    load_timer->start(1000);
 }
 
 CaptureInfoDialog::~CaptureInfoDialog()
@@ -113,6 +120,14 @@ CaptureInfoDialog::~CaptureInfoDialog()
 }
 
 void CaptureInfoDialog::updateInfo()
+{
+    updateLabel();
+
+    ci_model_->updateInfo();
+    ui->treeView->resizeColumnToContents(0);
+}
+
+void CaptureInfoDialog::updateLabel()
 {
     int secs = int(duration_.elapsed() / 1000);
     QString duration = tr("%1 packets, %2:%3:%4")
@@ -120,10 +135,19 @@ void CaptureInfoDialog::updateInfo()
             .arg(secs / 3600, 2, 10, QChar('0'))
             .arg(secs % 3600 / 60, 2, 10, QChar('0'))
             .arg(secs % 60, 2, 10, QChar('0'));
+    duration += tr(", %1% read load (peak %2%)")
+            .arg(cap_info_->read_load)
+            .arg(cap_info_->max_read_load);
+    if (cap_info_->pending > 0) {
+        duration += tr(", %1 not read yet").arg(cap_info_->pending);
+    }
     ui->infoLabel->setText(duration);
+}
 
-    ci_model_->updateInfo();
-    ui->treeView->resizeColumnToContents(0);
+void CaptureInfoDialog::updateReadLoad()
+{
+    capture_info_update_read_load(cap_info_);
+    updateLabel();
 }
 
 void CaptureInfoDialog::stopCapture()
@@ -62,8 +62,11 @@ public slots:
 
 private slots:
     void stopCapture();
+    void updateReadLoad();
 
 private:
+    void updateLabel();
+
     Ui::CaptureInfoDialog *ui;
     struct _capture_info *cap_info_;
     struct _capture_session *cap_session_;
@@ -35,12 +35,19 @@ IOGraph::IOGraph(QCustomPlot* parent) :
     moving_avg_period_(0),
     tap_registered_(true),
     need_retap_(false),
+    data_valid_(false),
+    keep_data_(false),
+    tapped_from_start_(false),
+    truncated_(false),
     val_units_(IOG_ITEM_UNIT_FIRST),
     start_time_(NSTIME_INIT_ZERO),
     hf_index_(-1),
     interval_(0),
     asAOT_(false),
-    cur_idx_(-1)
+    cur_idx_(-1),
+    tap_interval_(0),
+    view_cur_idx_(-1),
+    view_dirty_(false)
 {
     GString* error_string;
     error_string = register_tap_listener("frame",
@@ -188,6 +195,10 @@ void IOGraph::setVisible(bool visible)
 
 void IOGraph::setNeedRetap(bool retap)
 {
+    if (retap) {
+        data_valid_ = false;
+        tapped_from_start_ = false;
+    }
     if (visible_ && retap) {
         emit requestRetap();
     }
@@ -303,14 +314,15 @@ nstime_t IOGraph::startTime() const
 int IOGraph::packetFromTime(double ts) const
 {
     int idx = ts * SCALE_F / interval_;
-    if (idx >= 0 && idx <= cur_idx_) {
+    if (idx >= 0 && idx <= maxInterval()) {
+        const io_graph_item_t* items = viewItems();
         switch (val_units_) {
         case IOG_ITEM_UNIT_CALC_MAX:
-            return items_[idx].max_frame_in_invl;
+            return items[idx].max_frame_in_invl;
         case IOG_ITEM_UNIT_CALC_MIN:
-            return items_[idx].min_frame_in_invl;
+            return items[idx].min_frame_in_invl;
         default:
-            return items_[idx].last_frame_in_invl;
+            return items[idx].last_frame_in_invl;
         }
     }
     return -1;
@@ -322,10 +334,63 @@ void IOGraph::clearAllData()
     if (items_.size()) {
         reset_io_graph_items(&items_[0], items_.size(), hf_index_);
     }
+    view_items_.clear();
+    view_cur_idx_ = -1;
+    view_dirty_ = false;
     nstime_set_zero(&start_time_);
     Graph::clearAllData();
 }
 
+// Items for the displayed interval: either what was tapped, or what was
+// aggregated from it.
+const io_graph_item_t* IOGraph::viewItems() const
+{
+    if (tap_interval_ == interval_) {
+        return items_.data();
+    }
+    return view_items_.data();
+}
+
+// Derive the items for interval_ from the ones tapped at tap_interval_.
+// get_io_graph_index() floors the relative time, so tapped item i belongs
+// to displayed item i / factor.
+void IOGraph::aggregateViewItems()
+{
+    view_dirty_ = false;
+    view_items_.clear();
+    view_cur_idx_ = -1;
+
+    if (tap_interval_ <= 0 || tap_interval_ == interval_ ||
+        interval_ % tap_interval_ != 0 || cur_idx_ < 0) {
+        return;
+    }
+
+    int factor = interval_ / tap_interval_;
+    try {
+        view_items_.resize((size_t)(cur_idx_ / factor) + 1);
+    }
+    catch (std::bad_alloc&) {
+        ws_warning("Failed memory allocation!");
+        return;
+    }
+    // resize zero-initializes new items, which is what we want
+    view_cur_idx_ = cur_idx_ / factor;
+
+    for (int i = 0; i <= cur_idx_; i++) {
+        merge_io_graph_item(&view_items_[i / factor], &items_[i], hf_index_);
+    }
+}
+
+// Called by the dialog before it retaps. Returns true if this graph's data
+// can be left as is, in which case the retap won't reset or update it.
+bool IOGraph::keepDataForRetap(bool keep)
+{
+    // A hidden graph that is flagged for a retap will ask for one when
+    // it is shown, so there's no point in tapping it now.
+    keep_data_ = keep && (data_valid_ || (!visible_ && need_retap_));
+    return keep_data_;
+}
+
 void IOGraph::recalcGraphData(capture_file* cap_file)
 {
     /* Moving average variables */
@@ -340,7 +405,12 @@ void IOGraph::recalcGraphData(capture_file* cap_file)
         bars_->data()->clear();
     }
 
-    if (moving_avg_period_ > 0 && cur_idx_ >= 0) {
+    if (view_dirty_) {
+        aggregateViewItems();
+    }
+    int max_idx = maxInterval();
+
+    if (moving_avg_period_ > 0 && max_idx >= 0) {
         /* "Warm-up phase" - calculate average on some data not displayed;
          * just to make sure average on leftmost and rightmost displayed
          * values is as reliable as possible
@@ -351,7 +421,7 @@ void IOGraph::recalcGraphData(capture_file* cap_file)
         mavg_in_average_count++;
         for (warmup_interval = 1;
             (warmup_interval < moving_avg_period_ / 2) &&
-            (warmup_interval <= (unsigned)cur_idx_);
+            (warmup_interval <= (unsigned)max_idx);
             warmup_interval += 1) {
 
             mavg_cumulated += getItemValue((int)warmup_interval, cap_file);
@@ -361,7 +431,7 @@ void IOGraph::recalcGraphData(capture_file* cap_file)
     }
 
     double ts_offset = startOffset();
-    for (int i = 0; i <= cur_idx_; i++) {
+    for (int i = 0; i <= max_idx; i++) {
         double ts = (double)i * interval_ / SCALE_F + ts_offset;
         double val = getItemValue(i, cap_file);
 
@@ -374,7 +444,7 @@ void IOGraph::recalcGraphData(capture_file* cap_file)
                     mavg_cumulated -= getItemValue(mavg_to_remove, cap_file);
                     mavg_to_remove += 1;
                 }
-                if (mavg_to_add <= (unsigned int)cur_idx_) {
+                if (mavg_to_add <= (unsigned int)max_idx) {
                     mavg_in_average_count++;
                     mavg_cumulated += getItemValue(mavg_to_add, cap_file);
                     mavg_to_add += 1;
@@ -465,10 +535,44 @@ void IOGraph::scaleGraphData(DataMap& map, int scalar)
 
 void IOGraph::captureEvent(const CaptureEvent& e)
 {
-    if ((e.captureContext() == CaptureEvent::File) &&
-        (e.eventType() == CaptureEvent::Closing))
-    {
-        removeTapListener();
+    switch (e.captureContext()) {
+    case CaptureEvent::File:
+        switch (e.eventType()) {
+        case CaptureEvent::Closing:
+            removeTapListener();
+            data_valid_ = false;
+            break;
+        case CaptureEvent::Started:
+            data_valid_ = false;
+            break;
+        case CaptureEvent::Finished:
+            data_valid_ = tapped_from_start_ && visible_ && !need_retap_ && !truncated_;
+            break;
+        default:
+            break;
+        }
+        break;
+    case CaptureEvent::Retap:
+        if (e.eventType() == CaptureEvent::Finished) {
+            if (keep_data_) {
+                keep_data_ = false;
+            } else {
+                data_valid_ = tapped_from_start_ && visible_ && !need_retap_ && !truncated_;
+            }
+        }
+        break;
+    case CaptureEvent::Reload:
+    case CaptureEvent::Rescan:
+        // Time references and the like may have changed.
+        if (e.eventType() == CaptureEvent::Started) {
+            data_valid_ = false;
+            if (!visible_) {
+                need_retap_ = true;
+            }
+        }
+        break;
+    default:
+        break;
     }
 }
 
@@ -518,7 +622,7 @@ bool IOGraph::hasItemToShow(int idx, double value) const
 
     bool result = false;
 
-    const io_graph_item_t* item = &items_[idx];
+    const io_graph_item_t* item = &viewItems()[idx];
 
     switch (val_units_) {
     case IOG_ITEM_UNIT_PACKETS:
@@ -553,12 +657,27 @@ bool IOGraph::hasItemToShow(int idx, double value) const
     return result;
 }
 
-void IOGraph::setInterval(int interval)
+// Returns true if the data for the new interval could be derived from what
+// has already been tapped, or false if a retap is needed.
+bool IOGraph::setInterval(int interval)
 {
-    interval_ = interval;
+    bool derived = true;
+
+    if (interval != interval_) {
+        interval_ = interval;
+        if (data_valid_ && tap_interval_ > 0 && interval_ % tap_interval_ == 0) {
+            aggregateViewItems();
+            emit requestRecalc();
+        } else {
+            data_valid_ = false;
+            tapped_from_start_ = false;
+            derived = false;
+        }
+    }
     if (bars_) {
         bars_->setWidth(interval_ / SCALE_F);
     }
+    return derived;
 }
 
 // Get the value at the given interval (idx) for the current value unit.
@@ -566,33 +685,45 @@ double IOGraph::getItemValue(int idx, const capture_file* cap_file) const
 {
     ws_assert(idx < max_io_items_);
 
-    return get_io_graph_item(&items_[0], val_units_, idx, hf_index_, cap_file, interval_, cur_idx_, asAOT_);
+    return get_io_graph_item(viewItems(), val_units_, idx, hf_index_, cap_file, interval_, maxInterval(), asAOT_);
 }
 
 // "tap_reset" callback for register_tap_listener
 void IOGraph::tapReset(void* iog_ptr)
 {
     IOGraph* iog = static_cast<IOGraph*>(iog_ptr);
-    if (!iog) return;
+    if (!iog || iog->keep_data_) return;
 
     //    qDebug() << "=tapReset" << iog->name_;
     iog->clearAllData();
+    iog->tap_interval_ = iog->interval_;
+    iog->data_valid_ = false;
+    iog->tapped_from_start_ = true;
+    iog->truncated_ = false;
 }
 
 // "tap_packet" callback for register_tap_listener
 tap_packet_status IOGraph::tapPacket(void* iog_ptr, packet_info* pinfo, epan_dissect_t* edt, const void*, tap_flags_t)
 {
     IOGraph* iog = static_cast<IOGraph*>(iog_ptr);
-    if (!pinfo || !iog) {
+    if (!pinfo || !iog || iog->keep_data_) {
         return TAP_PACKET_DONT_REDRAW;
     }
 
-    int64_t tmp_idx = get_io_graph_index(pinfo, iog->interval_);
+    if (iog->tap_interval_ <= 0) {
+        iog->tap_interval_ = iog->interval_;
+    }
+    int64_t tmp_idx = get_io_graph_index(pinfo, iog->tap_interval_);
     bool recalc = false;
 
     /* some sanity checks */
     if ((tmp_idx < 0) || (tmp_idx >= max_io_items_)) {
         iog->cur_idx_ = (int)iog->items_.size() - 1;
+        if (tmp_idx >= max_io_items_) {
+            /* The items don't cover the whole capture, so they can't be
+             * aggregated to a larger interval; that needs a retap. */
+            iog->truncated_ = true;
+        }
         return TAP_PACKET_DONT_REDRAW;
     }
 
@@ -628,6 +759,7 @@ tap_packet_status IOGraph::tapPacket(void* iog_ptr, packet_info* pinfo, epan_dis
         catch (std::bad_alloc&) {
             // std::vector.resize() has strong exception safety
             ws_warning("Failed memory allocation!");
+            iog->truncated_ = true;
             return TAP_PACKET_DONT_REDRAW;
         }
         // resize zero-initializes new items, which is what we want
@@ -651,10 +783,14 @@ tap_packet_status IOGraph::tapPacket(void* iog_ptr, packet_info* pinfo, epan_dis
         adv_edt = edt;
     }
 
-    if (!update_io_graph_item(&iog->items_[0], idx, pinfo, adv_edt, iog->hf_index_, iog->val_units_, iog->interval_)) {
+    if (!update_io_graph_item(&iog->items_[0], idx, pinfo, adv_edt, iog->hf_index_, iog->val_units_, iog->tap_interval_)) {
         return TAP_PACKET_DONT_REDRAW;
     }
 
+    if (iog->tap_interval_ != iog->interval_) {
+        iog->view_dirty_ = true;
+    }
+
     //    qDebug() << "=tapPacket" << iog->name_ << idx << iog->hf_index_ << iog->val_units_ << iog->num_items_;
 
     if (recalc) {
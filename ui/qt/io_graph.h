@@ -82,11 +82,12 @@ public:
     void setValueUnitField(const QString& vu_field);
     nstime_t startTime() const;
     unsigned int movingAveragePeriod() const { return moving_avg_period_; }
-    void setInterval(int interval);
+    bool setInterval(int interval);
     int packetFromTime(double ts) const;
     bool hasItemToShow(int idx, double value) const;
     double getItemValue(int idx, const capture_file* cap_file) const;
-    int maxInterval() const { return cur_idx_; }
+    int maxInterval() const { return tap_interval_ == interval_ ? cur_idx_ : view_cur_idx_; }
+    bool keepDataForRetap(bool keep);
 
     void clearAllData();
 
@@ -112,6 +113,8 @@ private:
 
     bool showsZero() const;
     double startOffset() const;
+    const io_graph_item_t* viewItems() const;
+    void aggregateViewItems();
 
     template<class DataMap> double maxValueFromGraphData(const DataMap& map);
     template<class DataMap> void scaleGraphData(DataMap& map, int scalar);
@@ -119,6 +122,10 @@ private:
     QString config_err_;
     bool tap_registered_;
     bool need_retap_;
+    bool data_valid_; // items_ hold a complete tap of the current filter
+    bool keep_data_; // Skip the resets and packets of the next retap
+    bool tapped_from_start_; // Tap was reset since the filter last changed
+    bool truncated_; // Packets were dropped because the interval was too small
     QString filter_;
     QString full_filter_; // Includes vu_field_ if used
     io_graph_item_unit_t val_units_;
@@ -130,8 +137,15 @@ private:
 
     // Cached data. We should be able to change the Y axis without retapping as
     // much as is feasible.
+    // items_ are stored at the interval they were tapped with. If the
+    // displayed interval is a multiple of that, view_items_ are aggregated
+    // from them instead of retapping.
     std::vector<io_graph_item_t> items_;
     int cur_idx_;
+    int tap_interval_;
+    std::vector<io_graph_item_t> view_items_;
+    int view_cur_idx_;
+    bool view_dirty_;
 };
 
 #endif // IO_GRAPH_H
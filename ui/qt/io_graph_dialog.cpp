@@ -47,7 +47,10 @@
 // - Regular (non-stacked) bar graphs are drawn on top of each other on the Z axis.
 //   The QCP forum suggests drawing them side by side:
 //   https://www.qcustomplot.com/index.php/support/forum/62
-// - We retap and redraw more than we should.
+// - We redraw more than we should. Retaps are limited to the graphs whose
+//   data can't be reused (see IOGraph::keepDataForRetap), and interval
+//   changes are handled by aggregating when the new interval is a multiple
+//   of the tapped one, but a finer interval still requires a retap.
 // - Smoothing doesn't seem to match GTK+
 // - Closing the color picker on macOS sends the dialog to the background.
 // - X-axis time buckets are based on the file relative time, even in
@@ -1515,32 +1518,47 @@ void IOGraphDialog::updateStatistics()
      */
     if (need_retap_ && !file_closed_ && !retapDepth() && prefs.gui_io_graph_automatic_update) {
         need_retap_ = false;
-        QTimer::singleShot(0, &cap_file_, &CaptureFile::retapPackets);
-        // The user might have closed the window while tapping, which means
-        // we might no longer exist.
-    } else {
-        if (need_recalc_ && !file_closed_ && prefs.gui_io_graph_automatic_update) {
-            need_recalc_ = false;
-            need_replot_ = true;
-
-            emit recalcGraphData(cap_file_.capFile());
-            if (!tracer_->graph()) {
-                if (base_graph_ && base_graph_->data()->size() > 0) {
-                    tracer_->setGraph(base_graph_);
-                    tracer_->setVisible(true);
-                } else {
-                    tracer_->setVisible(false);
-                }
+        // Graphs whose data is still current sit the retap out. If none
+        // of them need it, there's nothing to retap.
+        bool retap_needed = false;
+        foreach (IOGraph *iog, ioGraphs_) {
+            if (!iog->keepDataForRetap(true)) {
+                retap_needed = true;
             }
         }
-        if (need_replot_) {
-            need_replot_ = false;
-            if (auto_axes_) {
-                resetAxes();
+        if (retap_needed) {
+            QTimer::singleShot(0, &cap_file_, &CaptureFile::retapPackets);
+            // The user might have closed the window while tapping, which means
+            // we might no longer exist.
+            return;
+        }
+        foreach (IOGraph *iog, ioGraphs_) {
+            iog->keepDataForRetap(false);
+        }
+        need_recalc_ = true;
+    }
+
+    if (need_recalc_ && !file_closed_ && prefs.gui_io_graph_automatic_update) {
+        need_recalc_ = false;
+        need_replot_ = true;
+
+        emit recalcGraphData(cap_file_.capFile());
+        if (!tracer_->graph()) {
+            if (base_graph_ && base_graph_->data()->size() > 0) {
+                tracer_->setGraph(base_graph_);
+                tracer_->setVisible(true);
+            } else {
+                tracer_->setVisible(false);
             }
-            ui->ioPlot->replot();
         }
     }
+    if (need_replot_) {
+        need_replot_ = false;
+        if (auto_axes_) {
+            resetAxes();
+        }
+        ui->ioPlot->replot();
+    }
 }
 
 void IOGraphDialog::loadProfileGraphs()
@@ -1609,6 +1627,7 @@ void IOGraphDialog::on_intervalComboBox_currentIndexChanged(int)
 {
     int interval = ui->intervalComboBox->itemData(ui->intervalComboBox->currentIndex()).toInt();
     bool need_retap = false;
+    bool need_recalc = false;
 
     precision_ = ceil(log10(SCALE_F / interval));
     if (precision_ < 0) {
@@ -1630,8 +1649,10 @@ void IOGraphDialog::on_intervalComboBox_currentIndexChanged(int)
         for (int row = 0; row < uat_model_->rowCount(); row++) {
             IOGraph *iog = ioGraphs_.value(row, NULL);
             if (iog) {
-                iog->setInterval(interval);
-                if (iog->visible()) {
+                if (iog->setInterval(interval)) {
+                    // Aggregated from the data we already have.
+                    need_recalc = true;
+                } else if (iog->visible()) {
                     need_retap = true;
                 } else {
                     iog->setNeedRetap(true);
@@ -1642,6 +1663,8 @@ void IOGraphDialog::on_intervalComboBox_currentIndexChanged(int)
 
     if (need_retap) {
         scheduleRetap(true);
+    } else if (need_recalc) {
+        scheduleRecalc(true);
     }
 }
 
@@ -39,7 +39,7 @@ ATapDataModel::ATapDataModel(dataModelType type, int protoId, QString filter, QO
     QAbstractListModel(parent)
 {
     hash_.conv_array = nullptr;
-    hash_.hashtable = nullptr;
+    hash_.index = nullptr;
     hash_.user_data = this;
 
     storage_ = nullptr;
@@ -9,6 +9,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <numeric>
 #include <stdexcept>
 
 #include "packet_list_model.h"
@@ -35,8 +36,11 @@
 #include <QColor>
 #include <QElapsedTimer>
 #include <QFontMetrics>
+#include <QHash>
 #include <QModelIndex>
 #include <QElapsedTimer>
+#include <QThread>
+#include <QtConcurrent>
 
 // Print timing information
 //#define DEBUG_PACKET_LIST_MODEL 1
@@ -75,7 +79,9 @@ packet_list_recreate_visible_rows(void)
 PacketListModel::PacketListModel(QObject *parent, capture_file *cf) :
     QAbstractItemModel(parent),
     number_to_row_(QVector<int>()),
-    idle_dissection_row_(0)
+    idle_dissection_row_(0),
+    prefetch_row_(0),
+    prefetch_last_(-1)
 {
     Q_ASSERT(glbl_plist_model == Q_NULLPTR);
     glbl_plist_model = this;
@@ -146,6 +152,8 @@ unsigned PacketListModel::recreateVisibleRows()
         endInsertRows();
     }
     idle_dissection_row_ = 0;
+    prefetch_row_ = 0;
+    prefetch_last_ = -1;
     return static_cast<unsigned>(visible_rows_.count());
 }
 
@@ -160,6 +168,8 @@ void PacketListModel::clear() {
     endResetModel();
     idle_dissection_timer_->invalidate();
     idle_dissection_row_ = 0;
+    prefetch_row_ = 0;
+    prefetch_last_ = -1;
 }
 
 void PacketListModel::invalidateAllColumnStrings()
@@ -543,32 +553,6 @@ void PacketListModel::sort(int column, Qt::SortOrder order)
 
     QString col_title = get_column_title(column);
 
-    /* Make sure we're actually going to sort. Note that the header
-     * has no way of knowing that sorting failed, so in these cases
-     * the sort indicator have the value that the user requested
-     * regardless.
-     */
-    if (PacketListRecord::textColumn(column) >= 0 && (unsigned)visible_rows_.count() > prefs.gui_packet_list_cached_rows_max) {
-        /* Column not based on frame data but by column text that requires
-         * dissection, so to sort in a reasonable amount of time the column
-         * text needs to be cached.
-         */
-        /* If the sort is being triggered because the columns were already
-         * sorted and the filter is being cleared (or changed to something
-         * else with more rows than fit in the cache), then the temporary
-         * message will be immediately overwritten with the standard capture
-         * statistics by the packets_bar_update() call after thawing the rows.
-         * It will still blink yellow, and the user will get the message if
-         * they then click on the header file (wondering why it didn't sort.)
-         */
-        if (col_title.isEmpty()) {
-            col_title = tr("Column");
-        }
-        QString temp_msg = tr("%1 can only be sorted with %2 or fewer visible rows; increase cache size in Layout preferences").arg(col_title).arg(prefs.gui_packet_list_cached_rows_max);
-        mainApp->pushStatus(MainApplication::TemporaryStatus, temp_msg);
-        return;
-    }
-
     /* If we are currently in the middle of reading the capture file, don't
      * sort. PacketList::captureFileReadFinished invalidates all the cached
      * column strings and then tries to sort again.
@@ -606,13 +590,17 @@ void PacketListModel::sort(int column, Qt::SortOrder order)
     }
     stop_flag_ = false;
     comps_ = 0;
-    /* XXX: The expected number of comparisons is O(N log N), but this could
-     * be a pretty significant overestimate of the amount of time it takes,
-     * if there are lots of identical entries. (Especially with string
-     * comparisons, some comparisons are faster than others.) Better to
-     * overestimate?
-     */
-    exp_comps_ = log2(visible_rows_.count()) * visible_rows_.count();
+    if (text_sort_column_ < 0) {
+        /* XXX: The expected number of comparisons is O(N log N), but this
+         * could be a pretty significant overestimate of the amount of time
+         * it takes, if there are lots of identical entries. Better to
+         * overestimate?
+         */
+        exp_comps_ = log2(visible_rows_.count()) * visible_rows_.count();
+    } else {
+        /* Progress is measured in rows whose sort key has been extracted. */
+        exp_comps_ = visible_rows_.count();
+    }
     progress_frame_ = nullptr;
     if (MainWindow *mw = mainApp->mainWindow()) {
         progress_frame_ = mw->findChild<ProgressFrame *>();
@@ -627,7 +615,11 @@ void PacketListModel::sort(int column, Qt::SortOrder order)
     sort_column_is_numeric_ = isNumericColumn(sort_column_);
     QVector<PacketListRecord *> sorted_visible_rows_ = visible_rows_;
     try {
-        std::sort(sorted_visible_rows_.begin(), sorted_visible_rows_.end(), recordLessThan);
+        if (text_sort_column_ < 0) {
+            std::sort(sorted_visible_rows_.begin(), sorted_visible_rows_.end(), recordLessThan);
+        } else {
+            sortByColumnKeys(sorted_visible_rows_);
+        }
 
         beginResetModel();
         visible_rows_.resize(0);
@@ -766,47 +758,166 @@ bool PacketListModel::recordLessThan(PacketListRecord *r1, PacketListRecord *r2)
     if (sort_column_ < 0) {
         // No column.
         cmp_val = frame_data_compare(sort_cap_file_->epan, r1->frameData(), r2->frameData(), COL_NUMBER);
-    } else if (text_sort_column_ < 0) {
-        // Column comes directly from frame data
+    } else {
+        // Column comes directly from frame data. Text columns are sorted
+        // by sortByColumnKeys.
         cmp_val = frame_data_compare(sort_cap_file_->epan, r1->frameData(), r2->frameData(), sort_cap_file_->cinfo.columns[sort_column_].col_fmt);
-    } else  {
-        QString r1String = r1->columnString(sort_cap_file_, sort_column_);
-        QString r2String = r2->columnString(sort_cap_file_, sort_column_);
-        // XXX: The naive string comparison compares Unicode code points.
-        // Proper collation is more expensive
-        cmp_val = r1String.compare(r2String);
-        if (cmp_val != 0 && sort_column_is_numeric_) {
-            // Custom column with numeric data (or something like a port number).
-            // Attempt to convert to numbers.
-            // XXX This is slow. Can we avoid doing this? Perhaps the actual
-            // values used for sorting should be cached too as QVariant[List].
-            // If so, we could consider using QCollatorSortKeys or similar
-            // for strings as well.
-            bool ok_r1, ok_r2;
-            double num_r1 = parseNumericColumn(r1String, &ok_r1);
-            double num_r2 = parseNumericColumn(r2String, &ok_r2);
-
-            if (!ok_r1 && !ok_r2) {
-                cmp_val = 0;
-            } else if (!ok_r1 || (ok_r2 && num_r1 < num_r2)) {
-                // either r1 is invalid (and sort it before others) or both
-                // r1 and r2 are valid (sort normally)
-                cmp_val = -1;
-            } else if (!ok_r2 || (num_r1 > num_r2)) {
-                cmp_val = 1;
+    }
+
+    if (sort_order_ == Qt::AscendingOrder) {
+        return cmp_val < 0;
+    } else {
+        return cmp_val > 0;
+    }
+}
+
+// The sort key of a row for a column whose text requires dissection.
+// For numeric columns value is the parsed number, for other columns it is
+// the rank of the column string among all distinct strings of the column.
+struct ColumnSortKey {
+    double value;
+    PacketListRecord *record;
+    uint32_t num;
+    bool valid;     // false if a numeric column has no numeric value
+};
+
+static bool columnSortKeyLessThan(const ColumnSortKey &k1, const ColumnSortKey &k2)
+{
+    // Rows without a numeric value sort before the others.
+    if (k1.valid != k2.valid) {
+        return !k1.valid;
+    }
+    if (k1.valid && k1.value != k2.value) {
+        return k1.value < k2.value;
+    }
+    // All else being equal, compare frame numbers.
+    return k1.num < k2.num;
+}
+
+// Sorts keys with std::sort on one chunk per thread, then merges the chunks
+// pairwise, also in parallel.
+static void parallelSortColumnKeys(QVector<ColumnSortKey> &keys)
+{
+    const qsizetype min_chunk_len = 65536;
+    const qsizetype n_keys = keys.size();
+    const qsizetype n_chunks = std::min<qsizetype>(QThread::idealThreadCount(), n_keys / min_chunk_len);
+    // Detach before the worker threads access the data.
+    ColumnSortKey *data = keys.data();
+
+    if (n_chunks < 2) {
+        std::sort(data, data + n_keys, columnSortKeyLessThan);
+        return;
+    }
+
+    QVector<QPair<qsizetype, qsizetype>> ranges;
+    for (qsizetype i = 0; i < n_chunks; i++) {
+        ranges << qMakePair(n_keys * i / n_chunks, n_keys * (i + 1) / n_chunks);
+    }
+    QtConcurrent::blockingMap(ranges, [data](QPair<qsizetype, qsizetype> &range) {
+        std::sort(data + range.first, data + range.second, columnSortKeyLessThan);
+    });
+
+    while (ranges.size() > 1) {
+        struct MergeRange { qsizetype first, middle, last; };
+        QVector<MergeRange> merges;
+        QVector<QPair<qsizetype, qsizetype>> merged_ranges;
+        for (qsizetype i = 0; i + 1 < ranges.size(); i += 2) {
+            merges << MergeRange { ranges[i].first, ranges[i].second, ranges[i + 1].second };
+            merged_ranges << qMakePair(ranges[i].first, ranges[i + 1].second);
+        }
+        if (ranges.size() % 2) {
+            merged_ranges << ranges.last();
+        }
+        QtConcurrent::blockingMap(merges, [data](MergeRange &merge) {
+            std::inplace_merge(data + merge.first, data + merge.middle, data + merge.last, columnSortKeyLessThan);
+        });
+        ranges = merged_ranges;
+    }
+}
+
+// Sorts by a column whose text requires dissection. Instead of fetching
+// (and possibly dissecting) both column strings in every comparison, each
+// row is dissected once to extract a compact typed key, then the keys are
+// sorted. This does not depend on the column text cache, so it works for
+// any number of rows.
+void PacketListModel::sortByColumnKeys(QVector<PacketListRecord *> &rows)
+{
+    QVector<ColumnSortKey> keys;
+    QHash<QString, qsizetype> string_ids;
+    QVector<QString> strings;
+
+    keys.reserve(rows.size());
+    foreach (PacketListRecord *record, rows) {
+        ColumnSortKey key;
+        const QString col_str = record->columnString(sort_cap_file_, sort_column_);
+
+        key.record = record;
+        key.num = record->frameData()->num;
+        if (sort_column_is_numeric_) {
+            // Custom column with numeric data (or something like a port
+            // number). Strings which differ but have the same numeric value
+            // compare equal.
+            key.value = parseNumericColumn(col_str, &key.valid);
+            if (std::isnan(key.value)) {
+                key.valid = false;
+            }
+        } else {
+            // Intern the string, it is replaced by its rank below.
+            qsizetype id = string_ids.value(col_str, -1);
+            if (id < 0) {
+                id = strings.size();
+                string_ids.insert(col_str, id);
+                strings << col_str;
             }
+            key.value = id;
+            key.valid = true;
         }
+        keys << key;
+
+        comps_++;
+        if (busy_timer_.elapsed() > busy_timeout_) {
+            if (progress_frame_) {
+                progress_frame_->setValue(static_cast<int>(comps_/exp_comps_ * 100));
+            }
+            mainApp->processEvents(QEventLoop::ExcludeSocketNotifiers, 1);
+            if (stop_flag_) {
+                throw SortAbort("Sorting aborted");
+            }
+            busy_timer_.restart();
+        }
+    }
 
-        if (cmp_val == 0) {
-            // All else being equal, compare column numbers.
-            cmp_val = frame_data_compare(sort_cap_file_->epan, r1->frameData(), r2->frameData(), COL_NUMBER);
+    if (!sort_column_is_numeric_) {
+        // XXX: The naive string comparison compares Unicode code points.
+        // Proper collation is more expensive
+        QVector<qsizetype> order(strings.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&strings](qsizetype s1, qsizetype s2) {
+            return strings[s1].compare(strings[s2]) < 0;
+        });
+        QVector<qsizetype> rank(strings.size());
+        for (qsizetype i = 0; i < order.size(); i++) {
+            rank[order[i]] = i;
+        }
+        string_ids.clear();
+        strings.clear();
+        for (ColumnSortKey &key : keys) {
+            key.value = static_cast<double>(rank[static_cast<qsizetype>(key.value)]);
         }
     }
 
+    parallelSortColumnKeys(keys);
+
+    // Frame numbers are unique, so descending order is the exact reverse.
+    rows.resize(0);
     if (sort_order_ == Qt::AscendingOrder) {
-        return cmp_val < 0;
+        for (const ColumnSortKey &key : keys) {
+            rows << key.record;
+        }
     } else {
-        return cmp_val > 0;
+        for (qsizetype i = keys.size(); i > 0; i--) {
+            rows << keys[i - 1].record;
+        }
     }
 }
 
@@ -978,6 +1089,54 @@ void PacketListModel::dissectIdle(bool reset)
     emit bgColorizationProgress(first+1, idle_dissection_row_+1);
 }
 
+// Dissect the rows the view asked for (typically the ones around the
+// viewport) so that they can be painted from the cache. Like the idle
+// colorization this runs on the main thread in short slices, since
+// dissection isn't thread safe; a new request replaces the pending one.
+void PacketListModel::prefetchRows(int first, int last)
+{
+    bool idle = prefetch_row_ > prefetch_last_;
+
+    prefetch_row_ = qMax(first, 0);
+    prefetch_last_ = qMin(last, static_cast<int>(visible_rows_.count()) - 1);
+
+    if (idle && prefetch_row_ <= prefetch_last_) {
+        QTimer::singleShot(0, this, &PacketListModel::prefetchIdle);
+    }
+}
+
+void PacketListModel::prefetchIdle()
+{
+    if (prefetch_row_ > prefetch_last_) {
+        return;
+    }
+
+    if (!cap_file_ || cap_file_->read_lock) {
+        // File is in use (at worst, being rescanned). Try again later.
+        QTimer::singleShot(idle_dissection_interval_, this, &PacketListModel::prefetchIdle);
+        return;
+    }
+
+    QElapsedTimer prefetch_timer;
+    prefetch_timer.start();
+    while (prefetch_timer.elapsed() < idle_dissection_interval_
+           && prefetch_row_ <= prefetch_last_
+           && prefetch_row_ < visible_rows_.count()) {
+        PacketListRecord *record = visible_rows_[prefetch_row_];
+        if (record) {
+            record->ensureCached(cap_file_);
+        }
+        prefetch_row_++;
+    }
+
+    if (prefetch_row_ <= prefetch_last_ && prefetch_row_ < visible_rows_.count()) {
+        QTimer::singleShot(0, this, &PacketListModel::prefetchIdle);
+    } else {
+        prefetch_last_ = -1;
+        prefetch_row_ = 0;
+    }
+}
+
 // XXX Pass in cinfo from packet_list_append so that we can fill in
 // line counts?
 int PacketListModel::appendPacket(frame_data *fdata)
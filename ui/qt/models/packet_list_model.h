@@ -57,6 +57,11 @@ public:
     frame_data *getRowFdata(QModelIndex idx) const;
     frame_data *getRowFdata(int row) const;
     void ensureRowColorized(int row);
+    /**
+     * @brief Colorize and cache the column strings of a range of rows
+     * ahead of the idle colorization, e.g. the rows around the viewport.
+     */
+    void prefetchRows(int first, int last);
     int visibleIndexOf(frame_data *fdata) const;
     /**
      * @brief Invalidate any cached column strings.
@@ -104,6 +109,7 @@ private:
     static Qt::SortOrder sort_order_;
     static capture_file *sort_cap_file_;
     static bool recordLessThan(PacketListRecord *r1, PacketListRecord *r2);
+    static void sortByColumnKeys(QVector<PacketListRecord *> &rows);
     static double parseNumericColumn(const QString &val, bool *ok);
 
     static bool stop_flag_;
@@ -113,8 +119,13 @@ private:
 
     QElapsedTimer *idle_dissection_timer_;
     int idle_dissection_row_;
+    int prefetch_row_;
+    int prefetch_last_;
 
     bool isNumericColumn(int column);
+
+private slots:
+    void prefetchIdle();
 };
 
 #endif // PACKET_LIST_MODEL_H
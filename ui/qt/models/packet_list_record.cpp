@@ -58,6 +58,23 @@ void PacketListRecord::ensureColorized(capture_file *cap_file)
     }
 }
 
+void PacketListRecord::ensureCached(capture_file *cap_file)
+{
+    Q_ASSERT(fdata_);
+
+    if (!cap_file) {
+        return;
+    }
+
+    bool dissect_color = !colorized_ || ( color_ver_ != rows_color_ver_ );
+    bool dissect_columns = !col_text_cache_.contains(fdata_->num);
+    if (dissect_color || dissect_columns) {
+        // Always fill in the columns; a single dissection is far more
+        // expensive than formatting them.
+        dissect(cap_file, true, dissect_color);
+    }
+}
+
 // We might want to return a const char * instead. This would keep us from
 // creating excessive QByteArrays, e.g. in PacketListModel::recordLessThan.
 const QString PacketListRecord::columnString(capture_file *cap_file, int column, bool colorized)
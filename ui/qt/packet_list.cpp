@@ -285,6 +285,7 @@ PacketList::PacketList(QWidget *parent) :
     connect(header(), &QHeaderView::sectionMoved, this, &PacketList::sectionMoved);
 
     connect(verticalScrollBar(), &QScrollBar::actionTriggered, this, &PacketList::vScrollBarActionTriggered);
+    connect(verticalScrollBar(), &QScrollBar::valueChanged, this, &PacketList::prefetchNearViewport);
 }
 
 PacketList::~PacketList()
@@ -2222,6 +2223,23 @@ void PacketList::vScrollBarActionTriggered(int)
     scrollViewChanged(tail_at_end_);
 }
 
+// Have the model dissect the page above and below the viewport ahead
+// of time, so that scrolling doesn't wait for each row to be dissected.
+void PacketList::prefetchNearViewport()
+{
+    if (!packet_list_model_ || packet_list_model_->rowCount() < 1) {
+        return;
+    }
+
+    QModelIndex first_idx = indexAt(viewport()->rect().topLeft());
+    QModelIndex last_idx = indexAt(viewport()->rect().bottomLeft());
+    int first = first_idx.isValid() ? first_idx.row() : 0;
+    int last = last_idx.isValid() ? last_idx.row() : packet_list_model_->rowCount() - 1;
+    int page = last - first + 1;
+
+    packet_list_model_->prefetchRows(first - page, last + page);
+}
+
 void PacketList::scrollViewChanged(bool at_end)
 {
     if (capture_in_progress_) {
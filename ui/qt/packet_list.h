@@ -217,6 +217,7 @@ private slots:
     void sectionMoved(int, int, int);
     void copySummary();
     void vScrollBarActionTriggered(int);
+    void prefetchNearViewport();
     void drawFarOverlay();
     void drawNearOverlay();
     void updatePackets(bool redraw);
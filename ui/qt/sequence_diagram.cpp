@@ -209,6 +209,15 @@ void SequenceDiagram::setSelectedPacket(int selected_packet)
     } else {
         selected_packet_ = 0;
     }
+    // draw() only looks at the visible items, so find the key here.
+    if (selected_packet_ > 0) {
+        for (WSCPSeqDataMap::const_iterator it = data_->constBegin(); it != data_->constEnd(); ++it) {
+            if (it.value().value->frame_number == selected_packet_) {
+                selected_key_ = it.key();
+                break;
+            }
+        }
+    }
     mParentPlot->replot();
 }
 
@@ -268,8 +277,12 @@ void SequenceDiagram::draw(QCPPainter *painter)
     painter->restore();
     fg_pen = pen();
 
+    // Only visit the items in the visible key range; the diagram may
+    // contain far more items than fit on the screen.
+    double first_key = key_axis_->range().lower - 1.0;
+    double last_key = key_axis_->range().upper + 1.0;
     WSCPSeqDataMap::const_iterator it;
-    for (it = data_->constBegin(); it != data_->constEnd(); ++it) {
+    for (it = data_->lowerBound(first_key); it != data_->constEnd() && it.key() <= last_key; ++it) {
         double cur_key = it.key();
         seq_analysis_item_t *sai = it.value().value;
         QColor bg_color;
@@ -386,18 +399,11 @@ QCPRange SequenceDiagram::getKeyRange(bool &validRange, QCP::SignDomain) const
     QCPRange range;
     bool valid = false;
 
-    WSCPSeqDataMap::const_iterator it = data_->constBegin();
-    while (it != data_->constEnd()) {
-        double cur_key = it.key();
-        if (!valid) {
-            range.lower = range.upper = cur_key;
-            valid = true;
-        } else if (cur_key < range.lower) {
-            range.lower = cur_key;
-        } else if (cur_key > range.upper) {
-            range.upper = cur_key;
-        }
-        ++it;
+    // The map is ordered by key.
+    if (!data_->isEmpty()) {
+        range.lower = data_->firstKey();
+        range.upper = data_->lastKey();
+        valid = true;
     }
     validRange = valid;
     return range;
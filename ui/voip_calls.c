@@ -501,22 +501,24 @@ static void insert_to_graph_t38(voip_calls_tapinfo_t *tapinfo, packet_info *pinf
 
     inserted = false;
 
-    list = g_queue_peek_nth_link(tapinfo->graph_analysis->items, 0);
+    /* The frame is usually one of the last ones, so look for the
+     * position from the end of the list. */
+    list = g_queue_peek_tail_link(tapinfo->graph_analysis->items);
     while (list)
     {
         gai = (seq_analysis_item_t *)list->data;
-        if (gai->frame_number > frame_num) {
-            g_queue_insert_before(tapinfo->graph_analysis->items, list, new_gai);
+        if (gai->frame_number <= frame_num) {
+            g_queue_insert_after(tapinfo->graph_analysis->items, list, new_gai);
             g_hash_table_insert(tapinfo->graph_analysis->ht, GUINT_TO_POINTER(new_gai->frame_number), new_gai);
             inserted = true;
             break;
         }
-        list = g_list_next(list);
+        list = g_list_previous(list);
     }
 
     if (!inserted) {
-        /* Just add to the end */
-        g_queue_push_tail(tapinfo->graph_analysis->items, new_gai);
+        /* Before all of the items */
+        g_queue_push_head(tapinfo->graph_analysis->items, new_gai);
         g_hash_table_insert(tapinfo->graph_analysis->ht, GUINT_TO_POINTER(new_gai->frame_number), new_gai);
     }
 }
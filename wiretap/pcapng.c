@@ -905,6 +905,7 @@ pcapng_process_options(FILE_T fh, wtapng_block_t *wblock,
                        pcapng_opt_byte_order_e byte_order,
                        int *err, char **err_info)
 {
+    uint32_t option_buf[64];  /* Small option areas, e.g. just packet flags */
     uint8_t *option_content; /* Allocate as large as the options block */
     unsigned opt_bytes_remaining;
     const uint8_t *option_ptr;
@@ -918,25 +919,34 @@ pcapng_process_options(FILE_T fh, wtapng_block_t *wblock,
         return true;
     }
 
-    /* Allocate enough memory to hold all options */
-    option_content = (uint8_t *)g_try_malloc(opt_cont_buf_len);
-    if (option_content == NULL) {
-        *err = ENOMEM;  /* we assume we're out of memory */
-        return false;
+    /*
+     * Allocate enough memory to hold all options, unless they fit
+     * in the buffer on the stack, as they do for most packet blocks.
+     */
+    if (opt_cont_buf_len <= sizeof option_buf) {
+        option_content = (uint8_t *)option_buf;
+    } else {
+        option_content = (uint8_t *)g_try_malloc(opt_cont_buf_len);
+        if (option_content == NULL) {
+            *err = ENOMEM;  /* we assume we're out of memory */
+            return false;
+        }
     }
 
     /* Read all the options into the buffer */
     if (!wtap_read_bytes(fh, option_content, opt_cont_buf_len, err, err_info)) {
         ws_debug("failed to read options");
-        g_free(option_content);
+        if (option_content != (uint8_t *)option_buf)
+            g_free(option_content);
         return false;
     }
 
     /*
      * Now process them.
      * option_ptr starts out aligned on at least a 4-byte boundary, as
-     * that's what g_try_malloc() gives us, and each option is padded
-     * to a length that's a multiple of 4 bytes, so it remains aligned.
+     * that's what g_try_malloc() and the uint32_t stack buffer give us,
+     * and each option is padded to a length that's a multiple of 4 bytes,
+     * so it remains aligned.
      */
     option_ptr = &option_content[0];
     opt_bytes_remaining = opt_cont_buf_len;
@@ -947,7 +957,8 @@ pcapng_process_options(FILE_T fh, wtapng_block_t *wblock,
         if (sizeof (*oh) > opt_bytes_remaining) {
             *err = WTAP_ERR_BAD_FILE;
             *err_info = ws_strdup_printf("pcapng: Not enough data for option header");
-            g_free(option_content);
+            if (option_content != (uint8_t *)option_buf)
+                g_free(option_content);
             return false;
         }
         option_code = oh->option_code;
@@ -989,7 +1000,8 @@ pcapng_process_options(FILE_T fh, wtapng_block_t *wblock,
             *err = WTAP_ERR_BAD_FILE;
             *err_info = ws_strdup_printf("pcapng: Not enough data to handle option of length %u",
                                         option_length);
-            g_free(option_content);
+            if (option_content != (uint8_t *)option_buf)
+                g_free(option_content);
             return false;
         }
 
@@ -1013,7 +1025,8 @@ pcapng_process_options(FILE_T fh, wtapng_block_t *wblock,
                                                          option_ptr,
                                                          byte_order,
                                                          err, err_info)) {
-                    g_free(option_content);
+                    if (option_content != (uint8_t *)option_buf)
+                        g_free(option_content);
                     return false;
                 }
                 break;
@@ -1025,7 +1038,8 @@ pcapng_process_options(FILE_T fh, wtapng_block_t *wblock,
                                                   option_ptr,
                                                   byte_order,
                                                   err, err_info)) {
-                    g_free(option_content);
+                    if (option_content != (uint8_t *)option_buf)
+                        g_free(option_content);
                     return false;
                 }
                 break;
@@ -1034,7 +1048,8 @@ pcapng_process_options(FILE_T fh, wtapng_block_t *wblock,
                     !(*process_option)(wblock, section_info, option_code,
                                        option_length, option_ptr,
                                        err, err_info)) {
-                    g_free(option_content);
+                    if (option_content != (uint8_t *)option_buf)
+                        g_free(option_content);
                     return false;
                 }
                 break;
@@ -1042,7 +1057,8 @@ pcapng_process_options(FILE_T fh, wtapng_block_t *wblock,
         option_ptr += rounded_option_length; /* multiple of 4 bytes, so it remains aligned */
         opt_bytes_remaining -= rounded_option_length;
     }
-    g_free(option_content);
+    if (option_content != (uint8_t *)option_buf)
+        g_free(option_content);
     return true;
 }
 
@@ -2004,7 +2020,11 @@ pcapng_read_packet_block(wtap *wth _U_, FILE_T fh, uint32_t block_type,
     int fcslen;
     bool enhanced = (block_type == BLOCK_TYPE_EPB);
 
-    wblock->block = wtap_block_create(WTAP_BLOCK_PACKET);
+    /*
+     * The packet block is only created if there's something to put
+     * in it; see below.
+     */
+    wblock->block = NULL;
 
     if (enhanced) {
         /*
@@ -2192,28 +2212,41 @@ pcapng_read_packet_block(wtap *wth _U_, FILE_T fh, uint32_t block_type,
 
     /* Options */
     opt_cont_buf_len = block_content_length - block_read;
+
+    /*
+     * Most packets have no options and, if they're in an EPB, no drop
+     * count either; don't allocate a block for them, as a record
+     * without a block has no options. Consumers that want to add
+     * options to such a record have to create a block themselves.
+     */
+    if (opt_cont_buf_len != 0 || packet.drops_count != 0xFFFF) {
+        wblock->block = wtap_block_create(WTAP_BLOCK_PACKET);
+    }
+
     if (!pcapng_process_options(fh, wblock, section_info, opt_cont_buf_len,
                                 pcapng_process_packet_block_option,
                                 OPT_SECTION_BYTE_ORDER, err, err_info))
         return false;
 
-    /*
-     * Did we get a packet flags option?
-     */
-    if (WTAP_OPTTYPE_SUCCESS == wtap_block_get_uint32_option_value(wblock->block, OPT_PKT_FLAGS, &flags)) {
-        if (PACK_FLAGS_FCS_LENGTH(flags) != 0) {
-            /*
-             * The FCS length is present, but in units of octets, not
-             * bits; convert it to bits.
-             */
-            fcslen = PACK_FLAGS_FCS_LENGTH(flags)*8;
+    if (wblock->block != NULL) {
+        /*
+         * Did we get a packet flags option?
+         */
+        if (WTAP_OPTTYPE_SUCCESS == wtap_block_get_uint32_option_value(wblock->block, OPT_PKT_FLAGS, &flags)) {
+            if (PACK_FLAGS_FCS_LENGTH(flags) != 0) {
+                /*
+                 * The FCS length is present, but in units of octets, not
+                 * bits; convert it to bits.
+                 */
+                fcslen = PACK_FLAGS_FCS_LENGTH(flags)*8;
+            }
+        }
+        /*
+         * How about a drop_count option? If not, set it from other sources
+         */
+        if (WTAP_OPTTYPE_SUCCESS != wtap_block_get_uint64_option_value(wblock->block, OPT_PKT_DROPCOUNT, &tmp64) && packet.drops_count != 0xFFFF) {
+            wtap_block_add_uint64_option(wblock->block, OPT_PKT_DROPCOUNT, (uint64_t)packet.drops_count);
         }
-    }
-    /*
-     * How about a drop_count option? If not, set it from other sources
-     */
-    if (WTAP_OPTTYPE_SUCCESS != wtap_block_get_uint64_option_value(wblock->block, OPT_PKT_DROPCOUNT, &tmp64) && packet.drops_count != 0xFFFF) {
-        wtap_block_add_uint64_option(wblock->block, OPT_PKT_DROPCOUNT, (uint64_t)packet.drops_count);
     }
 
     pcap_read_post_process(false, iface_info.wtap_encap, wblock->rec,
@@ -15,9 +15,19 @@
 
 #include "config.h"
 
+/* See ws_mempbrk.c for why SSE4.2 isn't used with older Apple compilers. */
+#ifdef __APPLE__
+#if !(defined(__clang__) && (__clang_major__ >= 6))
+#undef HAVE_SSE4_2
+#endif
+#endif
+
 #include <wsutil/crc32.h>
+#include <wsutil/pint.h>
 #include <wsutil/zlib_compat.h>
 
+#include "crc32_int.h"
+
 #define CRC32_ACCUMULATE(c,d,table) (c=(c>>8)^(table)[(c^(d))&0xFF])
 
 /*****************************************************************/
@@ -365,24 +375,113 @@ crc32_ccitt_table_lookup (unsigned char pos)
 	return crc32_ccitt_table[pos];
 }
 
+/*
+ * Slicing-by-8 tables, which let us process 8 bytes at a time with 8
+ * independent table lookups instead of 8 dependent ones. Entry i of
+ * table k is the CRC of byte i followed by k zero bytes, so table 0 is
+ * the byte-at-a-time table. They're built the first time they're needed.
+ */
+static uint32_t crc32c_slice[8][256];
+static uint32_t crc32_mpeg2_slice[8][256];
+#if !defined (HAVE_ZLIB) && !defined (HAVE_ZLIBNG)
+static uint32_t crc32_ccitt_slice[8][256];
+#endif
+
+static uint32_t crc32c_no_swap_slice8(const uint8_t *buf, size_t len, uint32_t crc);
+
+/* CRC32C implementation to use, chosen according to what the CPU supports */
+static uint32_t (*crc32c_no_swap_impl)(const uint8_t *buf, size_t len, uint32_t crc);
+
+/* Tables for a reflected (least significant bit first) CRC */
+static void
+crc32_reflected_slice_init(uint32_t slice[8][256], const uint32_t table[256])
+{
+	int i, k;
+
+	for (i = 0; i < 256; i++)
+		slice[0][i] = table[i];
+	for (k = 1; k < 8; k++)
+		for (i = 0; i < 256; i++)
+			slice[k][i] = (slice[k-1][i] >> 8) ^ table[slice[k-1][i] & 0xFF];
+}
+
+/* Tables for a normal (most significant bit first) CRC */
+static void
+crc32_normal_slice_init(uint32_t slice[8][256], const uint32_t table[256])
+{
+	int i, k;
+
+	for (i = 0; i < 256; i++)
+		slice[0][i] = table[i];
+	for (k = 1; k < 8; k++)
+		for (i = 0; i < 256; i++)
+			slice[k][i] = (slice[k-1][i] << 8) ^ table[slice[k-1][i] >> 24];
+}
+
+static void
+crc32_init(void)
+{
+	static size_t initialized;
+
+	if (g_once_init_enter(&initialized)) {
+		crc32_reflected_slice_init(crc32c_slice, crc32c_table);
+		crc32_normal_slice_init(crc32_mpeg2_slice, crc32_mpeg2_table);
+#if !defined (HAVE_ZLIB) && !defined (HAVE_ZLIBNG)
+		crc32_reflected_slice_init(crc32_ccitt_slice, crc32_ccitt_table);
+#endif
+
+		crc32c_no_swap_impl = crc32c_no_swap_slice8;
+#ifdef HAVE_SSE4_2
+		if (crc32c_sse42_available())
+			crc32c_no_swap_impl = crc32c_no_swap_sse42;
+#endif
+		g_once_init_leave(&initialized, 1);
+	}
+}
+
+static uint32_t
+crc32_reflected_slice8(const uint32_t slice[8][256], const uint8_t *buf, size_t len, uint32_t crc)
+{
+	uint32_t lo, hi;
+
+	while (len >= 8) {
+		lo = pletoh32(buf) ^ crc;
+		hi = pletoh32(buf + 4);
+		crc = slice[7][lo & 0xFF] ^ slice[6][(lo >> 8) & 0xFF] ^
+		      slice[5][(lo >> 16) & 0xFF] ^ slice[4][lo >> 24] ^
+		      slice[3][hi & 0xFF] ^ slice[2][(hi >> 8) & 0xFF] ^
+		      slice[1][(hi >> 16) & 0xFF] ^ slice[0][hi >> 24];
+		buf += 8;
+		len -= 8;
+	}
+	while (len-- > 0)
+		CRC32_ACCUMULATE(crc, *buf++, slice[0]);
+
+	return crc;
+}
+
+static uint32_t
+crc32c_no_swap_slice8(const uint8_t *buf, size_t len, uint32_t crc)
+{
+	return crc32_reflected_slice8(crc32c_slice, buf, len, crc);
+}
+
 uint32_t
 crc32c_calculate(const void *buf, int len, uint32_t crc)
 {
-	const uint8_t *p = (const uint8_t *)buf;
+	crc32_init();
 	crc = CRC32C_SWAP(crc);
-	while (len-- > 0) {
-		CRC32C(crc, *p++);
-	}
+	if (len > 0)
+		crc = crc32c_no_swap_impl((const uint8_t *)buf, len, crc);
 	return CRC32C_SWAP(crc);
 }
 
 uint32_t
 crc32c_calculate_no_swap(const void *buf, int len, uint32_t crc)
 {
-	const uint8_t *p = (const uint8_t *)buf;
-	while (len-- > 0) {
-		CRC32C(crc, *p++);
-	}
+	crc32_init();
+	if (len > 0)
+		crc = crc32c_no_swap_impl((const uint8_t *)buf, len, crc);
 
 	return crc;
 }
@@ -399,26 +498,31 @@ crc32_ccitt_seed(const uint8_t *buf, unsigned len, uint32_t seed)
 #if defined (HAVE_ZLIB) || defined (HAVE_ZLIBNG)
 	return (unsigned)ZLIB_PREFIX(crc32)(~seed, buf, len);
 #else /* USE_ZLIB_OR_ZLIBNG */
-	unsigned i;
-	uint32_t crc32 = seed;
-
-	for (i = 0; i < len; i++)
-		CRC32_ACCUMULATE(crc32, buf[i], crc32_ccitt_table);
-
-	return ( ~crc32 );
+	crc32_init();
+	return ( ~crc32_reflected_slice8(crc32_ccitt_slice, buf, len, seed) );
 #endif /* USE_ZLIB_OR_ZLIBNG */
 }
 
 uint32_t
 crc32_mpeg2_seed(const uint8_t *buf, unsigned len, uint32_t seed)
 {
-	unsigned i;
-	uint32_t crc32;
+	uint32_t crc32, hi, lo;
 
+	crc32_init();
 	crc32 = seed;
 
-	for (i = 0; i < len; i++)
-		crc32 = (crc32 << 8) ^ crc32_mpeg2_table[((crc32 >> 24) ^ buf[i]) & 0xff];
+	while (len >= 8) {
+		hi = pntoh32(buf) ^ crc32;
+		lo = pntoh32(buf + 4);
+		crc32 = crc32_mpeg2_slice[7][hi >> 24] ^ crc32_mpeg2_slice[6][(hi >> 16) & 0xFF] ^
+			crc32_mpeg2_slice[5][(hi >> 8) & 0xFF] ^ crc32_mpeg2_slice[4][hi & 0xFF] ^
+			crc32_mpeg2_slice[3][lo >> 24] ^ crc32_mpeg2_slice[2][(lo >> 16) & 0xFF] ^
+			crc32_mpeg2_slice[1][(lo >> 8) & 0xFF] ^ crc32_mpeg2_slice[0][lo & 0xFF];
+		buf += 8;
+		len -= 8;
+	}
+	while (len-- > 0)
+		crc32 = (crc32 << 8) ^ crc32_mpeg2_table[((crc32 >> 24) ^ *buf++) & 0xff];
 
 	return ( crc32 );
 }
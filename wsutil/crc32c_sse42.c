@@ -0,0 +1,76 @@
+/* crc32c_sse42.c
+ * CRC32C using the SSE4.2 crc32 instruction
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#ifdef HAVE_SSE4_2
+
+#include <glib.h>
+#include "ws_cpuid.h"
+
+#include <nmmintrin.h>
+#include <string.h>
+#include "crc32_int.h"
+
+bool
+crc32c_sse42_available(void)
+{
+	return ws_cpuid_sse42() != 0;
+}
+
+/*
+ * The crc32 instruction computes exactly the reflected CRC32C that
+ * crc32c_calculate_no_swap() does, 8 bytes at a time on x86-64 and
+ * 4 bytes at a time on IA-32.
+ */
+uint32_t
+crc32c_no_swap_sse42(const uint8_t *buf, size_t len, uint32_t crc)
+{
+#if defined(__x86_64__) || defined(_M_X64)
+	uint64_t crc64 = crc;
+	uint64_t word;
+
+	while (len >= 8) {
+		memcpy(&word, buf, sizeof word);
+		crc64 = _mm_crc32_u64(crc64, word);
+		buf += 8;
+		len -= 8;
+	}
+	crc = (uint32_t)crc64;
+#else
+	uint32_t word;
+
+	while (len >= 4) {
+		memcpy(&word, buf, sizeof word);
+		crc = _mm_crc32_u32(crc, word);
+		buf += 4;
+		len -= 4;
+	}
+#endif
+	while (len-- > 0)
+		crc = _mm_crc32_u8(crc, *buf++);
+
+	return crc;
+}
+
+#endif /* HAVE_SSE4_2 */
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 noexpandtab:
+ * :indentSize=8:tabSize=8:noTabs=false:
+ */
@@ -665,6 +665,106 @@ void test_nstime_from_iso8601(void)
     g_assert_cmpint(result.nsecs, ==, expect.nsecs);
 }
 
+#include "crc32.h"
+
+/* Bit at a time CRCs to check the table driven and hardware ones against */
+static uint32_t crc32_reflected_reference(const uint8_t *buf, size_t len, uint32_t crc, uint32_t poly)
+{
+    while (len-- > 0) {
+        crc ^= *buf++;
+        for (int bit = 0; bit < 8; bit++)
+            crc = (crc >> 1) ^ ((crc & 1) ? poly : 0);
+    }
+    return crc;
+}
+
+static uint32_t crc32_normal_reference(const uint8_t *buf, size_t len, uint32_t crc, uint32_t poly)
+{
+    while (len-- > 0) {
+        crc ^= (uint32_t)*buf++ << 24;
+        for (int bit = 0; bit < 8; bit++)
+            crc = (crc << 1) ^ ((crc & 0x80000000) ? poly : 0);
+    }
+    return crc;
+}
+
+static void test_crc32_check_values(void)
+{
+    const uint8_t *check = (const uint8_t *)"123456789";
+
+    /* The "check" values from the CRC catalogue */
+    g_assert_cmpuint(crc32c_calculate_no_swap(check, 9, CRC32C_PRELOAD) ^ 0xFFFFFFFF, ==, 0xE3069283);
+    g_assert_cmpuint(crc32_ccitt(check, 9), ==, 0xCBF43926);
+    g_assert_cmpuint(crc32_mpeg2_seed(check, 9, CRC32_MPEG2_SEED), ==, 0x0376E6E7);
+
+    /* An iSCSI read of 32 bytes of zeros (RFC 3720 B.4) */
+    uint8_t zeros[32] = { 0 };
+    g_assert_cmpuint(crc32c_calculate_no_swap(zeros, sizeof zeros, CRC32C_PRELOAD) ^ 0xFFFFFFFF, ==, 0x8A9136AA);
+}
+
+static void test_crc32_lengths_and_alignments(void)
+{
+    uint8_t buf[1024 + 8];
+    unsigned offset, len;
+
+    for (unsigned i = 0; i < sizeof buf; i++)
+        buf[i] = (uint8_t)(i * 131 + 7);
+
+    /* Cover every tail length and alignment of the 8 byte loops. */
+    for (offset = 0; offset < 8; offset++) {
+        for (len = 0; len <= 1024; len += (len < 64) ? 1 : 61) {
+            const uint8_t *p = buf + offset;
+
+            g_assert_cmpuint(crc32c_calculate_no_swap(p, len, 0x12345678), ==,
+                             crc32_reflected_reference(p, len, 0x12345678, 0x82F63B78));
+            g_assert_cmpuint(crc32_ccitt_seed(p, len, 0x12345678), ==,
+                             ~crc32_reflected_reference(p, len, 0x12345678, 0xEDB88320));
+            g_assert_cmpuint(crc32_mpeg2_seed(p, len, 0x12345678), ==,
+                             crc32_normal_reference(p, len, 0x12345678, 0x04C11DB7));
+        }
+    }
+}
+
+/* NOTE: You have to run "test_wsutil -m perf" to run the performance tests. */
+static void test_crc32_perf(void)
+{
+#define CRC_BUF_LEN 9000
+#define CRC_LOOP_COUNT (100 * 1000)
+    uint8_t            *buf = g_malloc(CRC_BUF_LEN);
+    int                 i;
+    double              start_utime, start_stime, end_utime, end_stime, utime_ms, stime_ms;
+    double              mbytes = (double)CRC_BUF_LEN * CRC_LOOP_COUNT / (1000 * 1000);
+
+    for (i = 0; i < CRC_BUF_LEN; i++)
+        buf[i] = (uint8_t)i;
+
+    RESOURCE_USAGE_START;
+    for (i = 0; i < CRC_LOOP_COUNT; i++)
+        crc32c_calculate_no_swap(buf, CRC_BUF_LEN, CRC32C_PRELOAD);
+    RESOURCE_USAGE_END;
+    g_test_minimized_result(utime_ms + stime_ms,
+        "crc32c_calculate_no_swap(): u %.3f ms s %.3f ms, %.0f MB/s",
+        utime_ms, stime_ms, mbytes * 1000 / (utime_ms + stime_ms));
+
+    RESOURCE_USAGE_START;
+    for (i = 0; i < CRC_LOOP_COUNT; i++)
+        crc32_ccitt(buf, CRC_BUF_LEN);
+    RESOURCE_USAGE_END;
+    g_test_minimized_result(utime_ms + stime_ms,
+        "crc32_ccitt(): u %.3f ms s %.3f ms, %.0f MB/s",
+        utime_ms, stime_ms, mbytes * 1000 / (utime_ms + stime_ms));
+
+    RESOURCE_USAGE_START;
+    for (i = 0; i < CRC_LOOP_COUNT; i++)
+        crc32_mpeg2_seed(buf, CRC_BUF_LEN, CRC32_MPEG2_SEED);
+    RESOURCE_USAGE_END;
+    g_test_minimized_result(utime_ms + stime_ms,
+        "crc32_mpeg2_seed(): u %.3f ms s %.3f ms, %.0f MB/s",
+        utime_ms, stime_ms, mbytes * 1000 / (utime_ms + stime_ms));
+
+    g_free(buf);
+}
+
 #include "ws_getopt.h"
 
 #define ARGV_MAX 31
@@ -900,6 +1000,12 @@ int main(int argc, char **argv)
 
     g_test_add_func("/nstime/from_iso8601", test_nstime_from_iso8601);
 
+    g_test_add_func("/crc32/check_values", test_crc32_check_values);
+    g_test_add_func("/crc32/lengths_and_alignments", test_crc32_lengths_and_alignments);
+    if (g_test_perf()) {
+        g_test_add_func("/crc32/perf", test_crc32_perf);
+    }
+
     g_test_add_func("/ws_getopt/basic1", test_getopt_long_basic1);
     g_test_add_func("/ws_getopt/basic2", test_getopt_long_basic2);
     g_test_add_func("/ws_getopt/optional1", test_getopt_optional_argument1);
@@ -62,6 +62,13 @@ void log_resource_usage(bool reset_delta, const char *format, ...);
 WS_DLL_PUBLIC
 uint64_t create_timestamp(void);
 
+/**
+ * Fetch a monotonic time stamp in nanoseconds, for measuring short
+ * intervals. The starting point is unspecified.
+ */
+WS_DLL_PUBLIC
+uint64_t ws_monotonic_ns(void);
+
 WS_DLL_PUBLIC
 void ws_tzset(void);
 
@@ -0,0 +1,216 @@
+/* wmem_accounting.c
+ * Wireshark Memory Manager Allocation Accounting
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#include <glib.h>
+
+#include "wmem_core.h"
+#include "wmem_allocator.h"
+#include "wmem_accounting.h"
+
+/* Accounting is done by replacing the allocator's functions and private
+ * data with ours, which count each allocation and then call the ones we
+ * replaced. */
+typedef struct _wmem_accounting_t {
+    void *(*walloc)(void *private_data, const size_t size);
+    void  (*wfree)(void *private_data, void *ptr);
+    void *(*wrealloc)(void *private_data, void *ptr, const size_t size);
+    void  (*free_all)(void *private_data);
+    void  (*gc)(void *private_data);
+    void  (*cleanup)(void *private_data);
+    void  *private_data;
+
+    GHashTable              *stats;         /* tag -> wmem_accounting_stats_t */
+    int                      cached_tag;
+    wmem_accounting_stats_t *cached_stats;  /* stats of cached_tag, or NULL */
+} wmem_accounting_t;
+
+static int current_tag = -1;
+
+static void
+wmem_accounting_count(wmem_accounting_t *accounting, const size_t size)
+{
+    wmem_accounting_stats_t *stats;
+
+    /* The tag usually stays the same for many allocations in a row. */
+    if (G_LIKELY(accounting->cached_stats && accounting->cached_tag == current_tag)) {
+        stats = accounting->cached_stats;
+    }
+    else {
+        stats = (wmem_accounting_stats_t *)g_hash_table_lookup(accounting->stats,
+                GINT_TO_POINTER(current_tag));
+        if (!stats) {
+            stats = g_new0(wmem_accounting_stats_t, 1);
+            g_hash_table_insert(accounting->stats, GINT_TO_POINTER(current_tag), stats);
+        }
+        accounting->cached_tag = current_tag;
+        accounting->cached_stats = stats;
+    }
+
+    stats->allocations++;
+    stats->bytes += size;
+}
+
+static void *
+wmem_accounting_alloc(void *private_data, const size_t size)
+{
+    wmem_accounting_t *accounting = (wmem_accounting_t *)private_data;
+
+    wmem_accounting_count(accounting, size);
+    return accounting->walloc(accounting->private_data, size);
+}
+
+static void
+wmem_accounting_free(void *private_data, void *ptr)
+{
+    wmem_accounting_t *accounting = (wmem_accounting_t *)private_data;
+
+    accounting->wfree(accounting->private_data, ptr);
+}
+
+static void *
+wmem_accounting_realloc(void *private_data, void *ptr, const size_t size)
+{
+    wmem_accounting_t *accounting = (wmem_accounting_t *)private_data;
+
+    wmem_accounting_count(accounting, size);
+    return accounting->wrealloc(accounting->private_data, ptr, size);
+}
+
+static void
+wmem_accounting_free_all(void *private_data)
+{
+    wmem_accounting_t *accounting = (wmem_accounting_t *)private_data;
+
+    accounting->free_all(accounting->private_data);
+    g_hash_table_remove_all(accounting->stats);
+    accounting->cached_stats = NULL;
+}
+
+static void
+wmem_accounting_gc(void *private_data)
+{
+    wmem_accounting_t *accounting = (wmem_accounting_t *)private_data;
+
+    accounting->gc(accounting->private_data);
+}
+
+static void
+wmem_accounting_data_free(wmem_accounting_t *accounting)
+{
+    g_hash_table_destroy(accounting->stats);
+    g_free(accounting);
+}
+
+static void
+wmem_accounting_cleanup(void *private_data)
+{
+    wmem_accounting_t *accounting = (wmem_accounting_t *)private_data;
+
+    accounting->cleanup(accounting->private_data);
+    wmem_accounting_data_free(accounting);
+}
+
+bool
+wmem_accounting_is_active(wmem_allocator_t *allocator)
+{
+    return allocator->walloc == wmem_accounting_alloc;
+}
+
+void
+wmem_accounting_start(wmem_allocator_t *allocator)
+{
+    wmem_accounting_t *accounting;
+
+    if (wmem_accounting_is_active(allocator)) {
+        return;
+    }
+
+    accounting = g_new0(wmem_accounting_t, 1);
+    accounting->walloc       = allocator->walloc;
+    accounting->wfree        = allocator->wfree;
+    accounting->wrealloc     = allocator->wrealloc;
+    accounting->free_all     = allocator->free_all;
+    accounting->gc           = allocator->gc;
+    accounting->cleanup      = allocator->cleanup;
+    accounting->private_data = allocator->private_data;
+    accounting->stats        = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, g_free);
+
+    allocator->walloc       = &wmem_accounting_alloc;
+    allocator->wfree        = &wmem_accounting_free;
+    allocator->wrealloc     = &wmem_accounting_realloc;
+    allocator->free_all     = &wmem_accounting_free_all;
+    allocator->gc           = &wmem_accounting_gc;
+    allocator->cleanup      = &wmem_accounting_cleanup;
+    allocator->private_data = accounting;
+}
+
+void
+wmem_accounting_stop(wmem_allocator_t *allocator)
+{
+    wmem_accounting_t *accounting;
+
+    if (!wmem_accounting_is_active(allocator)) {
+        return;
+    }
+
+    accounting = (wmem_accounting_t *)allocator->private_data;
+    allocator->walloc       = accounting->walloc;
+    allocator->wfree        = accounting->wfree;
+    allocator->wrealloc     = accounting->wrealloc;
+    allocator->free_all     = accounting->free_all;
+    allocator->gc           = accounting->gc;
+    allocator->cleanup      = accounting->cleanup;
+    allocator->private_data = accounting->private_data;
+
+    wmem_accounting_data_free(accounting);
+}
+
+int
+wmem_accounting_set_tag(int tag)
+{
+    int prev_tag = current_tag;
+
+    current_tag = tag;
+    return prev_tag;
+}
+
+void
+wmem_accounting_foreach(wmem_allocator_t *allocator, wmem_accounting_func func,
+        void *user_data)
+{
+    wmem_accounting_t *accounting;
+    GHashTableIter     iter;
+    void              *key, *value;
+
+    if (!wmem_accounting_is_active(allocator)) {
+        return;
+    }
+
+    accounting = (wmem_accounting_t *)allocator->private_data;
+    g_hash_table_iter_init(&iter, accounting->stats);
+    while (g_hash_table_iter_next(&iter, &key, &value)) {
+        func(GPOINTER_TO_INT(key), (const wmem_accounting_stats_t *)value, user_data);
+    }
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
@@ -0,0 +1,104 @@
+/** @file
+ *
+ * Definitions for the Wireshark Memory Manager Allocation Accounting
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __WMEM_ACCOUNTING_H__
+#define __WMEM_ACCOUNTING_H__
+
+#include "wmem_core.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/** @addtogroup wmem
+ *  @{
+ *    @defgroup wmem-accounting Allocation Accounting
+ *
+ *    Counts the memory allocated from an allocator by tag, where the tag is
+ *    whatever was last passed to wmem_accounting_set_tag(), for example the
+ *    ID of the protocol being dissected. The size of an allocation isn't
+ *    known when it's freed, so only allocations are counted; a reallocation
+ *    counts as an allocation of the new size. The counts are reset when all
+ *    the memory of the allocator is freed.
+ *
+ *    Accounting can be started and stopped at any time, as it doesn't
+ *    change the memory handed out by the allocator.
+ *
+ *    @{
+ */
+
+/** Allocations counted for one tag. */
+typedef struct _wmem_accounting_stats_t {
+    uint64_t allocations;   /**< Number of allocations and reallocations */
+    uint64_t bytes;         /**< Bytes requested by them */
+} wmem_accounting_stats_t;
+
+/** Function called for each tag by wmem_accounting_foreach(). */
+typedef void (*wmem_accounting_func)(int tag, const wmem_accounting_stats_t *stats,
+        void *user_data);
+
+/** Start counting the allocations made from an allocator. Does nothing if
+ * they're already being counted.
+ */
+WS_DLL_PUBLIC
+void
+wmem_accounting_start(wmem_allocator_t *allocator);
+
+/** Stop counting the allocations made from an allocator, and discard the
+ * counts.
+ */
+WS_DLL_PUBLIC
+void
+wmem_accounting_stop(wmem_allocator_t *allocator);
+
+/** Return true if the allocations made from an allocator are being counted. */
+WS_DLL_PUBLIC
+bool
+wmem_accounting_is_active(wmem_allocator_t *allocator);
+
+/** Set the tag that following allocations are counted against, for all
+ * allocators. Negative tags are for unattributed allocations.
+ *
+ * @return The previous tag.
+ */
+WS_DLL_PUBLIC
+int
+wmem_accounting_set_tag(int tag);
+
+/** Call func for every tag with allocations counted since the allocator's
+ * memory was last freed.
+ */
+WS_DLL_PUBLIC
+void
+wmem_accounting_foreach(wmem_allocator_t *allocator, wmem_accounting_func func,
+        void *user_data);
+
+/**   @}
+ *  @} */
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __WMEM_ACCOUNTING_H__ */
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
@@ -194,6 +194,74 @@ wmem_test_allocator_callbacks(void)
     g_assert_true(cb_called_count == 3);
 }
 
+static void
+wmem_test_accounting_cb(int tag, const wmem_accounting_stats_t *stats, void *user_data)
+{
+    wmem_accounting_stats_t *expected = (wmem_accounting_stats_t *)user_data;
+
+    g_assert_true(tag >= -1 && tag <= 1);
+    g_assert_true(stats->allocations == expected[tag + 1].allocations);
+    g_assert_true(stats->bytes == expected[tag + 1].bytes);
+    expected[tag + 1].allocations = 0;
+}
+
+static void
+wmem_test_allocator_accounting(void)
+{
+    wmem_allocator_t        *allocator;
+    wmem_accounting_stats_t  expected[3];
+    char                    *ptr;
+    int                      prev_tag;
+
+    allocator = wmem_allocator_new(WMEM_ALLOCATOR_BLOCK);
+
+    /* Allocations made before accounting starts aren't counted, but
+     * can still be reallocated and freed. */
+    ptr = (char *)wmem_alloc(allocator, 10);
+    wmem_accounting_start(allocator);
+    wmem_accounting_start(allocator);
+    g_assert_true(wmem_accounting_is_active(allocator));
+
+    ptr = (char *)wmem_realloc(allocator, ptr, 20);
+    wmem_free(allocator, ptr);
+    prev_tag = wmem_accounting_set_tag(0);
+    g_assert_true(prev_tag == -1);
+    wmem_alloc(allocator, 5);
+    wmem_alloc(allocator, 7);
+    wmem_accounting_set_tag(1);
+    ptr = (char *)wmem_alloc(allocator, 100);
+    wmem_accounting_set_tag(0);
+    wmem_alloc(allocator, 3);
+    wmem_accounting_set_tag(prev_tag);
+
+    memset(expected, 0, sizeof(expected));
+    expected[0].allocations = 1;
+    expected[0].bytes = 20;
+    expected[1].allocations = 3;
+    expected[1].bytes = 15;
+    expected[2].allocations = 1;
+    expected[2].bytes = 100;
+    wmem_accounting_foreach(allocator, wmem_test_accounting_cb, expected);
+    for (int i = 0; i < 3; i++) {
+        g_assert_true(expected[i].allocations == 0);
+    }
+
+    /* Freeing everything resets the counts. */
+    wmem_free_all(allocator);
+    memset(expected, 0, sizeof(expected));
+    wmem_accounting_foreach(allocator, wmem_test_accounting_cb, expected);
+
+    wmem_accounting_stop(allocator);
+    g_assert_false(wmem_accounting_is_active(allocator));
+    ptr = (char *)wmem_alloc(allocator, 10);
+    wmem_free(allocator, ptr);
+
+    /* Destroying an allocator that's being accounted frees it all. */
+    wmem_accounting_start(allocator);
+    wmem_alloc(allocator, 10);
+    wmem_destroy_allocator(allocator);
+}
+
 static void
 wmem_test_allocator_det(wmem_allocator_t *allocator, wmem_verify_func verify,
         unsigned len)
@@ -1470,6 +1538,7 @@ main(int argc, char **argv)
     g_test_add_func("/wmem/allocator/simple",    wmem_test_allocator_simple);
     g_test_add_func("/wmem/allocator/strict",    wmem_test_allocator_strict);
     g_test_add_func("/wmem/allocator/callbacks", wmem_test_allocator_callbacks);
+    g_test_add_func("/wmem/allocator/accounting", wmem_test_allocator_accounting);
 
     g_test_add_func("/wmem/utils/misc",    wmem_test_miscutls);
     g_test_add_func("/wmem/utils/strings", wmem_test_strutls);